@@ -54,6 +54,10 @@
 #include <vtkSphereSource.h>
 #include <vtkTransform.h>
 #include <vtkTransformPolyDataFilter.h>
+#include <vtkWeakPointer.h>
+
+// STD includes
+#include <algorithm>
 
 // vtkAddon includes
 #include <vtkStreamingVolumeCodecFactory.h>
@@ -81,6 +85,13 @@ public:
   igtlioMessageDeviceListType      MessageDeviceList;
   igtlioDeviceFactoryPointer DeviceFactory;
 
+  /// Connector nodes of the scene, in the order they were added
+  std::vector<vtkWeakPointer<vtkMRMLIGTLConnectorNode> > ConnectorNodes;
+  void AddConnectorNode(vtkMRMLIGTLConnectorNode* connectorNode);
+  void RemoveConnectorNode(vtkMRMLIGTLConnectorNode* connectorNode);
+  /// Rebuild the connector list from the scene (when the scene is changed)
+  void UpdateConnectorNodes(vtkMRMLScene* scene);
+
   // Update state of node locator model to reflect the IGTLVisible attribute of the nodes
   void SetLocatorVisibility(bool visible, vtkMRMLTransformNode* transform);
   // Add a node locator to the mrml scene
@@ -102,6 +113,49 @@ vtkSlicerOpenIGTLinkIFLogic::vtkInternal::~vtkInternal()
 {
 }
 
+//---------------------------------------------------------------------------
+void vtkSlicerOpenIGTLinkIFLogic::vtkInternal::AddConnectorNode(vtkMRMLIGTLConnectorNode* connectorNode)
+{
+  if (std::find(this->ConnectorNodes.begin(), this->ConnectorNodes.end(), connectorNode) != this->ConnectorNodes.end())
+  {
+    return;
+  }
+  this->ConnectorNodes.push_back(connectorNode);
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerOpenIGTLinkIFLogic::vtkInternal::RemoveConnectorNode(vtkMRMLIGTLConnectorNode* connectorNode)
+{
+  // Deleted nodes are removed as well
+  for (std::vector<vtkWeakPointer<vtkMRMLIGTLConnectorNode> >::iterator connectorIt = this->ConnectorNodes.begin(); connectorIt != this->ConnectorNodes.end();)
+  {
+    if (*connectorIt == connectorNode || !*connectorIt)
+    {
+      connectorIt = this->ConnectorNodes.erase(connectorIt);
+    }
+    else
+    {
+      ++connectorIt;
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerOpenIGTLinkIFLogic::vtkInternal::UpdateConnectorNodes(vtkMRMLScene* scene)
+{
+  this->ConnectorNodes.clear();
+  if (!scene)
+  {
+    return;
+  }
+  std::vector<vtkMRMLNode*> nodes;
+  scene->GetNodesByClass("vtkMRMLIGTLConnectorNode", nodes);
+  for (std::vector<vtkMRMLNode*>::iterator nodeIt = nodes.begin(); nodeIt != nodes.end(); ++nodeIt)
+  {
+    this->AddConnectorNode(vtkMRMLIGTLConnectorNode::SafeDownCast(*nodeIt));
+  }
+}
+
 //----------------------------------------------------------------------------
 // vtkSlicerOpenIGTLinkIFLogic methods
 
@@ -140,16 +194,12 @@ vtkSlicerOpenIGTLinkIFLogic::~vtkSlicerOpenIGTLinkIFLogic()
   // If we rely on the node deconstructor, it will be too late to correctly terminate the server threads and the connector will hang indefinitely.
   // TODO: The logic contained within the connector nodes should eventually be refactored to the logic classes. The connector nodes should not perform any
   // resource allocation or thread management through OpenIGTLinkIO as they do now.
-  if (this->GetMRMLScene())
+  for (int i = 0; i < this->GetNumberOfConnectors(); ++i)
   {
-    vtkSmartPointer<vtkCollection> connectorNodes = vtkSmartPointer<vtkCollection>::Take(this->GetMRMLScene()->GetNodesByClass("vtkMRMLIGTLConnectorNode"));
-    for (int i = 0; i < connectorNodes->GetNumberOfItems(); ++i)
+    vtkMRMLIGTLConnectorNode* connectorNode = this->GetNthConnector(i);
+    if (connectorNode)
     {
-      vtkMRMLIGTLConnectorNode* connectorNode = vtkMRMLIGTLConnectorNode::SafeDownCast(connectorNodes->GetItemAsObject(i));
-      if (connectorNode)
-      {
-        connectorNode->Stop();
-      }
+      connectorNode->Stop();
     }
   }
 
@@ -172,6 +222,7 @@ void vtkSlicerOpenIGTLinkIFLogic::SetMRMLSceneInternal(vtkMRMLScene* newScene)
   sceneEvents->InsertNextValue(vtkMRMLScene::NodeRemovedEvent);
   sceneEvents->InsertNextValue(vtkMRMLScene::EndImportEvent);
   this->SetAndObserveMRMLSceneEventsInternal(newScene, sceneEvents.GetPointer());
+  this->Internal->UpdateConnectorNodes(newScene);
 }
 
 //---------------------------------------------------------------------------
@@ -255,11 +306,9 @@ void vtkSlicerOpenIGTLinkIFLogic::OnMRMLSceneEndImport()
   // Scene loading/import is finished, so now start the command processing thread
   // of all the active persistent connector nodes
 
-  std::vector<vtkMRMLNode*> nodes;
-  this->GetMRMLScene()->GetNodesByClass("vtkMRMLIGTLConnectorNode", nodes);
-  for (std::vector< vtkMRMLNode* >::iterator iter = nodes.begin(); iter != nodes.end(); ++iter)
+  for (int i = 0; i < this->GetNumberOfConnectors(); ++i)
   {
-    vtkMRMLIGTLConnectorNode* connector = vtkMRMLIGTLConnectorNode::SafeDownCast(*iter);
+    vtkMRMLIGTLConnectorNode* connector = this->GetNthConnector(i);
     if (connector == NULL)
     {
       continue;
@@ -286,6 +335,7 @@ void vtkSlicerOpenIGTLinkIFLogic::OnMRMLSceneNodeAdded(vtkMRMLNode* node)
     // TODO Remove this line when the corresponding UI option will be added
     connectorNode->SetRestrictDeviceName(0);
 
+    this->Internal->AddConnectorNode(connectorNode);
     this->AddMRMLConnectorNodeObserver(connectorNode);
     //this->RegisterMessageDevices(connectorNode);
   }
@@ -297,6 +347,7 @@ void vtkSlicerOpenIGTLinkIFLogic::OnMRMLSceneNodeRemoved(vtkMRMLNode* node)
   vtkMRMLIGTLConnectorNode* connectorNode = vtkMRMLIGTLConnectorNode::SafeDownCast(node);
   if (connectorNode)
   {
+    this->Internal->RemoveConnectorNode(connectorNode);
     this->RemoveMRMLConnectorNodeObserver(connectorNode);
   }
 }
@@ -317,18 +368,31 @@ vtkMRMLIGTLConnectorNode* vtkSlicerOpenIGTLinkIFLogic::GetConnector(const char*
 }
 
 //---------------------------------------------------------------------------
-void vtkSlicerOpenIGTLinkIFLogic::CallConnectorTimerHander()
+int vtkSlicerOpenIGTLinkIFLogic::GetNumberOfConnectors()
 {
-  //ConnectorMapType::iterator cmiter;
-  std::vector<vtkMRMLNode*> nodes;
-  this->GetMRMLScene()->GetNodesByClass("vtkMRMLIGTLConnectorNode", nodes);
+  return static_cast<int>(this->Internal->ConnectorNodes.size());
+}
 
-  std::vector<vtkMRMLNode*>::iterator iter;
+//---------------------------------------------------------------------------
+vtkMRMLIGTLConnectorNode* vtkSlicerOpenIGTLinkIFLogic::GetNthConnector(int index)
+{
+  if (index < 0 || index >= static_cast<int>(this->Internal->ConnectorNodes.size()))
+  {
+    vtkErrorMacro("GetNthConnector failed: index " << index << " is out of range");
+    return NULL;
+  }
+  return this->Internal->ConnectorNodes[index];
+}
 
-  //for (cmiter = this->ConnectorMap.begin(); cmiter != this->ConnectorMap.end(); cmiter ++)
-  for (iter = nodes.begin(); iter != nodes.end(); iter ++)
+//---------------------------------------------------------------------------
+void vtkSlicerOpenIGTLinkIFLogic::CallConnectorTimerHander()
+{
+  // Processing may add or remove connectors (for example when a received command is executed),
+  // so the connectors are processed from a copy of the list
+  std::vector<vtkWeakPointer<vtkMRMLIGTLConnectorNode> > connectorNodes = this->Internal->ConnectorNodes;
+  for (std::vector<vtkWeakPointer<vtkMRMLIGTLConnectorNode> >::iterator connectorIt = connectorNodes.begin(); connectorIt != connectorNodes.end(); ++connectorIt)
   {
-    vtkMRMLIGTLConnectorNode* connector = vtkMRMLIGTLConnectorNode::SafeDownCast(*iter);
+    vtkMRMLIGTLConnectorNode* connector = *connectorIt;
     if (!connector || connector->GetState() != vtkMRMLIGTLConnectorNode::StateConnected)
     {
       continue;
@@ -337,6 +401,24 @@ void vtkSlicerOpenIGTLinkIFLogic::CallConnectorTimerHander()
   }
 }
 
+//---------------------------------------------------------------------------
+double vtkSlicerOpenIGTLinkIFLogic::GetTimeUntilNextConnectorProcessing()
+{
+  // Connectors that are not connected request processing when their connection state changes
+  double delay = 1.0;
+  for (std::vector<vtkWeakPointer<vtkMRMLIGTLConnectorNode> >::iterator connectorIt = this->Internal->ConnectorNodes.begin();
+    connectorIt != this->Internal->ConnectorNodes.end(); ++connectorIt)
+  {
+    vtkMRMLIGTLConnectorNode* connector = *connectorIt;
+    if (!connector || connector->GetState() != vtkMRMLIGTLConnectorNode::StateConnected)
+    {
+      continue;
+    }
+    delay = std::min(delay, connector->GetTimeUntilNextProcessing());
+  }
+  return delay;
+}
+
 
 //---------------------------------------------------------------------------
 int vtkSlicerOpenIGTLinkIFLogic::SetRestrictDeviceName(int f)
@@ -344,14 +426,9 @@ int vtkSlicerOpenIGTLinkIFLogic::SetRestrictDeviceName(int f)
   if (f != 0) { f = 1; } // make sure that f is either 0 or 1.
   this->RestrictDeviceName = f;
 
-  std::vector<vtkMRMLNode*> nodes;
-  this->GetMRMLScene()->GetNodesByClass("vtkMRMLIGTLConnectorNode", nodes);
-
-  std::vector<vtkMRMLNode*>::iterator iter;
-
-  for (iter = nodes.begin(); iter != nodes.end(); iter ++)
+  for (int i = 0; i < this->GetNumberOfConnectors(); ++i)
   {
-    vtkMRMLIGTLConnectorNode* connector = vtkMRMLIGTLConnectorNode::SafeDownCast(*iter);
+    vtkMRMLIGTLConnectorNode* connector = this->GetNthConnector(i);
     if (connector)
     {
       connector->SetRestrictDeviceName(f);
@@ -399,19 +476,12 @@ int vtkSlicerOpenIGTLinkIFLogic::RegisterMessageDevice(IGTLDevicePointer deviceP
   }
 
   // Add the Device to the existing connectors
-  if (this->GetMRMLScene())
+  for (int i = 0; i < this->GetNumberOfConnectors(); ++i)
   {
-    std::vector<vtkMRMLNode*> nodes;
-    this->GetMRMLScene()->GetNodesByClass("vtkMRMLIGTLConnectorNode", nodes);
-
-    std::vector<vtkMRMLNode*>::iterator niter;
-    for (niter = nodes.begin(); niter != nodes.end(); niter ++)
+    vtkMRMLIGTLConnectorNode* connector = this->GetNthConnector(i);
+    if (connector)
     {
-      vtkMRMLIGTLConnectorNode* connector = vtkMRMLIGTLConnectorNode::SafeDownCast(*niter);
-      if (connector)
-      {
-        connector->AddDevice(Device);
-      }
+      connector->AddDevice(Device);
     }
   }
 
@@ -437,19 +507,12 @@ int vtkSlicerOpenIGTLinkIFLogic::UnregisterMessageDevice(IGTLDevicePointer devic
   {
     this->Internal->MessageDeviceList.erase(iter);
     // Remove the Device from the existing connectors
-    std::vector<vtkMRMLNode*> nodes;
-    if (this->GetMRMLScene())
+    for (int i = 0; i < this->GetNumberOfConnectors(); ++i)
     {
-      this->GetMRMLScene()->GetNodesByClass("vtkMRMLIGTLConnectorNode", nodes);
-
-      std::vector<vtkMRMLNode*>::iterator iter;
-      for (iter = nodes.begin(); iter != nodes.end(); iter ++)
+      vtkMRMLIGTLConnectorNode* connector = this->GetNthConnector(i);
+      if (connector)
       {
-        vtkMRMLIGTLConnectorNode* connector = vtkMRMLIGTLConnectorNode::SafeDownCast(*iter);
-        if (connector)
-        {
-          connector->RemoveDevice(Device);
-        }
+        connector->RemoveDevice(Device);
       }
     }
     return 1;
@@ -97,6 +97,15 @@ public:
   // Call timer-driven routines for each connector
   void                      CallConnectorTimerHander();
 
+  // Time in seconds until CallConnectorTimerHander() should be called next:
+  // the shortest time requested by the connected connectors (1s if there are no connected connectors).
+  double GetTimeUntilNextConnectorProcessing();
+
+  // Connector nodes in the scene. The list is updated when nodes are added to or removed from the scene,
+  // so the scene does not have to be searched for connectors at each timer call.
+  int GetNumberOfConnectors();
+  vtkMRMLIGTLConnectorNode* GetNthConnector(int index);
+
   // Device Name management
   int  SetRestrictDeviceName(int f);
 
@@ -0,0 +1,100 @@
+/*==============================================================================
+
+  Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+  Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkIGTLSPSCRingBuffer_h
+#define __vtkIGTLSPSCRingBuffer_h
+
+// STD includes
+#include <atomic>
+#include <utility>
+#include <vector>
+
+/// \brief Fixed size single-producer/single-consumer queue.
+///
+/// Push() may only be called from one thread and Pop() may only be called from one (other) thread.
+/// Neither of them blocks or locks a mutex, which makes the queue suitable for handing over
+/// items between a worker thread and the main thread.
+template<typename T>
+class vtkIGTLSPSCRingBuffer
+{
+public:
+  explicit vtkIGTLSPSCRingBuffer(size_t capacity)
+    : Items(capacity + 1)
+    , Head(0)
+    , Tail(0)
+  {
+  }
+
+  /// Add item to the end of the queue. Producer thread only.
+  /// Returns false (and leaves the item unchanged) if the queue is full.
+  bool Push(T&& item)
+  {
+    size_t tail = this->Tail.load(std::memory_order_relaxed);
+    size_t nextTail = this->Next(tail);
+    if (nextTail == this->Head.load(std::memory_order_acquire))
+    {
+      return false;
+    }
+    this->Items[tail] = std::move(item);
+    this->Tail.store(nextTail, std::memory_order_release);
+    return true;
+  }
+
+  /// Remove item from the front of the queue. Consumer thread only.
+  /// Returns false if the queue is empty.
+  bool Pop(T& item)
+  {
+    size_t head = this->Head.load(std::memory_order_relaxed);
+    if (head == this->Tail.load(std::memory_order_acquire))
+    {
+      return false;
+    }
+    item = std::move(this->Items[head]);
+    // Release resources held by the slot in the consumer thread
+    this->Items[head] = T();
+    this->Head.store(this->Next(head), std::memory_order_release);
+    return true;
+  }
+
+  /// Approximate number of items in the queue. May be called from any thread.
+  size_t GetSize() const
+  {
+    size_t head = this->Head.load(std::memory_order_acquire);
+    size_t tail = this->Tail.load(std::memory_order_acquire);
+    return (tail >= head) ? (tail - head) : (tail + this->Items.size() - head);
+  }
+
+  size_t GetCapacity() const
+  {
+    return this->Items.size() - 1;
+  }
+
+protected:
+  size_t Next(size_t index) const
+  {
+    return (index + 1 == this->Items.size()) ? 0 : index + 1;
+  }
+
+  std::vector<T> Items;
+  std::atomic<size_t> Head; // next item to pop, written by the consumer
+  std::atomic<size_t> Tail; // next slot to push to, written by the producer
+
+private:
+  vtkIGTLSPSCRingBuffer(const vtkIGTLSPSCRingBuffer&) = delete;
+  void operator=(const vtkIGTLSPSCRingBuffer&) = delete;
+};
+
+#endif
@@ -20,37 +20,340 @@ Care Ontario.
 
 // OpenIGTLinkIF MRML includes
 #include "vtkIGTLVP9VolumeCodec.h"
-
-// OpenIGTLinkIO includes
-#include <igtlioVideoConverter.h>
+#include "vtkIGTLVideoColorConversion.h"
 
 // VTK includes
-#include <vtkMatrix4x4.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtkVariant.h>
 
 // vtksys includes
 #include <vtksys/SystemTools.hxx>
 
+// libvpx includes
+#include <vpx/vp8cx.h>
+#include <vpx/vp8dx.h>
+#include <vpx/vpx_decoder.h>
+#include <vpx/vpx_encoder.h>
+
+// STD includes
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+//---------------------------------------------------------------------------
+class vtkIGTLVP9VolumeCodec::vtkInternal
+{
+public:
+  vtkInternal();
+  ~vtkInternal();
+
+  /// Number of threads used by the encoder and decoder (resolves automatic thread count)
+  unsigned int GetNumberOfThreads();
+
+  bool InitializeEncoder(vtkIGTLVP9VolumeCodec* self, unsigned int width, unsigned int height);
+  void DestroyEncoder();
+  bool InitializeDecoder(vtkIGTLVP9VolumeCodec* self);
+  void DestroyDecoder();
+
+  /// Copy a single channel image to the luma plane of an I420 image
+  static void CopyGrayToLuma(const unsigned char* gray, unsigned int width, unsigned int height, vpx_image_t* yuvImage);
+  /// Copy the luma plane of an I420 image to a single channel image
+  static void CopyLumaToGray(const vpx_image_t* yuvImage, unsigned char* gray);
+  /// Set the chroma planes of an I420 image to neutral gray
+  static void SetNeutralChroma(vpx_image_t* yuvImage);
+  /// Get a bitstream array of the given size that is not referenced by any frame.
+  /// Arrays are recycled once the frames that they were assigned to are deleted.
+  vtkUnsignedCharArray* GetBitstreamBuffer(vtkIdType size);
+
+  /// Make the output image an unsigned char image with the given size and number of components.
+  /// Scalars are only reallocated if the image does not match.
+  static void PrepareOutputImage(vtkImageData* imageData, const int dimensions[3], int numberOfComponents);
+
+  // Parameters
+  bool LosslessEncoding;
+  int KeyFrameDistance;
+  unsigned int BitRate;
+  /// 0 means one thread per CPU core
+  int NumberOfThreads;
+  /// Log2 of the number of tile columns, limited by the encoder based on the frame width
+  int TileColumns;
+  bool RowMultiThreading;
+
+  vpx_codec_ctx_t EncoderContext;
+  bool EncoderInitialized;
+  /// Parameters changed since the encoder was initialized
+  bool EncoderParametersModified;
+  vpx_image_t* EncoderImage;
+  /// Chroma planes of the encoder image are neutral gray, they do not need to be set for grayscale frames
+  bool EncoderChromaNeutral;
+  vpx_codec_pts_t EncoderFrameIndex;
+  /// Packets of the last encoded frame
+  std::vector<const vpx_codec_cx_pkt_t*> EncoderPackets;
+
+  struct BitstreamBuffer
+  {
+    vtkSmartPointer<vtkUnsignedCharArray> Array;
+    /// Memory of Array. The array does not own it, so it can be reused without reallocation.
+    std::vector<unsigned char> Memory;
+  };
+  std::vector<BitstreamBuffer> BitstreamBuffers;
+
+  vpx_codec_ctx_t DecoderContext;
+  bool DecoderInitialized;
+  /// Parameters changed since the decoder was initialized
+  bool DecoderParametersModified;
+};
+
+//---------------------------------------------------------------------------
+vtkIGTLVP9VolumeCodec::vtkInternal::vtkInternal()
+  : LosslessEncoding(true)
+  , KeyFrameDistance(50)
+  , BitRate(0)
+  , NumberOfThreads(1)
+  , TileColumns(0)
+  , RowMultiThreading(false)
+  , EncoderInitialized(false)
+  , EncoderParametersModified(false)
+  , EncoderImage(NULL)
+  , EncoderChromaNeutral(false)
+  , EncoderFrameIndex(0)
+  , DecoderInitialized(false)
+  , DecoderParametersModified(false)
+{
+  memset(&this->EncoderContext, 0, sizeof(this->EncoderContext));
+  memset(&this->DecoderContext, 0, sizeof(this->DecoderContext));
+}
+
+//---------------------------------------------------------------------------
+vtkIGTLVP9VolumeCodec::vtkInternal::~vtkInternal()
+{
+  this->DestroyEncoder();
+  this->DestroyDecoder();
+  for (std::vector<BitstreamBuffer>::iterator bufferIt = this->BitstreamBuffers.begin(); bufferIt != this->BitstreamBuffers.end(); ++bufferIt)
+  {
+    if (bufferIt->Array->GetReferenceCount() == 1)
+    {
+      continue;
+    }
+    // The frame outlives the codec, so its data must be moved to memory that is owned by the array
+    vtkIdType size = bufferIt->Array->GetNumberOfValues();
+    unsigned char* ownedData = static_cast<unsigned char*>(malloc(size > 0 ? size : 1));
+    if (size > 0)
+    {
+      memcpy(ownedData, bufferIt->Memory.data(), size);
+    }
+    bufferIt->Array->SetArray(ownedData, size, 0);
+  }
+}
+
+//---------------------------------------------------------------------------
+unsigned int vtkIGTLVP9VolumeCodec::vtkInternal::GetNumberOfThreads()
+{
+  if (this->NumberOfThreads > 0)
+  {
+    return this->NumberOfThreads;
+  }
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+//---------------------------------------------------------------------------
+bool vtkIGTLVP9VolumeCodec::vtkInternal::InitializeEncoder(vtkIGTLVP9VolumeCodec* self, unsigned int width, unsigned int height)
+{
+  this->DestroyEncoder();
+
+  vpx_codec_enc_cfg_t configuration;
+  if (vpx_codec_enc_config_default(vpx_codec_vp9_cx(), &configuration, 0) != VPX_CODEC_OK)
+  {
+    vtkErrorWithObjectMacro(self, "Failed to get default VP9 encoder configuration");
+    return false;
+  }
+  configuration.g_w = width;
+  configuration.g_h = height;
+  configuration.g_threads = this->GetNumberOfThreads();
+  configuration.g_lag_in_frames = 0; // each frame must be sent as soon as it is encoded
+  configuration.kf_mode = VPX_KF_AUTO;
+  configuration.kf_max_dist = this->KeyFrameDistance;
+  if (this->BitRate > 0)
+  {
+    configuration.rc_target_bitrate = std::max(1u, this->BitRate / 1000); // kbit/s
+  }
+  if (vpx_codec_enc_init(&this->EncoderContext, vpx_codec_vp9_cx(), &configuration, 0) != VPX_CODEC_OK)
+  {
+    vtkErrorWithObjectMacro(self, "Failed to initialize VP9 encoder: " << vpx_codec_error(&this->EncoderContext));
+    return false;
+  }
+  this->EncoderInitialized = true;
+
+  // Fast encoding preset for real-time streaming
+  vpx_codec_control(&this->EncoderContext, VP8E_SET_CPUUSED, 8);
+  vpx_codec_control(&this->EncoderContext, VP9E_SET_LOSSLESS, this->LosslessEncoding ? 1 : 0);
+  // Tiles and rows are encoded in parallel
+  vpx_codec_control(&this->EncoderContext, VP9E_SET_TILE_COLUMNS, this->TileColumns);
+#ifdef VPX_CTRL_VP9E_SET_ROW_MT
+  vpx_codec_control(&this->EncoderContext, VP9E_SET_ROW_MT, this->RowMultiThreading ? 1 : 0);
+#endif
+
+  this->EncoderImage = vpx_img_alloc(NULL, VPX_IMG_FMT_I420, width, height, 16);
+  if (!this->EncoderImage)
+  {
+    vtkErrorWithObjectMacro(self, "Failed to allocate VP9 encoder image");
+    this->DestroyEncoder();
+    return false;
+  }
+  this->EncoderChromaNeutral = false;
+  this->EncoderFrameIndex = 0;
+  this->EncoderParametersModified = false;
+  return true;
+}
+
+//---------------------------------------------------------------------------
+void vtkIGTLVP9VolumeCodec::vtkInternal::DestroyEncoder()
+{
+  if (this->EncoderImage)
+  {
+    vpx_img_free(this->EncoderImage);
+    this->EncoderImage = NULL;
+  }
+  if (this->EncoderInitialized)
+  {
+    vpx_codec_destroy(&this->EncoderContext);
+    this->EncoderInitialized = false;
+  }
+}
+
+//---------------------------------------------------------------------------
+bool vtkIGTLVP9VolumeCodec::vtkInternal::InitializeDecoder(vtkIGTLVP9VolumeCodec* self)
+{
+  this->DestroyDecoder();
+
+  vpx_codec_dec_cfg_t configuration = { this->GetNumberOfThreads(), 0, 0 };
+  if (vpx_codec_dec_init(&this->DecoderContext, vpx_codec_vp9_dx(), &configuration, 0) != VPX_CODEC_OK)
+  {
+    vtkErrorWithObjectMacro(self, "Failed to initialize VP9 decoder: " << vpx_codec_error(&this->DecoderContext));
+    return false;
+  }
+  this->DecoderInitialized = true;
+#ifdef VPX_CTRL_VP9D_SET_ROW_MT
+  vpx_codec_control(&this->DecoderContext, VP9D_SET_ROW_MT, this->RowMultiThreading ? 1 : 0);
+#endif
+  this->DecoderParametersModified = false;
+  return true;
+}
+
+//---------------------------------------------------------------------------
+void vtkIGTLVP9VolumeCodec::vtkInternal::DestroyDecoder()
+{
+  if (this->DecoderInitialized)
+  {
+    vpx_codec_destroy(&this->DecoderContext);
+    this->DecoderInitialized = false;
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkIGTLVP9VolumeCodec::vtkInternal::CopyGrayToLuma(const unsigned char* gray, unsigned int width, unsigned int height, vpx_image_t* yuvImage)
+{
+  for (unsigned int row = 0; row < height; ++row)
+  {
+    memcpy(yuvImage->planes[VPX_PLANE_Y] + yuvImage->stride[VPX_PLANE_Y] * row, gray + width * row, width);
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkIGTLVP9VolumeCodec::vtkInternal::CopyLumaToGray(const vpx_image_t* yuvImage, unsigned char* gray)
+{
+  for (unsigned int row = 0; row < yuvImage->d_h; ++row)
+  {
+    memcpy(gray + yuvImage->d_w * row, yuvImage->planes[VPX_PLANE_Y] + yuvImage->stride[VPX_PLANE_Y] * row, yuvImage->d_w);
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkIGTLVP9VolumeCodec::vtkInternal::SetNeutralChroma(vpx_image_t* yuvImage)
+{
+  unsigned int chromaWidth = (yuvImage->d_w + 1) / 2;
+  unsigned int chromaHeight = (yuvImage->d_h + 1) / 2;
+  for (unsigned int chromaRow = 0; chromaRow < chromaHeight; ++chromaRow)
+  {
+    memset(yuvImage->planes[VPX_PLANE_U] + yuvImage->stride[VPX_PLANE_U] * chromaRow, 128, chromaWidth);
+    memset(yuvImage->planes[VPX_PLANE_V] + yuvImage->stride[VPX_PLANE_V] * chromaRow, 128, chromaWidth);
+  }
+}
+
+//---------------------------------------------------------------------------
+vtkUnsignedCharArray* vtkIGTLVP9VolumeCodec::vtkInternal::GetBitstreamBuffer(vtkIdType size)
+{
+  BitstreamBuffer* buffer = nullptr;
+  for (std::vector<BitstreamBuffer>::iterator bufferIt = this->BitstreamBuffers.begin(); bufferIt != this->BitstreamBuffers.end(); ++bufferIt)
+  {
+    // Only the codec references the array
+    if (bufferIt->Array->GetReferenceCount() == 1)
+    {
+      buffer = &(*bufferIt);
+      break;
+    }
+  }
+  if (!buffer)
+  {
+    this->BitstreamBuffers.push_back(BitstreamBuffer());
+    buffer = &(this->BitstreamBuffers.back());
+    buffer->Array = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  }
+  if (buffer->Memory.size() < static_cast<size_t>(size))
+  {
+    buffer->Memory.resize(size);
+  }
+  // The array size must match the bitstream size, as the decoder decodes the entire array
+  buffer->Array->SetArray(buffer->Memory.data(), size, 1);
+  buffer->Array->Modified();
+  return buffer->Array;
+}
+
+//---------------------------------------------------------------------------
+void vtkIGTLVP9VolumeCodec::vtkInternal::PrepareOutputImage(vtkImageData* imageData, const int dimensions[3], int numberOfComponents)
+{
+  int currentDimensions[3] = { 0, 0, 0 };
+  imageData->GetDimensions(currentDimensions);
+  if (currentDimensions[0] == dimensions[0] && currentDimensions[1] == dimensions[1] && currentDimensions[2] == dimensions[2]
+    && imageData->GetPointData()->GetScalars()
+    && imageData->GetScalarType() == VTK_UNSIGNED_CHAR && imageData->GetNumberOfScalarComponents() == numberOfComponents)
+  {
+    return;
+  }
+  imageData->SetDimensions(dimensions[0], dimensions[1], dimensions[2]);
+  imageData->AllocateScalars(VTK_UNSIGNED_CHAR, numberOfComponents);
+}
+
 vtkCodecNewMacro(vtkIGTLVP9VolumeCodec);
 
 //---------------------------------------------------------------------------
 vtkIGTLVP9VolumeCodec::vtkIGTLVP9VolumeCodec()
-  : YUVImage(NULL)
-  , LastEncodedFrame(NULL)
+  : LastEncodedFrame(NULL)
 {
-  this->Encoder = igtl::VP9Encoder::New();
-  this->Decoder = igtl::VP9Decoder::New();
+  this->Internal = new vtkInternal();
 
   this->AvailiableParameterNames.push_back(this->GetLosslessEncodingParameter());
   this->AvailiableParameterNames.push_back(this->GetKeyFrameDistanceParameter());
   this->AvailiableParameterNames.push_back(this->GetBitRateParameter());
+  this->AvailiableParameterNames.push_back(this->GetNumberOfThreadsParameter());
+  this->AvailiableParameterNames.push_back(this->GetTileColumnsParameter());
+  this->AvailiableParameterNames.push_back(this->GetRowMultiThreadingParameter());
 
   this->SetParameter(this->GetLosslessEncodingParameter(), "true");
   this->SetParameter(this->GetKeyFrameDistanceParameter(), "50");
+  this->SetParameter(this->GetNumberOfThreadsParameter(), "1");
+  this->SetParameter(this->GetTileColumnsParameter(), "0");
+  this->SetParameter(this->GetRowMultiThreadingParameter(), "false");
 }
 
 //---------------------------------------------------------------------------
 vtkIGTLVP9VolumeCodec::~vtkIGTLVP9VolumeCodec()
 {
+  delete this->Internal;
 }
 
 //---------------------------------------------------------------------------
@@ -71,6 +374,21 @@ std::string vtkIGTLVP9VolumeCodec::GetParameterDescription(std::string parameter
     return "Lossless encoding flag";
   }
 
+  if (parameterName == this->GetNumberOfThreadsParameter())
+  {
+    return "Number of encoder and decoder threads (default 1, 0 = number of CPU cores). The decoder applies it at the next key frame.";
+  }
+
+  if (parameterName == this->GetTileColumnsParameter())
+  {
+    return "Log2 of the number of tile columns that are encoded in parallel (default 0, limited by the frame width)";
+  }
+
+  if (parameterName == this->GetRowMultiThreadingParameter())
+  {
+    return "Row based multi-threading flag (default false)";
+  }
+
   return "";
 }
 
@@ -81,21 +399,48 @@ bool vtkIGTLVP9VolumeCodec::UpdateParameterInternal(std::string parameterName, s
   vtkVariant inputParameter = vtkVariant(parameterValue);
   std::string lowerParameterValue = vtksys::SystemTools::LowerCase(parameterValue);
 
+  // The encoder is reinitialized with the new parameters before the next frame
   if (parameterName == this->GetKeyFrameDistanceParameter())
   {
-    this->Encoder->SetKeyFrameDistance(inputParameter.ToInt());
+    this->Internal->KeyFrameDistance = inputParameter.ToInt();
+    this->Internal->EncoderParametersModified = true;
     return true;
   }
 
   if (parameterName == this->GetBitRateParameter())
   {
-    this->Encoder->SetRCTaregetBitRate(inputParameter.ToUnsignedInt());
+    this->Internal->BitRate = inputParameter.ToUnsignedInt();
+    this->Internal->EncoderParametersModified = true;
     return true;
   }
 
   if (parameterName == this->GetLosslessEncodingParameter())
   {
-    this->Encoder->SetLosslessLink(lowerParameterValue == "true");
+    this->Internal->LosslessEncoding = (lowerParameterValue == "true");
+    this->Internal->EncoderParametersModified = true;
+    return true;
+  }
+
+  if (parameterName == this->GetNumberOfThreadsParameter())
+  {
+    this->Internal->NumberOfThreads = std::max(0, inputParameter.ToInt());
+    this->Internal->EncoderParametersModified = true;
+    this->Internal->DecoderParametersModified = true;
+    return true;
+  }
+
+  if (parameterName == this->GetTileColumnsParameter())
+  {
+    this->Internal->TileColumns = std::max(0, std::min(6, inputParameter.ToInt()));
+    this->Internal->EncoderParametersModified = true;
+    return true;
+  }
+
+  if (parameterName == this->GetRowMultiThreadingParameter())
+  {
+    this->Internal->RowMultiThreading = (lowerParameterValue == "true");
+    this->Internal->EncoderParametersModified = true;
+    this->Internal->DecoderParametersModified = true;
     return true;
   }
 
@@ -111,11 +456,6 @@ bool vtkIGTLVP9VolumeCodec::DecodeFrameInternal(vtkStreamingVolumeFrame* inputFr
     return false;
   }
 
-  if (!this->YUVImage)
-  {
-    this->YUVImage = vtkSmartPointer<vtkImageData>::New();
-  }
-
   int dimensions[3] = { 0, 0, 0 };
   inputFrame->GetDimensions(dimensions);
 
@@ -126,28 +466,60 @@ bool vtkIGTLVP9VolumeCodec::DecodeFrameInternal(vtkStreamingVolumeFrame* inputFr
     return false;
   }
 
-  vtkUnsignedCharArray* frameData = inputFrame->GetFrameData();
-  void* framePointer = frameData->GetPointer(0);
-
-  this->YUVImage->SetDimensions(dimensions[0], dimensions[1] * 3 / 2, 1); //TODO: ONLY VALID UNLESS GREYSCALE
-  this->YUVImage->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
-  void* yuvPointer = this->YUVImage->GetScalarPointer();
+  // Reinitializing the decoder discards the reference frames, so modified parameters are only applied
+  // at the next key frame. Until then the frames are decoded with the previous parameters.
+  if (!this->Internal->DecoderInitialized || (this->Internal->DecoderParametersModified && inputFrame->IsKeyFrame()))
+  {
+    if (!this->Internal->InitializeDecoder(this))
+    {
+      return false;
+    }
+  }
 
-  outputImageData->SetDimensions(dimensions);
-  void* imagePointer = outputImageData->GetScalarPointer();
+  vtkUnsignedCharArray* frameData = inputFrame->GetFrameData();
+  const unsigned char* framePointer = frameData->GetPointer(0);
+  unsigned int size = frameData->GetSize() * frameData->GetElementComponentSize();
 
-  igtl_uint64 size = frameData->GetSize() * frameData->GetElementComponentSize();
-  igtl_uint32 frameSize[3] = { (igtl_uint32)dimensions[0], (igtl_uint32)dimensions[1], (igtl_uint32)dimensions[2] };
+  // Decode compressed frame (all frames must be decoded to keep the reference frames of the decoder up-to-date)
+  if (vpx_codec_decode(&this->Internal->DecoderContext, framePointer, size, NULL, 0) != VPX_CODEC_OK)
+  {
+    vtkErrorMacro("Failed to decode frame: " << vpx_codec_error(&this->Internal->DecoderContext));
+    return false;
+  }
+  vpx_codec_iter_t iterator = NULL;
+  vpx_image_t* decodedImage = vpx_codec_get_frame(&this->Internal->DecoderContext, &iterator);
+  if (!decodedImage)
+  {
+    vtkErrorMacro("Failed to decode frame: no image");
+    return false;
+  }
+  if (decodedImage->fmt != VPX_IMG_FMT_I420
+    || decodedImage->d_w != static_cast<unsigned int>(dimensions[0]) || decodedImage->d_h != static_cast<unsigned int>(dimensions[1]))
+  {
+    vtkErrorMacro("Decoded image format or size does not match the frame");
+    return false;
+  }
 
-  // Convert compressed frame to YUV image
-  this->Decoder->DecodeBitStreamIntoFrame((unsigned char*)framePointer, (igtl_uint8*)yuvPointer, frameSize, size);
+  if (!saveDecodedImage)
+  {
+    return true;
+  }
 
-  // Convert YUV image to RGB image
-  if (saveDecodedImage)
+  // Grayscale frames are decoded directly from the luma plane, chroma is not used
+  int numberOfComponents = (inputFrame->GetNumberOfComponents() == 1 ? 1 : 3);
+  vtkInternal::PrepareOutputImage(outputImageData, dimensions, numberOfComponents);
+  unsigned char* imagePointer = static_cast<unsigned char*>(outputImageData->GetScalarPointer());
+  if (numberOfComponents == 1)
   {
-    this->Decoder->ConvertYUVToRGB((igtl_uint8*)yuvPointer, (igtl_uint8*)imagePointer, dimensions[1], dimensions[0]);
+    vtkInternal::CopyLumaToGray(decodedImage, imagePointer);
+    return true;
   }
 
+  // Convert YUV image to RGB image, directly from the planes of the decoder
+  vtkIGTLVideoColorConversion::ConvertI420ToRGB(decodedImage->planes[VPX_PLANE_Y], decodedImage->stride[VPX_PLANE_Y],
+    decodedImage->planes[VPX_PLANE_U], decodedImage->planes[VPX_PLANE_V], decodedImage->stride[VPX_PLANE_U],
+    dimensions[0], dimensions[1], imagePointer);
+
   return true;
 }
 
@@ -160,32 +532,93 @@ bool vtkIGTLVP9VolumeCodec::EncodeImageDataInternal(vtkImageData* inputImageData
     return false;
   }
 
-  igtl::VideoMessage::Pointer videoMessage = igtl::VideoMessage::New();
-  igtlioVideoConverter::HeaderData headerData = igtlioVideoConverter::HeaderData();
-  igtlioVideoConverter::ContentData contentData = igtlioVideoConverter::ContentData();
-  contentData.videoMessage = videoMessage;
-  contentData.image = inputImageData;
-  contentData.transform = vtkSmartPointer<vtkMatrix4x4>::New();
-  headerData.deviceName = videoMessage->GetDeviceName();
-
-  if (!igtlioVideoConverter::toIGTL(headerData, contentData, this->Encoder))
+  int dimensions[3] = { 0, 0, 0 };
+  inputImageData->GetDimensions(dimensions);
+  int numberOfComponents = inputImageData->GetNumberOfScalarComponents();
+  if (inputImageData->GetScalarType() != VTK_UNSIGNED_CHAR || (numberOfComponents != 1 && numberOfComponents != 3))
   {
+    vtkErrorMacro("Cannot encode image, only unsigned char images with 1 or 3 components are supported");
     return false;
   }
+  if (dimensions[0] <= 0 || dimensions[1] <= 0 || dimensions[2] != 1)
+  {
+    vtkErrorMacro("Cannot encode image, only 2D images are supported");
+    return false;
+  }
+
+  unsigned int width = dimensions[0];
+  unsigned int height = dimensions[1];
+  if (!this->Internal->EncoderInitialized || this->Internal->EncoderParametersModified
+    || this->Internal->EncoderImage->d_w != width || this->Internal->EncoderImage->d_h != height)
+  {
+    if (!this->Internal->InitializeEncoder(this, width, height))
+    {
+      return false;
+    }
+  }
 
-  unsigned char* framePointer = (unsigned char*)videoMessage->GetPackPointer() + IGTL_HEADER_SIZE + IGTL_VIDEO_HEADER_SIZE;
-  int bitstreamSize = videoMessage->GetBitStreamSize();
-  vtkSmartPointer<vtkUnsignedCharArray> frameData = vtkSmartPointer<vtkUnsignedCharArray>::New();
-  frameData->Allocate(bitstreamSize);
+  const unsigned char* imagePointer = static_cast<const unsigned char*>(inputImageData->GetScalarPointer());
+  vpx_image_t* encoderImage = this->Internal->EncoderImage;
+  if (numberOfComponents == 3)
+  {
+    vtkIGTLVideoColorConversion::ConvertRGBToI420(imagePointer, width, height,
+      encoderImage->planes[VPX_PLANE_Y], encoderImage->stride[VPX_PLANE_Y],
+      encoderImage->planes[VPX_PLANE_U], encoderImage->planes[VPX_PLANE_V], encoderImage->stride[VPX_PLANE_U]);
+    this->Internal->EncoderChromaNeutral = false;
+  }
+  else
+  {
+    // Only the luma plane changes between grayscale frames
+    vtkInternal::CopyGrayToLuma(imagePointer, width, height, encoderImage);
+    if (!this->Internal->EncoderChromaNeutral)
+    {
+      vtkInternal::SetNeutralChroma(encoderImage);
+      this->Internal->EncoderChromaNeutral = true;
+    }
+  }
 
-  memcpy(frameData->GetPointer(0), framePointer, bitstreamSize);
+  vpx_enc_frame_flags_t flags = forceKeyFrame ? VPX_EFLAG_FORCE_KF : 0;
+  if (vpx_codec_encode(&this->Internal->EncoderContext, this->Internal->EncoderImage, this->Internal->EncoderFrameIndex++, 1, flags, VPX_DL_REALTIME) != VPX_CODEC_OK)
+  {
+    vtkErrorMacro("Failed to encode frame: " << vpx_codec_error(&this->Internal->EncoderContext));
+    return false;
+  }
+
+  // The bitstream is copied from the encoder into a recycled array, frames may reference it after the next frame is encoded
+  bool keyFrame = false;
+  vtkIdType frameSize = 0;
+  this->Internal->EncoderPackets.clear();
+  vpx_codec_iter_t iterator = NULL;
+  const vpx_codec_cx_pkt_t* packet = NULL;
+  while ((packet = vpx_codec_get_cx_data(&this->Internal->EncoderContext, &iterator)) != NULL)
+  {
+    if (packet->kind != VPX_CODEC_CX_FRAME_PKT)
+    {
+      continue;
+    }
+    this->Internal->EncoderPackets.push_back(packet);
+    frameSize += packet->data.frame.sz;
+    keyFrame = keyFrame || (packet->data.frame.flags & VPX_FRAME_IS_KEY);
+  }
+  if (frameSize == 0)
+  {
+    vtkErrorMacro("Failed to encode frame: no data");
+    return false;
+  }
+  vtkUnsignedCharArray* frameData = this->Internal->GetBitstreamBuffer(frameSize);
+  unsigned char* frameDataPointer = frameData->GetPointer(0);
+  for (std::vector<const vpx_codec_cx_pkt_t*>::iterator packetIt = this->Internal->EncoderPackets.begin();
+    packetIt != this->Internal->EncoderPackets.end(); ++packetIt)
+  {
+    memcpy(frameDataPointer, (*packetIt)->data.frame.buf, (*packetIt)->data.frame.sz);
+    frameDataPointer += (*packetIt)->data.frame.sz;
+  }
 
-  int dimensions[3] = { 0, 0, 0 };
-  inputImageData->GetDimensions(dimensions);
   outputFrame->SetDimensions(dimensions);
+  outputFrame->SetNumberOfComponents(numberOfComponents);
   outputFrame->SetFrameData(frameData);
   outputFrame->SetCodecFourCC(this->GetFourCC());
-  outputFrame->SetFrameType(videoMessage->GetFrameType() == FrameTypeKey ? vtkStreamingVolumeFrame::IFrame : vtkStreamingVolumeFrame::PFrame);
+  outputFrame->SetFrameType(keyFrame ? vtkStreamingVolumeFrame::IFrame : vtkStreamingVolumeFrame::PFrame);
 
   if (outputFrame->IsKeyFrame())
   {
@@ -204,4 +637,7 @@ bool vtkIGTLVP9VolumeCodec::EncodeImageDataInternal(vtkImageData* inputImageData
 void vtkIGTLVP9VolumeCodec::PrintSelf(ostream& os, vtkIndent indent)
 {
   Superclass::PrintSelf(os, indent);
-}
\ No newline at end of file
+  os << indent << "NumberOfThreads: " << this->Internal->GetNumberOfThreads() << std::endl;
+  os << indent << "TileColumns: " << this->Internal->TileColumns << std::endl;
+  os << indent << "RowMultiThreading: " << (this->Internal->RowMultiThreading ? "true" : "false") << std::endl;
+}
@@ -32,10 +32,6 @@ Care Ontario.
 #include <vtkObject.h>
 #include <vtkUnsignedCharArray.h>
 
-// OpenIGTLink includes
-#include <igtlVP9Encoder.h>
-#include <igtlVP9Decoder.h>
-
 // OpenIGTLinkIF MRML includes
 #include "vtkSlicerOpenIGTLinkIFModuleMRMLExport.h"
 
@@ -58,17 +54,14 @@ public:
   std::string GetLosslessEncodingParameter() { return "losslessEncoding"; };
   std::string GetKeyFrameDistanceParameter() { return "keyFrameDistance"; };
   std::string GetBitRateParameter() { return "bitRate"; };
+  std::string GetNumberOfThreadsParameter() { return "numberOfThreads"; };
+  std::string GetTileColumnsParameter() { return "tileColumns"; };
+  std::string GetRowMultiThreadingParameter() { return "rowMultiThreading"; };
   virtual std::string GetParameterDescription(std::string parameterName);
 
   virtual std::string GetFourCC() { return "VP90"; };
 
 
-protected:
-
-  igtl::VP9Decoder::Pointer Decoder;
-  igtl::VP9Encoder::Pointer Encoder;
-  vtkSmartPointer<vtkImageData> YUVImage;
-
 protected:
   vtkIGTLVP9VolumeCodec();
   ~vtkIGTLVP9VolumeCodec();
@@ -79,6 +72,9 @@ protected:
 
   vtkSmartPointer<vtkStreamingVolumeFrame> LastEncodedFrame;
 
+  class vtkInternal;
+  vtkInternal* Internal;
+
 private:
   vtkIGTLVP9VolumeCodec(const vtkIGTLVP9VolumeCodec&);
   void operator=(const vtkIGTLVP9VolumeCodec&);
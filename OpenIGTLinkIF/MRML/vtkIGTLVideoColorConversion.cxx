@@ -0,0 +1,569 @@
+/*==============================================================================
+
+Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+See COPYRIGHT.txt
+or http://www.slicer.org/copyright/copyright.txt for details.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+==============================================================================*/
+
+#include "vtkIGTLVideoColorConversion.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+
+// STD includes
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define IGTL_VIDEO_COLOR_CONVERSION_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// Functions that use AVX2 instructions are compiled for AVX2 and only called if the CPU supports it
+#if defined(IGTL_VIDEO_COLOR_CONVERSION_X86) && (defined(__GNUC__) || defined(__clang__))
+#define IGTL_VIDEO_COLOR_CONVERSION_AVX2_FUNCTION __attribute__((target("avx2")))
+#else
+#define IGTL_VIDEO_COLOR_CONVERSION_AVX2_FUNCTION
+#endif
+
+//---------------------------------------------------------------------------
+vtkStandardNewMacro(vtkIGTLVideoColorConversion);
+
+//---------------------------------------------------------------------------
+// Fixed point BT.601 video range conversion, shared by all implementations.
+// RGB to YUV is the same as GenericEncoder::ConvertRGBToYUV of OpenIGTLink (truncated, chroma of the top-left
+// pixel of each 2x2 block), so that encoded images do not change compared to the OpenIGTLink conversion:
+//   Y = ((66 R + 129 G + 25 B) >> 8) + 16
+//   U = ((-38 R - 74 G + 112 B) >> 8) + 128
+//   V = ((112 R - 94 G - 18 B) >> 8) + 128
+//   R = (298 (Y - 16) + 409 (V - 128) + 128) >> 8
+//   G = (298 (Y - 16) - 100 (U - 128) - 208 (V - 128) + 128) >> 8
+//   B = (298 (Y - 16) + 516 (U - 128) + 128) >> 8
+// Each row is processed by a vectorized kernel, remaining pixels are processed by the scalar kernel.
+struct vtkIGTLVideoColorConversionKernels
+{
+  void (*ConvertI420ToRGBRow)(const unsigned char* yRow, const unsigned char* uRow, const unsigned char* vRow, unsigned char* rgbRow, unsigned int width);
+  void (*ConvertRGBToYRow)(const unsigned char* rgbRow, unsigned char* yRow, unsigned int width);
+  /// Compute chroma from the even columns of an even RGB row
+  void (*ConvertRGBToUVRow)(const unsigned char* rgbRow, unsigned int width, unsigned char* uRow, unsigned char* vRow);
+};
+
+//---------------------------------------------------------------------------
+static inline unsigned char ClampToByte(int value)
+{
+  return static_cast<unsigned char>(std::min(255, std::max(0, value)));
+}
+
+//---------------------------------------------------------------------------
+static void ConvertI420ToRGBRowScalar(const unsigned char* yRow, const unsigned char* uRow, const unsigned char* vRow,
+  unsigned char* rgbRow, unsigned int beginColumn, unsigned int endColumn)
+{
+  for (unsigned int column = beginColumn; column < endColumn; ++column)
+  {
+    int c = 298 * (yRow[column] - 16) + 128;
+    int d = uRow[column / 2] - 128;
+    int e = vRow[column / 2] - 128;
+    rgbRow[3 * column] = ClampToByte((c + 409 * e) >> 8);
+    rgbRow[3 * column + 1] = ClampToByte((c - 100 * d - 208 * e) >> 8);
+    rgbRow[3 * column + 2] = ClampToByte((c + 516 * d) >> 8);
+  }
+}
+
+//---------------------------------------------------------------------------
+static void ConvertRGBToYRowScalar(const unsigned char* rgbRow, unsigned char* yRow, unsigned int beginColumn, unsigned int endColumn)
+{
+  for (unsigned int column = beginColumn; column < endColumn; ++column)
+  {
+    int r = rgbRow[3 * column];
+    int g = rgbRow[3 * column + 1];
+    int b = rgbRow[3 * column + 2];
+    yRow[column] = static_cast<unsigned char>(((66 * r + 129 * g + 25 * b) >> 8) + 16);
+  }
+}
+
+//---------------------------------------------------------------------------
+static void ConvertRGBToUVRowScalar(const unsigned char* rgbRow, unsigned char* uRow, unsigned char* vRow,
+  unsigned int beginChromaColumn, unsigned int endChromaColumn)
+{
+  for (unsigned int chromaColumn = beginChromaColumn; chromaColumn < endChromaColumn; ++chromaColumn)
+  {
+    const unsigned char* rgb = rgbRow + 6 * chromaColumn;
+    int r = rgb[0];
+    int g = rgb[1];
+    int b = rgb[2];
+    uRow[chromaColumn] = static_cast<unsigned char>(((-38 * r - 74 * g + 112 * b) >> 8) + 128);
+    vRow[chromaColumn] = static_cast<unsigned char>(((112 * r - 94 * g - 18 * b) >> 8) + 128);
+  }
+}
+
+//---------------------------------------------------------------------------
+static void ConvertI420ToRGBRowScalar(const unsigned char* yRow, const unsigned char* uRow, const unsigned char* vRow, unsigned char* rgbRow, unsigned int width)
+{
+  ConvertI420ToRGBRowScalar(yRow, uRow, vRow, rgbRow, 0, width);
+}
+
+//---------------------------------------------------------------------------
+static void ConvertRGBToYRowScalar(const unsigned char* rgbRow, unsigned char* yRow, unsigned int width)
+{
+  ConvertRGBToYRowScalar(rgbRow, yRow, 0, width);
+}
+
+//---------------------------------------------------------------------------
+static void ConvertRGBToUVRowScalar(const unsigned char* rgbRow, unsigned int width, unsigned char* uRow, unsigned char* vRow)
+{
+  ConvertRGBToUVRowScalar(rgbRow, uRow, vRow, 0, (width + 1) / 2);
+}
+
+#if defined(IGTL_VIDEO_COLOR_CONVERSION_X86)
+
+//---------------------------------------------------------------------------
+// Coefficients of a pair of 16-bit values that are multiplied and added by madd
+static inline int PairCoefficients(int first, int second)
+{
+  return static_cast<int>((static_cast<unsigned int>(static_cast<unsigned short>(second)) << 16) | static_cast<unsigned short>(first));
+}
+
+//---------------------------------------------------------------------------
+static void ConvertI420ToRGBRowSSE2(const unsigned char* yRow, const unsigned char* uRow, const unsigned char* vRow, unsigned char* rgbRow, unsigned int width)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i one = _mm_set1_epi16(1);
+  const __m128i lumaOffset = _mm_set1_epi16(16);
+  const __m128i chromaOffset = _mm_set1_epi16(128);
+  const __m128i rounding = _mm_set1_epi32(128);
+  const __m128i redCoefficients = _mm_set1_epi32(PairCoefficients(298, 409)); // (Y, V)
+  const __m128i greenCoefficients0 = _mm_set1_epi32(PairCoefficients(298, -100)); // (Y, U)
+  const __m128i greenCoefficients1 = _mm_set1_epi32(PairCoefficients(-208, 128)); // (V, 1)
+  const __m128i blueCoefficients = _mm_set1_epi32(PairCoefficients(298, 516)); // (Y, U)
+
+  unsigned int column = 0;
+  for (; column + 8 <= width; column += 8)
+  {
+    int u4 = 0;
+    int v4 = 0;
+    memcpy(&u4, uRow + column / 2, 4);
+    memcpy(&v4, vRow + column / 2, 4);
+    __m128i u8 = _mm_cvtsi32_si128(u4);
+    __m128i v8 = _mm_cvtsi32_si128(v4);
+    // Each chroma sample is used for two pixels
+    u8 = _mm_unpacklo_epi8(u8, u8);
+    v8 = _mm_unpacklo_epi8(v8, v8);
+
+    __m128i y = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(yRow + column)), zero), lumaOffset);
+    __m128i u = _mm_sub_epi16(_mm_unpacklo_epi8(u8, zero), chromaOffset);
+    __m128i v = _mm_sub_epi16(_mm_unpacklo_epi8(v8, zero), chromaOffset);
+
+    __m128i yvLow = _mm_unpacklo_epi16(y, v);
+    __m128i yvHigh = _mm_unpackhi_epi16(y, v);
+    __m128i yuLow = _mm_unpacklo_epi16(y, u);
+    __m128i yuHigh = _mm_unpackhi_epi16(y, u);
+    __m128i vOneLow = _mm_unpacklo_epi16(v, one);
+    __m128i vOneHigh = _mm_unpackhi_epi16(v, one);
+
+    __m128i rLow = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yvLow, redCoefficients), rounding), 8);
+    __m128i rHigh = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yvHigh, redCoefficients), rounding), 8);
+    __m128i gLow = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yuLow, greenCoefficients0), _mm_madd_epi16(vOneLow, greenCoefficients1)), 8);
+    __m128i gHigh = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yuHigh, greenCoefficients0), _mm_madd_epi16(vOneHigh, greenCoefficients1)), 8);
+    __m128i bLow = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yuLow, blueCoefficients), rounding), 8);
+    __m128i bHigh = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yuHigh, blueCoefficients), rounding), 8);
+
+    // Saturating packs clamp to 0..255
+    __m128i r = _mm_packs_epi32(rLow, rHigh);
+    __m128i g = _mm_packs_epi32(gLow, gHigh);
+    __m128i b = _mm_packs_epi32(bLow, bHigh);
+    r = _mm_packus_epi16(r, r);
+    g = _mm_packus_epi16(g, g);
+    b = _mm_packus_epi16(b, b);
+
+    // Interleave to RGBX and write 4 bytes per pixel, overwriting the X of the previous pixel
+    __m128i rg = _mm_unpacklo_epi8(r, g);
+    __m128i bx = _mm_unpacklo_epi8(b, zero);
+    __m128i rgbx[2] = { _mm_unpacklo_epi16(rg, bx), _mm_unpackhi_epi16(rg, bx) };
+    unsigned char* rgb = rgbRow + 3 * column;
+    for (int half = 0; half < 2; ++half)
+    {
+      for (int pixel = 0; pixel < 4; ++pixel)
+      {
+        int value = _mm_cvtsi128_si32(rgbx[half]);
+        rgbx[half] = _mm_srli_si128(rgbx[half], 4);
+        memcpy(rgb, &value, (half == 1 && pixel == 3) ? 3 : 4);
+        rgb += 3;
+      }
+    }
+  }
+  ConvertI420ToRGBRowScalar(yRow, uRow, vRow, rgbRow, column, width);
+}
+
+//---------------------------------------------------------------------------
+static void ConvertRGBToYRowSSE2(const unsigned char* rgbRow, unsigned char* yRow, unsigned int width)
+{
+  const __m128i one = _mm_set1_epi16(1);
+  const __m128i redGreenCoefficients = _mm_set1_epi32(PairCoefficients(66, 129));
+  const __m128i blueCoefficients = _mm_set1_epi32(PairCoefficients(25, 4096)); // (B, 1)
+
+  unsigned int column = 0;
+  for (; column + 8 <= width; column += 8)
+  {
+    const unsigned char* rgb = rgbRow + 3 * column;
+    __m128i r = _mm_setr_epi16(rgb[0], rgb[3], rgb[6], rgb[9], rgb[12], rgb[15], rgb[18], rgb[21]);
+    __m128i g = _mm_setr_epi16(rgb[1], rgb[4], rgb[7], rgb[10], rgb[13], rgb[16], rgb[19], rgb[22]);
+    __m128i b = _mm_setr_epi16(rgb[2], rgb[5], rgb[8], rgb[11], rgb[14], rgb[17], rgb[20], rgb[23]);
+
+    __m128i yLow = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(r, g), redGreenCoefficients),
+      _mm_madd_epi16(_mm_unpacklo_epi16(b, one), blueCoefficients));
+    __m128i yHigh = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(r, g), redGreenCoefficients),
+      _mm_madd_epi16(_mm_unpackhi_epi16(b, one), blueCoefficients));
+    __m128i y = _mm_packs_epi32(_mm_srai_epi32(yLow, 8), _mm_srai_epi32(yHigh, 8));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(yRow + column), _mm_packus_epi16(y, y));
+  }
+  ConvertRGBToYRowScalar(rgbRow, yRow, column, width);
+}
+
+//---------------------------------------------------------------------------
+static void ConvertRGBToUVRowSSE2(const unsigned char* rgbRow, unsigned int width, unsigned char* uRow, unsigned char* vRow)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i evenSelection = _mm_set1_epi32(PairCoefficients(1, 0));
+  const __m128i chromaOffset = _mm_set1_epi32(128);
+  const __m128i uRedGreenCoefficients = _mm_set1_epi32(PairCoefficients(-38, -74));
+  const __m128i uBlueCoefficients = _mm_set1_epi32(PairCoefficients(112, 0));
+  const __m128i vRedGreenCoefficients = _mm_set1_epi32(PairCoefficients(112, -94));
+  const __m128i vBlueCoefficients = _mm_set1_epi32(PairCoefficients(-18, 0));
+
+  // 4 chroma samples from 8 pixels
+  unsigned int chromaColumn = 0;
+  for (; 2 * chromaColumn + 8 <= width; chromaColumn += 4)
+  {
+    const unsigned char* rgb = rgbRow + 6 * chromaColumn;
+    __m128i samples[3];
+    for (int component = 0; component < 3; ++component)
+    {
+      const unsigned char* c = rgb + component;
+      __m128i row = _mm_setr_epi16(c[0], c[3], c[6], c[9], c[12], c[15], c[18], c[21]);
+      // Pixel of the even column of each horizontal pixel pair
+      samples[component] = _mm_packs_epi32(_mm_madd_epi16(row, evenSelection), zero);
+    }
+    __m128i redGreen = _mm_unpacklo_epi16(samples[0], samples[1]);
+    __m128i blueZero = _mm_unpacklo_epi16(samples[2], zero);
+    __m128i u = _mm_add_epi32(_mm_madd_epi16(redGreen, uRedGreenCoefficients), _mm_madd_epi16(blueZero, uBlueCoefficients));
+    __m128i v = _mm_add_epi32(_mm_madd_epi16(redGreen, vRedGreenCoefficients), _mm_madd_epi16(blueZero, vBlueCoefficients));
+    u = _mm_add_epi32(_mm_srai_epi32(u, 8), chromaOffset);
+    v = _mm_add_epi32(_mm_srai_epi32(v, 8), chromaOffset);
+    u = _mm_packs_epi32(u, u);
+    v = _mm_packs_epi32(v, v);
+    int u4 = _mm_cvtsi128_si32(_mm_packus_epi16(u, u));
+    int v4 = _mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+    memcpy(uRow + chromaColumn, &u4, 4);
+    memcpy(vRow + chromaColumn, &v4, 4);
+  }
+  ConvertRGBToUVRowScalar(rgbRow, uRow, vRow, chromaColumn, (width + 1) / 2);
+}
+
+//---------------------------------------------------------------------------
+// Pack 16 32-bit values (low: pixels 0-3 and 8-11, high: pixels 4-7 and 12-15, as computed from
+// the 16-bit unpack of a 256-bit register) to 16 bytes in pixel order, with unsigned saturation.
+IGTL_VIDEO_COLOR_CONVERSION_AVX2_FUNCTION
+static inline __m128i PackToBytesAVX2(__m256i low, __m256i high)
+{
+  __m256i packed = _mm256_packs_epi32(low, high); // pixels 0-7 in lane 0, 8-15 in lane 1
+  packed = _mm256_packus_epi16(packed, packed);
+  packed = _mm256_permute4x64_epi64(packed, 0x08); // qwords 0 and 2
+  return _mm256_castsi256_si128(packed);
+}
+
+//---------------------------------------------------------------------------
+IGTL_VIDEO_COLOR_CONVERSION_AVX2_FUNCTION
+static void ConvertI420ToRGBRowAVX2(const unsigned char* yRow, const unsigned char* uRow, const unsigned char* vRow, unsigned char* rgbRow, unsigned int width)
+{
+  const __m256i one = _mm256_set1_epi16(1);
+  const __m256i lumaOffset = _mm256_set1_epi16(16);
+  const __m256i chromaOffset = _mm256_set1_epi16(128);
+  const __m256i rounding = _mm256_set1_epi32(128);
+  const __m256i redCoefficients = _mm256_set1_epi32(PairCoefficients(298, 409)); // (Y, V)
+  const __m256i greenCoefficients0 = _mm256_set1_epi32(PairCoefficients(298, -100)); // (Y, U)
+  const __m256i greenCoefficients1 = _mm256_set1_epi32(PairCoefficients(-208, 128)); // (V, 1)
+  const __m256i blueCoefficients = _mm256_set1_epi32(PairCoefficients(298, 516)); // (Y, U)
+
+  // Shuffles that interleave 16 R, G, B values to 48 bytes of RGB
+  const __m128i redShuffle0 = _mm_setr_epi8(0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1, 5);
+  const __m128i greenShuffle0 = _mm_setr_epi8(-1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1);
+  const __m128i blueShuffle0 = _mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1);
+  const __m128i redShuffle1 = _mm_setr_epi8(-1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10, -1);
+  const __m128i greenShuffle1 = _mm_setr_epi8(5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10);
+  const __m128i blueShuffle1 = _mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1);
+  const __m128i redShuffle2 = _mm_setr_epi8(-1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1);
+  const __m128i greenShuffle2 = _mm_setr_epi8(-1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1);
+  const __m128i blueShuffle2 = _mm_setr_epi8(10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15);
+
+  unsigned int column = 0;
+  for (; column + 16 <= width; column += 16)
+  {
+    __m128i u8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(uRow + column / 2));
+    __m128i v8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(vRow + column / 2));
+    // Each chroma sample is used for two pixels
+    u8 = _mm_unpacklo_epi8(u8, u8);
+    v8 = _mm_unpacklo_epi8(v8, v8);
+
+    __m256i y = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(yRow + column))), lumaOffset);
+    __m256i u = _mm256_sub_epi16(_mm256_cvtepu8_epi16(u8), chromaOffset);
+    __m256i v = _mm256_sub_epi16(_mm256_cvtepu8_epi16(v8), chromaOffset);
+
+    __m256i yvLow = _mm256_unpacklo_epi16(y, v);
+    __m256i yvHigh = _mm256_unpackhi_epi16(y, v);
+    __m256i yuLow = _mm256_unpacklo_epi16(y, u);
+    __m256i yuHigh = _mm256_unpackhi_epi16(y, u);
+    __m256i vOneLow = _mm256_unpacklo_epi16(v, one);
+    __m256i vOneHigh = _mm256_unpackhi_epi16(v, one);
+
+    __m128i r = PackToBytesAVX2(
+      _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yvLow, redCoefficients), rounding), 8),
+      _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yvHigh, redCoefficients), rounding), 8));
+    __m128i g = PackToBytesAVX2(
+      _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yuLow, greenCoefficients0), _mm256_madd_epi16(vOneLow, greenCoefficients1)), 8),
+      _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yuHigh, greenCoefficients0), _mm256_madd_epi16(vOneHigh, greenCoefficients1)), 8));
+    __m128i b = PackToBytesAVX2(
+      _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yuLow, blueCoefficients), rounding), 8),
+      _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(yuHigh, blueCoefficients), rounding), 8));
+
+    __m128i* rgb = reinterpret_cast<__m128i*>(rgbRow + 3 * column);
+    _mm_storeu_si128(rgb, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, redShuffle0), _mm_shuffle_epi8(g, greenShuffle0)), _mm_shuffle_epi8(b, blueShuffle0)));
+    _mm_storeu_si128(rgb + 1, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, redShuffle1), _mm_shuffle_epi8(g, greenShuffle1)), _mm_shuffle_epi8(b, blueShuffle1)));
+    _mm_storeu_si128(rgb + 2, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, redShuffle2), _mm_shuffle_epi8(g, greenShuffle2)), _mm_shuffle_epi8(b, blueShuffle2)));
+  }
+  ConvertI420ToRGBRowScalar(yRow, uRow, vRow, rgbRow, column, width);
+}
+
+//---------------------------------------------------------------------------
+// Split 16 packed RGB pixels to one register per component
+IGTL_VIDEO_COLOR_CONVERSION_AVX2_FUNCTION
+static inline void DeinterleaveRGBAVX2(const unsigned char* rgb, __m128i& r, __m128i& g, __m128i& b)
+{
+  const __m128i redShuffle0 = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i redShuffle1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+  const __m128i redShuffle2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+  const __m128i greenShuffle0 = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i greenShuffle1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+  const __m128i greenShuffle2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+  const __m128i blueShuffle0 = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i blueShuffle1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+  const __m128i blueShuffle2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+
+  __m128i in0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb));
+  __m128i in1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + 16));
+  __m128i in2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + 32));
+  r = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(in0, redShuffle0), _mm_shuffle_epi8(in1, redShuffle1)), _mm_shuffle_epi8(in2, redShuffle2));
+  g = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(in0, greenShuffle0), _mm_shuffle_epi8(in1, greenShuffle1)), _mm_shuffle_epi8(in2, greenShuffle2));
+  b = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(in0, blueShuffle0), _mm_shuffle_epi8(in1, blueShuffle1)), _mm_shuffle_epi8(in2, blueShuffle2));
+}
+
+//---------------------------------------------------------------------------
+IGTL_VIDEO_COLOR_CONVERSION_AVX2_FUNCTION
+static void ConvertRGBToYRowAVX2(const unsigned char* rgbRow, unsigned char* yRow, unsigned int width)
+{
+  const __m256i one = _mm256_set1_epi16(1);
+  const __m256i redGreenCoefficients = _mm256_set1_epi32(PairCoefficients(66, 129));
+  const __m256i blueCoefficients = _mm256_set1_epi32(PairCoefficients(25, 4096)); // (B, 1)
+
+  unsigned int column = 0;
+  for (; column + 16 <= width; column += 16)
+  {
+    __m128i r8, g8, b8;
+    DeinterleaveRGBAVX2(rgbRow + 3 * column, r8, g8, b8);
+    __m256i r = _mm256_cvtepu8_epi16(r8);
+    __m256i g = _mm256_cvtepu8_epi16(g8);
+    __m256i b = _mm256_cvtepu8_epi16(b8);
+    __m256i yLow = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(r, g), redGreenCoefficients),
+      _mm256_madd_epi16(_mm256_unpacklo_epi16(b, one), blueCoefficients));
+    __m256i yHigh = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(r, g), redGreenCoefficients),
+      _mm256_madd_epi16(_mm256_unpackhi_epi16(b, one), blueCoefficients));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(yRow + column), PackToBytesAVX2(_mm256_srai_epi32(yLow, 8), _mm256_srai_epi32(yHigh, 8)));
+  }
+  ConvertRGBToYRowScalar(rgbRow, yRow, column, width);
+}
+
+//---------------------------------------------------------------------------
+IGTL_VIDEO_COLOR_CONVERSION_AVX2_FUNCTION
+static void ConvertRGBToUVRowAVX2(const unsigned char* rgbRow, unsigned int width, unsigned char* uRow, unsigned char* vRow)
+{
+  const __m256i evenSelection = _mm256_set1_epi32(PairCoefficients(1, 0));
+  const __m256i chromaOffset = _mm256_set1_epi32(128);
+  const __m256i chromaOrder = _mm256_setr_epi32(0, 4, 0, 4, 0, 4, 0, 4);
+
+  // 8 chroma samples from 16 pixels
+  unsigned int chromaColumn = 0;
+  for (; 2 * chromaColumn + 16 <= width; chromaColumn += 8)
+  {
+    __m128i row[3];
+    DeinterleaveRGBAVX2(rgbRow + 6 * chromaColumn, row[0], row[1], row[2]);
+    __m256i samples[3];
+    for (int component = 0; component < 3; ++component)
+    {
+      // Pixel of the even column of each horizontal pixel pair
+      samples[component] = _mm256_madd_epi16(_mm256_cvtepu8_epi16(row[component]), evenSelection);
+    }
+    __m256i u = _mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi32(samples[0], _mm256_set1_epi32(-38)),
+      _mm256_mullo_epi32(samples[1], _mm256_set1_epi32(-74))), _mm256_mullo_epi32(samples[2], _mm256_set1_epi32(112)));
+    __m256i v = _mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi32(samples[0], _mm256_set1_epi32(112)),
+      _mm256_mullo_epi32(samples[1], _mm256_set1_epi32(-94))), _mm256_mullo_epi32(samples[2], _mm256_set1_epi32(-18)));
+    u = _mm256_add_epi32(_mm256_srai_epi32(u, 8), chromaOffset);
+    v = _mm256_add_epi32(_mm256_srai_epi32(v, 8), chromaOffset);
+    // Values 0-3 are in lane 0 and 4-7 in lane 1 after packing
+    u = _mm256_packs_epi32(u, u);
+    v = _mm256_packs_epi32(v, v);
+    u = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(u, u), chromaOrder);
+    v = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(v, v), chromaOrder);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(uRow + chromaColumn), _mm256_castsi256_si128(u));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(vRow + chromaColumn), _mm256_castsi256_si128(v));
+  }
+  ConvertRGBToUVRowScalar(rgbRow, uRow, vRow, chromaColumn, (width + 1) / 2);
+}
+
+//---------------------------------------------------------------------------
+static bool IsAVX2Supported()
+{
+#if defined(_MSC_VER)
+  int info[4] = { 0, 0, 0, 0 };
+  __cpuid(info, 0);
+  if (info[0] < 7)
+  {
+    return false;
+  }
+  __cpuid(info, 1);
+  bool osUsesXSave = (info[2] & (1 << 27)) != 0;
+  bool cpuSupportsAVX = (info[2] & (1 << 28)) != 0;
+  // The operating system must save the AVX registers
+  if (!osUsesXSave || !cpuSupportsAVX || (_xgetbv(0) & 0x6) != 0x6)
+  {
+    return false;
+  }
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif // IGTL_VIDEO_COLOR_CONVERSION_X86
+
+//---------------------------------------------------------------------------
+static const vtkIGTLVideoColorConversionKernels& GetConversionKernels(int instructionSet)
+{
+  static const vtkIGTLVideoColorConversionKernels kernels[vtkIGTLVideoColorConversion::InstructionSet_Last] =
+  {
+    { &ConvertI420ToRGBRowScalar, &ConvertRGBToYRowScalar, &ConvertRGBToUVRowScalar },
+#if defined(IGTL_VIDEO_COLOR_CONVERSION_X86)
+    { &ConvertI420ToRGBRowSSE2, &ConvertRGBToYRowSSE2, &ConvertRGBToUVRowSSE2 },
+    { &ConvertI420ToRGBRowAVX2, &ConvertRGBToYRowAVX2, &ConvertRGBToUVRowAVX2 },
+#else
+    { &ConvertI420ToRGBRowScalar, &ConvertRGBToYRowScalar, &ConvertRGBToUVRowScalar },
+    { &ConvertI420ToRGBRowScalar, &ConvertRGBToYRowScalar, &ConvertRGBToUVRowScalar },
+#endif
+  };
+  if (instructionSet < 0 || !vtkIGTLVideoColorConversion::IsInstructionSetAvailable(instructionSet))
+  {
+    instructionSet = vtkIGTLVideoColorConversion::GetBestAvailableInstructionSet();
+  }
+  return kernels[instructionSet];
+}
+
+//---------------------------------------------------------------------------
+vtkIGTLVideoColorConversion::vtkIGTLVideoColorConversion()
+{
+}
+
+//---------------------------------------------------------------------------
+vtkIGTLVideoColorConversion::~vtkIGTLVideoColorConversion()
+{
+}
+
+//---------------------------------------------------------------------------
+void vtkIGTLVideoColorConversion::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "BestAvailableInstructionSet: " << GetInstructionSetAsString(GetBestAvailableInstructionSet()) << std::endl;
+}
+
+//---------------------------------------------------------------------------
+int vtkIGTLVideoColorConversion::GetBestAvailableInstructionSet()
+{
+#if defined(IGTL_VIDEO_COLOR_CONVERSION_X86)
+  // SSE2 is supported by all x86-64 CPUs
+  static const int bestInstructionSet = IsAVX2Supported() ? InstructionSetAVX2 : InstructionSetSSE2;
+  return bestInstructionSet;
+#else
+  return InstructionSetScalar;
+#endif
+}
+
+//---------------------------------------------------------------------------
+bool vtkIGTLVideoColorConversion::IsInstructionSetAvailable(int instructionSet)
+{
+  return instructionSet >= InstructionSetScalar && instructionSet <= GetBestAvailableInstructionSet();
+}
+
+//---------------------------------------------------------------------------
+const char* vtkIGTLVideoColorConversion::GetInstructionSetAsString(int instructionSet)
+{
+  switch (instructionSet)
+  {
+  case InstructionSetAutomatic:
+    return "Automatic";
+  case InstructionSetScalar:
+    return "Scalar";
+  case InstructionSetSSE2:
+    return "SSE2";
+  case InstructionSetAVX2:
+    return "AVX2";
+  default:
+    return "Unknown";
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkIGTLVideoColorConversion::ConvertI420ToRGB(const unsigned char* yPlane, int yStride,
+  const unsigned char* uPlane, const unsigned char* vPlane, int uvStride,
+  unsigned int width, unsigned int height, unsigned char* rgb, int instructionSet/*=InstructionSetAutomatic*/)
+{
+  const vtkIGTLVideoColorConversionKernels& kernels = GetConversionKernels(instructionSet);
+  for (unsigned int row = 0; row < height; ++row)
+  {
+    kernels.ConvertI420ToRGBRow(yPlane + static_cast<size_t>(yStride) * row,
+      uPlane + static_cast<size_t>(uvStride) * (row / 2), vPlane + static_cast<size_t>(uvStride) * (row / 2),
+      rgb + static_cast<size_t>(3) * width * row, width);
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkIGTLVideoColorConversion::ConvertRGBToI420(const unsigned char* rgb, unsigned int width, unsigned int height,
+  unsigned char* yPlane, int yStride, unsigned char* uPlane, unsigned char* vPlane, int uvStride,
+  int instructionSet/*=InstructionSetAutomatic*/)
+{
+  if (width == 0 || height == 0)
+  {
+    return;
+  }
+  const vtkIGTLVideoColorConversionKernels& kernels = GetConversionKernels(instructionSet);
+  size_t rgbRowSize = static_cast<size_t>(3) * width;
+  for (unsigned int row = 0; row < height; ++row)
+  {
+    kernels.ConvertRGBToYRow(rgb + rgbRowSize * row, yPlane + static_cast<size_t>(yStride) * row, width);
+  }
+  for (unsigned int chromaRow = 0; chromaRow < (height + 1) / 2; ++chromaRow)
+  {
+    kernels.ConvertRGBToUVRow(rgb + rgbRowSize * (2 * chromaRow), width,
+      uPlane + static_cast<size_t>(uvStride) * chromaRow, vPlane + static_cast<size_t>(uvStride) * chromaRow);
+  }
+}
@@ -0,0 +1,76 @@
+/*==============================================================================
+
+Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+See COPYRIGHT.txt
+or http://www.slicer.org/copyright/copyright.txt for details.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkIGTLVideoColorConversion_h
+#define __vtkIGTLVideoColorConversion_h
+
+// VTK includes
+#include <vtkObject.h>
+
+// OpenIGTLinkIF MRML includes
+#include "vtkSlicerOpenIGTLinkIFModuleMRMLExport.h"
+
+/// \brief Conversion between packed RGB and planar I420 (YUV 4:2:0) images of video codecs.
+///
+/// Colors are converted using BT.601 video range coefficients in fixed point arithmetic.
+/// Conversion of RGB images is bit-exact with GenericEncoder::ConvertRGBToYUV of OpenIGTLink:
+/// chroma is the color of the top-left pixel of each 2x2 pixel block and results are truncated.
+///
+/// Vectorized implementations are selected at runtime based on the instruction sets supported by the CPU.
+/// All implementations produce identical output.
+class VTK_SLICER_OPENIGTLINKIF_MODULE_MRML_EXPORT vtkIGTLVideoColorConversion : public vtkObject
+{
+public:
+  static vtkIGTLVideoColorConversion* New();
+  vtkTypeMacro(vtkIGTLVideoColorConversion, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  enum InstructionSet
+  {
+    InstructionSetAutomatic = -1,
+    InstructionSetScalar,
+    InstructionSetSSE2,
+    InstructionSetAVX2,
+    InstructionSet_Last
+  };
+
+  /// Most efficient instruction set that is supported by the CPU
+  static int GetBestAvailableInstructionSet();
+  static bool IsInstructionSetAvailable(int instructionSet);
+  static const char* GetInstructionSetAsString(int instructionSet);
+
+  /// Convert an I420 image to packed RGB.
+  /// If the requested instruction set is not available then the best available instruction set is used instead.
+  static void ConvertI420ToRGB(const unsigned char* yPlane, int yStride,
+    const unsigned char* uPlane, const unsigned char* vPlane, int uvStride,
+    unsigned int width, unsigned int height, unsigned char* rgb, int instructionSet = InstructionSetAutomatic);
+
+  /// Convert a packed RGB image to I420.
+  /// If the requested instruction set is not available then the best available instruction set is used instead.
+  static void ConvertRGBToI420(const unsigned char* rgb, unsigned int width, unsigned int height,
+    unsigned char* yPlane, int yStride, unsigned char* uPlane, unsigned char* vPlane, int uvStride,
+    int instructionSet = InstructionSetAutomatic);
+
+protected:
+  vtkIGTLVideoColorConversion();
+  ~vtkIGTLVideoColorConversion();
+
+private:
+  vtkIGTLVideoColorConversion(const vtkIGTLVideoColorConversion&);
+  void operator=(const vtkIGTLVideoColorConversion&);
+};
+
+#endif
@@ -0,0 +1,166 @@
+/*==============================================================================
+
+Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+See COPYRIGHT.txt
+or http://www.slicer.org/copyright/copyright.txt for details.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+==============================================================================*/
+
+#include "vtkIGTLVideoFramePool.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+
+// STD includes
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+
+//---------------------------------------------------------------------------
+vtkStandardNewMacro(vtkIGTLVideoFramePool);
+
+//---------------------------------------------------------------------------
+vtkIGTLVideoFramePool::vtkIGTLVideoFramePool()
+  : BufferSizeHighWaterMark(0)
+  , NumberOfAllocations(0)
+{
+}
+
+//---------------------------------------------------------------------------
+vtkIGTLVideoFramePool::~vtkIGTLVideoFramePool()
+{
+  for (std::vector<PooledFrame>::iterator frameIt = this->Frames.begin(); frameIt != this->Frames.end(); ++frameIt)
+  {
+    if (!this->IsInUse(*frameIt))
+    {
+      continue;
+    }
+    // The frame outlives the pool, so its data must be moved to memory that is owned by the frame data array
+    vtkIdType size = frameIt->FrameData->GetNumberOfValues();
+    unsigned char* ownedData = static_cast<unsigned char*>(malloc(size > 0 ? size : 1));
+    if (size > 0)
+    {
+      memcpy(ownedData, frameIt->Buffer.data(), size);
+    }
+    frameIt->FrameData->SetArray(ownedData, size, 0);
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkIGTLVideoFramePool::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfFrames: " << this->GetNumberOfFrames() << std::endl;
+  os << indent << "NumberOfImages: " << this->GetNumberOfImages() << std::endl;
+  os << indent << "BufferSizeHighWaterMark: " << this->BufferSizeHighWaterMark << std::endl;
+  os << indent << "NumberOfAllocations: " << this->NumberOfAllocations << std::endl;
+}
+
+//---------------------------------------------------------------------------
+bool vtkIGTLVideoFramePool::IsInUse(const PooledFrame& pooledFrame)
+{
+  // The pool holds one reference to the frame, and the pool and the frame hold one reference to the frame data each
+  return pooledFrame.Frame->GetReferenceCount() > 1 || pooledFrame.FrameData->GetReferenceCount() > 2;
+}
+
+//---------------------------------------------------------------------------
+int vtkIGTLVideoFramePool::GetNumberOfFrames()
+{
+  return static_cast<int>(this->Frames.size());
+}
+
+//---------------------------------------------------------------------------
+vtkStreamingVolumeFrame* vtkIGTLVideoFramePool::GetFrame(const unsigned char* bitstream, vtkIdType size)
+{
+  if (size > this->BufferSizeHighWaterMark)
+  {
+    this->BufferSizeHighWaterMark = size;
+  }
+
+  // Frames that are not in use still reference their previous frame, which keeps that frame in use.
+  // Release these references by following each chain from a frame that is not in use, as long as
+  // releasing a reference makes the previous frame unused, so that each reference is visited once.
+  std::unordered_map<vtkStreamingVolumeFrame*, PooledFrame*> pooledFrames;
+  pooledFrames.reserve(this->Frames.size());
+  for (std::vector<PooledFrame>::iterator frameIt = this->Frames.begin(); frameIt != this->Frames.end(); ++frameIt)
+  {
+    pooledFrames[frameIt->Frame] = &(*frameIt);
+  }
+  for (std::vector<PooledFrame>::iterator frameIt = this->Frames.begin(); frameIt != this->Frames.end(); ++frameIt)
+  {
+    PooledFrame* unusedFrame = &(*frameIt);
+    while (unusedFrame && unusedFrame->Frame->GetPreviousFrame() && !this->IsInUse(*unusedFrame))
+    {
+      // Frames that are not from this pool may be deleted by releasing the reference, so they are not followed
+      std::unordered_map<vtkStreamingVolumeFrame*, PooledFrame*>::iterator previousFrameIt =
+        pooledFrames.find(unusedFrame->Frame->GetPreviousFrame());
+      unusedFrame->Frame->SetPreviousFrame(nullptr);
+      unusedFrame = (previousFrameIt != pooledFrames.end() ? previousFrameIt->second : nullptr);
+    }
+  }
+
+  PooledFrame* pooledFrame = nullptr;
+  for (std::vector<PooledFrame>::iterator frameIt = this->Frames.begin(); frameIt != this->Frames.end(); ++frameIt)
+  {
+    if (!this->IsInUse(*frameIt))
+    {
+      pooledFrame = &(*frameIt);
+      break;
+    }
+  }
+  if (!pooledFrame)
+  {
+    this->Frames.push_back(PooledFrame());
+    pooledFrame = &(this->Frames.back());
+    pooledFrame->Frame = vtkSmartPointer<vtkStreamingVolumeFrame>::New();
+    pooledFrame->FrameData = vtkSmartPointer<vtkUnsignedCharArray>::New();
+    pooledFrame->Frame->SetFrameData(pooledFrame->FrameData);
+    this->NumberOfAllocations++;
+  }
+
+  // Grow to the largest frame size, so that the buffer is not reallocated for each larger frame
+  if (pooledFrame->Buffer.size() < static_cast<size_t>(this->BufferSizeHighWaterMark))
+  {
+    pooledFrame->Buffer.resize(this->BufferSizeHighWaterMark);
+    this->NumberOfAllocations++;
+  }
+  if (size > 0)
+  {
+    memcpy(pooledFrame->Buffer.data(), bitstream, size);
+  }
+  // The frame data size must match the bitstream size, as the codec decodes the entire array
+  pooledFrame->FrameData->SetArray(pooledFrame->Buffer.data(), size, 1);
+  pooledFrame->FrameData->Modified();
+  pooledFrame->Frame->SetPreviousFrame(nullptr);
+  return pooledFrame->Frame;
+}
+
+//---------------------------------------------------------------------------
+vtkImageData* vtkIGTLVideoFramePool::GetImage()
+{
+  for (std::vector<vtkSmartPointer<vtkImageData> >::iterator imageIt = this->Images.begin(); imageIt != this->Images.end(); ++imageIt)
+  {
+    // Only the pool references the image
+    if ((*imageIt)->GetReferenceCount() == 1)
+    {
+      return *imageIt;
+    }
+  }
+  this->Images.push_back(vtkSmartPointer<vtkImageData>::New());
+  this->NumberOfAllocations++;
+  return this->Images.back();
+}
+
+//---------------------------------------------------------------------------
+int vtkIGTLVideoFramePool::GetNumberOfImages()
+{
+  return static_cast<int>(this->Images.size());
+}
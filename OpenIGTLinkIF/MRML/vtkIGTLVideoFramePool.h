@@ -0,0 +1,99 @@
+/*==============================================================================
+
+Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+See COPYRIGHT.txt
+or http://www.slicer.org/copyright/copyright.txt for details.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkIGTLVideoFramePool_h
+#define __vtkIGTLVideoFramePool_h
+
+// vtkAddon includes
+#include <vtkStreamingVolumeFrame.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkObject.h>
+#include <vtkSmartPointer.h>
+#include <vtkUnsignedCharArray.h>
+
+// STD includes
+#include <vector>
+
+// OpenIGTLinkIF MRML includes
+#include "vtkSlicerOpenIGTLinkIFModuleMRMLExport.h"
+
+/// \brief Recycles streaming volume frames and decoded images of a received video stream.
+///
+/// A frame is reused when it is no longer referenced outside of the pool (by a volume node, a codec,
+/// or as the previous frame of another frame in use). The pool grows to the largest number of frames
+/// that have been in use at the same time, and frame buffers grow to the largest frame received,
+/// so that receiving frames does not allocate memory once the stream reached a steady state.
+/// Images are reused the same way when they are no longer referenced outside of the pool.
+///
+/// A pool is not thread-safe, it must only be used from one thread. Frames and images may be released
+/// by other threads.
+class VTK_SLICER_OPENIGTLINKIF_MODULE_MRML_EXPORT vtkIGTLVideoFramePool : public vtkObject
+{
+public:
+  static vtkIGTLVideoFramePool* New();
+  vtkTypeMacro(vtkIGTLVideoFramePool, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Get a frame that is not in use and copy the bitstream into its frame data.
+  /// The previous frame reference of the returned frame is cleared, other frame properties
+  /// (type, dimensions, codec) are left unchanged and must be set by the caller.
+  vtkStreamingVolumeFrame* GetFrame(const unsigned char* bitstream, vtkIdType size);
+
+  /// Number of frames that have been allocated (largest number of frames in use at the same time)
+  int GetNumberOfFrames();
+
+  /// Get an image that is not in use, for decoding a frame into it.
+  /// The image keeps the scalars of its previous use, so the codec does not reallocate them
+  /// if the image size does not change.
+  vtkImageData* GetImage();
+
+  /// Number of images that have been allocated (largest number of images in use at the same time)
+  int GetNumberOfImages();
+
+  /// Number of frames, frame buffers, and images that have been allocated by the pool.
+  /// Does not change once the stream reached a steady state.
+  vtkGetMacro(NumberOfAllocations, int);
+
+  /// Size of the largest frame received
+  vtkGetMacro(BufferSizeHighWaterMark, vtkIdType);
+
+protected:
+  vtkIGTLVideoFramePool();
+  ~vtkIGTLVideoFramePool();
+
+  struct PooledFrame
+  {
+    vtkSmartPointer<vtkStreamingVolumeFrame> Frame;
+    vtkSmartPointer<vtkUnsignedCharArray> FrameData;
+    /// Memory of FrameData. The array does not own it, so it can be reused without reallocation.
+    std::vector<unsigned char> Buffer;
+  };
+
+  bool IsInUse(const PooledFrame& pooledFrame);
+
+  std::vector<PooledFrame> Frames;
+  std::vector<vtkSmartPointer<vtkImageData> > Images;
+  vtkIdType BufferSizeHighWaterMark;
+  int NumberOfAllocations;
+
+private:
+  vtkIGTLVideoFramePool(const vtkIGTLVideoFramePool&);
+  void operator=(const vtkIGTLVideoFramePool&);
+};
+
+#endif
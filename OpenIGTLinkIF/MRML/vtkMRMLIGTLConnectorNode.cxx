@@ -33,6 +33,8 @@ Version:   $Revision: 1.2 $
 #endif
 
 // OpenIGTLinkIF MRML includes
+#include "vtkIGTLSPSCRingBuffer.h"
+#include "vtkIGTLVideoFramePool.h"
 #include "vtkMRMLIGTLConnectorNode.h"
 #include "vtkMRMLIGTLStatusNode.h"
 #include "vtkMRMLImageMetaListNode.h"
@@ -49,16 +51,24 @@ Version:   $Revision: 1.2 $
 #include <vtkMRMLModelNode.h>
 #include <vtkMRMLScalarVolumeDisplayNode.h>
 #include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLSliceCompositeNode.h>
 #include <vtkMRMLStreamingVolumeNode.h>
 #include <vtkMRMLVectorVolumeDisplayNode.h>
 #include <vtkMRMLVectorVolumeNode.h>
 #include <vtkMRMLVolumeNode.h>
 
+// vtkAddon includes
+#include <vtkStreamingVolumeCodec.h>
+#include <vtkStreamingVolumeCodecFactory.h>
+
 // VTK includes
+#include <vtkAbstractTransform.h>
+#include <vtkCallbackCommand.h>
 #include <vtkCollection.h>
 #include <vtkImageData.h>
 #include <vtkMatrix3x3.h>
 #include <vtkMatrix4x4.h>
+#include <vtkPoints.h>
 #include <vtkPolyData.h>
 #include <vtkTimerLog.h>
 #include <vtkWeakPointer.h>
@@ -66,12 +76,30 @@ Version:   $Revision: 1.2 $
 // vtksys includes
 #include <vtksys/SystemTools.hxx>
 
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
 // SlicerQt includes
 #include <qSlicerApplication.h>
 #include <qSlicerLayoutManager.h>
 
 #define MRMLNodeNameKey "MRMLNodeName"
 #define OriginalNodeNameKey "OriginalNodeName"
+#define OutgoingNodeMaximumSendRateKey "OpenIGTLinkIF.out.maximumSendRate"
 
 // The macro SendMessage in winuser.h clashes with the method name in igtlioConnector.
 // A simple workaround is to undefine this macro to avoid name conflict (https://stackoverflow.com/a/69041270)
@@ -113,10 +141,185 @@ public:
 
   /// Find the first relevant query node for a given device in the list of pending queries
   vtkMRMLIGTLQueryNode* GetPendingQueryNodeForDevice(igtlioDevice* device);
+  /// Add the query node to the list of pending queries, replacing the previous entry of the same node
+  void AddPendingQueryNode(vtkMRMLIGTLQueryNode* queryNode);
   /// Remove the query node from the list of pending queries
   bool RemovePendingQueryNode(vtkMRMLIGTLQueryNode* queryNode);
   /// Remove queries that have timed out from the list of pending queries
   void RemoveExpiredQueries();
+  /// Removes the query of the node when its status is changed from waiting (for example, by the application
+  /// or by another connector) or when the node is deleted, so that queries without a timeout are not kept forever
+  static void OnPendingQueryNodeModified(vtkObject* caller, unsigned long event, void* clientData, void* callData);
+  /// Observes the pending query nodes
+  vtkSmartPointer<vtkCallbackCommand> PendingQueryNodeCallback;
+
+  /// Pending queries are indexed by (device type, device name) and by sequence number.
+  /// The sequence number of a query is the order it was pushed, so among the matching queries
+  /// the oldest one receives the response. Only accessed while holding the QueryQueueMutex of the connector node.
+  typedef std::pair<std::string, std::string> QueryKeyType;
+  struct QueryKeyHash
+  {
+    size_t operator()(const QueryKeyType& key) const
+    {
+      return std::hash<std::string>()(key.first) ^ (std::hash<std::string>()(key.second) * 31);
+    }
+  };
+  struct PendingQuery
+  {
+    /// Weak pointer, to detect if the query node has been deleted
+    vtkWeakPointer<vtkMRMLIGTLQueryNode> Node;
+    /// Device type and name, the name is empty if the query matches any device name
+    QueryKeyType Key;
+    /// Entry of the query in the deprecated QueryWaitingQueue of the connector node
+    vtkMRMLIGTLConnectorNode::QueryListType::iterator WaitingQueueIt;
+  };
+  /// Removes the query from all indices and stops observing the query node, the mutex must be locked
+  void RemovePendingQuery(unsigned long sequence);
+  std::unordered_map<unsigned long, PendingQuery> PendingQueries;
+  std::unordered_map<vtkMRMLIGTLQueryNode*, unsigned long> PendingQuerySequences;
+  std::unordered_map<QueryKeyType, std::map<unsigned long, vtkMRMLIGTLQueryNode*>, QueryKeyHash> PendingQueriesByKey;
+  /// (deadline, sequence) of queries that have a timeout, earliest deadline first.
+  /// Entries of queries that have been removed are skipped when they reach the top.
+  typedef std::pair<double, unsigned long> QueryDeadlineType;
+  std::priority_queue<QueryDeadlineType, std::vector<QueryDeadlineType>, std::greater<QueryDeadlineType> > QueryDeadlines;
+  unsigned long NextQuerySequence = 0;
+
+  /// Register handlers of the device types that are supported by default
+  void RegisterDefaultDeviceTypeHandlers();
+  /// Add or replace the handler of a device type. A replaced handler keeps its position in DeviceTypeRegistrationOrder.
+  void SetDeviceTypeHandler(const std::string& deviceType, const DeviceTypeHandler& handler);
+  void RemoveDeviceTypeHandler(const std::string& deviceType);
+  /// Get the handler of the device type. The handler is looked up only once for each device.
+  /// Returns nullptr if the device type is not supported.
+  const DeviceTypeHandler* GetDeviceTypeHandler(igtlioDevice* device);
+
+  /// Add incoming node to IncomingNodeIndex for all device types that can be stored in the node.
+  /// Nodes are indexed by their OriginalNodeName attribute, which is not changed when the node is renamed.
+  void AddIncomingNodeToIndex(vtkMRMLNode* node);
+  /// Recompute IncomingNodeIndex from IncomingMRMLNodeInfoMap
+  void RebuildIncomingNodeIndex();
+  /// Update the index if the OriginalNodeName attribute of an incoming node has changed since it was indexed.
+  /// Called when an incoming node is modified.
+  void UpdateIncomingNodeIndex(vtkMRMLNode* node);
+  /// Get the indexed node. Returns nullptr if the node is not found or no longer valid.
+  vtkMRMLNode* FindIndexedIncomingNode(const std::string& deviceType, const std::string& deviceName);
+
+  /// Received video frame that is decoded in the background decoding thread
+  struct FrameDecodeTask
+  {
+    std::string NodeID;
+    unsigned long Sequence = 0;
+    vtkSmartPointer<vtkStreamingVolumeFrame> Frame;
+    vtkSmartPointer<vtkMatrix4x4> IJKToRASMatrix;
+    /// If false then the frame is only decoded to update the reference frames of the decoder, without creating an image
+    bool DecodeImage = true;
+    /// Set by the decoding thread. If decoding failed or the image is not decoded then it is nullptr
+    /// and the volume node decodes the frame when needed.
+    vtkSmartPointer<vtkImageData> DecodedImage;
+  };
+
+  void StartDecodeThread();
+  /// Stops the thread. Frames that are still in the queues are not applied.
+  /// The codecs of the thread are kept, so that the main thread can continue decoding with them.
+  void StopDecodeThread();
+  void DecodeThreadFunction();
+  /// Decode the frame with the codec of the decoding thread for the node.
+  /// Called by the decoding thread, or by the main thread while the decoding thread is stopped.
+  void DecodeQueuedFrame(FrameDecodeTask& task);
+  /// Wake up the decoding thread after a frame has been queued or a decoded frame has been removed
+  void NotifyDecodeThread();
+  /// Pass the frame to the decoding thread. Returns false if the decoding queue is full.
+  bool QueueFrameDecode(FrameDecodeTask& task);
+  /// Apply the frames that the decoding thread has finished to the streaming volume nodes. Main thread only.
+  /// If deadline is set then frames are applied until the deadline, and the remaining frames in the next call.
+  void ApplyDecodedFrames(double deadline = 0.0);
+  /// Apply a frame from the decoding queues, unless the node has been removed or a more recent frame has already been set.
+  void ApplyQueuedFrame(FrameDecodeTask& task);
+  /// Set the frame (and decoded image) in the streaming volume node.
+  void ApplyFrame(vtkMRMLStreamingVolumeNode* streamingVolumeNode, FrameDecodeTask& task);
+  /// Returns true if the volume is shown in a slice view or by a display node other than the default volume display
+  /// (such as volume rendering). The result is cached until a slice composite node, a display node of the volume,
+  /// or the nodes of the scene change.
+  bool IsVolumeNodeDisplayed(vtkMRMLVolumeNode* volumeNode);
+  static bool ComputeVolumeNodeDisplayed(vtkMRMLVolumeNode* volumeNode);
+  /// Observe the scene and its slice composite nodes to invalidate the cached displayed states.
+  /// Observers of the previously observed scene are removed.
+  void ObserveDisplayedStateScene(vtkMRMLScene* scene);
+  /// Observe the node to invalidate the cached displayed states when it is modified, unless it is already observed
+  void ObserveDisplayedStateNode(vtkObject* node, unsigned long event);
+  void RemoveDisplayedStateObservers();
+  static void OnDisplayedStateModified(vtkObject* caller, unsigned long event, void* clientData, void* callData);
+  /// Keep decoding the cut frame chains with the decoder that has decoded their previous frames, until the next key frame.
+  /// Called when the decoding moves between the decoding thread and the volume nodes, as the new decoder has not
+  /// decoded the frames before the cut.
+  void KeepDecodersOfCutChains();
+
+  /// Record that the device content has been updated. Returns false if the device content
+  /// must be applied immediately (coalescing and processing time budget are disabled or not allowed for the device type).
+  bool CoalesceIncomingDevice(igtlioDevice* device);
+  /// Apply the latest content of each device that has been updated since the last call.
+  /// If deadline is set then devices are applied in the order of message type priority until the deadline,
+  /// and the remaining devices are applied in the next call.
+  void ApplyCoalescedDevices(double deadline = 0.0);
+
+  /// Set an image buffer from the pool of the device as target of the next received image.
+  /// The buffer is not used by the volume node, so it can be written while the node shows the previous image,
+  /// and then swapped into the volume node without copying.
+  void AssignIncomingImageBuffer(igtlioImageDevice* imageDevice);
+
+  /// Name of the node that is created for an incoming device
+  static std::string GetIncomingNodeName(igtlioDevice* device);
+
+  // Default node creation for incoming devices. The nodes are added to the scene, but not registered as incoming nodes.
+  static vtkMRMLNode* CreateIncomingImageNode(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device);
+#if defined(OpenIGTLink_ENABLE_VIDEOSTREAMING)
+  static vtkMRMLNode* CreateIncomingVideoNode(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device);
+#endif
+  static vtkMRMLNode* CreateIncomingStatusNode(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device);
+  static vtkMRMLNode* CreateIncomingTransformNode(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device);
+  static vtkMRMLNode* CreateIncomingPolyDataNode(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device);
+  static vtkMRMLNode* CreateIncomingStringNode(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device);
+  static vtkMRMLNode* CreateIncomingPointNode(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device);
+  static vtkMRMLNode* CreateIncomingImageMetaNode(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device);
+  static vtkMRMLNode* CreateIncomingLabelMetaNode(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device);
+  static vtkMRMLNode* CreateIncomingTrackingDataNode(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device);
+
+  // Default handlers for incoming devices
+  static void ApplyIncomingImage(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device, vtkMRMLNode* node);
+#if defined(OpenIGTLink_ENABLE_VIDEOSTREAMING)
+  static void ApplyIncomingVideo(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device, vtkMRMLNode* node);
+#endif
+  static void ApplyIncomingStatus(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device, vtkMRMLNode* node);
+  static void ApplyIncomingTransform(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device, vtkMRMLNode* node);
+  static void ApplyIncomingPolyData(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device, vtkMRMLNode* node);
+  static void ApplyIncomingString(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device, vtkMRMLNode* node);
+  static void ApplyIncomingPoint(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device, vtkMRMLNode* node);
+  static void ApplyIncomingImageMeta(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device, vtkMRMLNode* node);
+  static void ApplyIncomingLabelMeta(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device, vtkMRMLNode* node);
+  static void ApplyIncomingTrackingData(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device, vtkMRMLNode* node);
+
+  // Default handlers for outgoing devices
+  static unsigned int AssignOutgoingImage(vtkMRMLIGTLConnectorNode* self, vtkMRMLNode* node, igtlioDevice* device);
+#if defined(OpenIGTLink_ENABLE_VIDEOSTREAMING)
+  static unsigned int AssignOutgoingVideo(vtkMRMLIGTLConnectorNode* self, vtkMRMLNode* node, igtlioDevice* device);
+#endif
+  static unsigned int AssignOutgoingStatus(vtkMRMLIGTLConnectorNode* self, vtkMRMLNode* node, igtlioDevice* device);
+  static unsigned int AssignOutgoingTransform(vtkMRMLIGTLConnectorNode* self, vtkMRMLNode* node, igtlioDevice* device);
+  static unsigned int AssignOutgoingPolyData(vtkMRMLIGTLConnectorNode* self, vtkMRMLNode* node, igtlioDevice* device);
+  static unsigned int AssignOutgoingString(vtkMRMLIGTLConnectorNode* self, vtkMRMLNode* node, igtlioDevice* device);
+  static unsigned int AssignOutgoingPoint(vtkMRMLIGTLConnectorNode* self, vtkMRMLNode* node, igtlioDevice* device);
+  static unsigned int AssignOutgoingTrackingData(vtkMRMLIGTLConnectorNode* self, vtkMRMLNode* node, igtlioDevice* device);
+
+  // Default fingerprints of outgoing content
+  static vtkTypeUInt64 GetOutgoingImageFingerprint(vtkMRMLIGTLConnectorNode* self, vtkMRMLNode* node);
+  static vtkTypeUInt64 GetOutgoingTransformFingerprint(vtkMRMLIGTLConnectorNode* self, vtkMRMLNode* node);
+  static vtkTypeUInt64 GetOutgoingPolyDataFingerprint(vtkMRMLIGTLConnectorNode* self, vtkMRMLNode* node);
+  static vtkTypeUInt64 GetOutgoingStringFingerprint(vtkMRMLIGTLConnectorNode* self, vtkMRMLNode* node);
+  static vtkTypeUInt64 GetOutgoingPointFingerprint(vtkMRMLIGTLConnectorNode* self, vtkMRMLNode* node);
+  /// Add data to a 64-bit FNV-1a hash
+  static vtkTypeUInt64 HashBytes(vtkTypeUInt64 hash, const void* data, size_t size);
+  /// Add a string (including the terminating null) to the hash, so that consecutive strings cannot be confused
+  static vtkTypeUInt64 HashString(vtkTypeUInt64 hash, const char* text);
 
 public:
   vtkMRMLIGTLConnectorNode* External;
@@ -124,8 +327,34 @@ public:
 
   typedef std::map<std::string, igtlioConnector::NodeInfoType>   NodeInfoMapType;
   typedef std::map<std::string, vtkSmartPointer <igtlioDevice> > MessageDeviceMapType;
-  typedef std::map<std::string, std::vector<std::string> > DeviceTypeToNodeTagMapType;
-  typedef std::map<std::string, vtkSmartPointer<vtkStreamingVolumeFrame> > FrameMapType;
+  typedef std::map<std::string, DeviceTypeHandler> DeviceTypeHandlerMapType;
+  typedef std::unordered_map<igtlioDevice*, const DeviceTypeHandler*> DeviceTypeHandlerCacheType;
+  typedef std::unordered_map<std::string, vtkWeakPointer<vtkMRMLNode> > DeviceNameToNodeMapType;
+  typedef std::unordered_map<std::string, DeviceNameToNodeMapType> IncomingNodeIndexType;
+  /// Last received frame of a video device
+  struct PreviousFrameInfo
+  {
+    vtkSmartPointer<vtkStreamingVolumeFrame> Frame;
+    /// Number of frames and total bitstream size of the frames that are kept in memory by Frame
+    /// (Frame and the chain of previous frames that it references)
+    int ChainLength = 0;
+    vtkIdType ChainSize = 0;
+    /// True if the chain of Frame does not reach back to a key frame, because it has been cut at the chain limits.
+    /// Only the decoder that has decoded all previous frames can decode the following frames until the next key frame.
+    bool ChainCut = false;
+    /// ID of the streaming volume node that the frames are applied to
+    std::string NodeID;
+    /// True if Frame has not been passed to the decoding thread because its queue was full.
+    /// The next frame references Frame, so that the decoding thread decodes it before the next frame.
+    bool DecodingThreadMissedFrame = false;
+    /// Until the next key frame the frames of the cut chain are decoded by the decoder that has decoded the frames
+    /// before the cut: the codec of the volume node although background decoding is enabled, or the codec of the
+    /// stopped decoding thread on the main thread.
+    bool DecodeInVolumeNode = false;
+    bool DecodeOnMainThread = false;
+  };
+  typedef std::map<std::string, PreviousFrameInfo> FrameMapType;
+  typedef std::map<std::string, vtkSmartPointer<vtkIGTLVideoFramePool> > FramePoolMapType;
 
   // Calling StartModify() on incoming nodes when messages are received, and EndModify() once all incoming messages have been parsed is a neccesary step.
   // If a Modified() event is triggered on an incoming node while incoming messages are still being processed, it can trigger an early Render.
@@ -137,14 +366,250 @@ public:
   };
   std::deque<NodeModification> PendingNodeModifications;
 
-  typedef std::map<std::string, int> IncomingNodeClientIDMapType;
+  /// ID of the client that the node was last received from (-1 if the node has not been received since the last
+  /// PeriodicProcess() call). Stores the node as weak pointer, to detect if the node has been deleted and another
+  /// node has been allocated at the same address.
+  struct IncomingNodeClientID
+  {
+    vtkWeakPointer<vtkMRMLNode> Node;
+    int ClientID = -1;
+  };
+  typedef std::unordered_map<vtkMRMLNode*, IncomingNodeClientID> IncomingNodeClientIDMapType;
   IncomingNodeClientIDMapType IncomingNodeClientIDMap;
+  void SetIncomingNodeClientID(vtkMRMLNode* node, int clientID);
+  int GetIncomingNodeClientID(vtkMRMLNode* node);
+  /// Remove entries of deleted nodes
+  void RemoveDeletedIncomingNodeClientIDs();
+
+  /// Copy metadata of the device to "OpenIGTLink.<key>" attributes of the node. Unchanged attributes are not set.
+  void CopyMetaDataToNodeAttributes(igtlioDevice* device, vtkMRMLNode* node);
+  /// Buffer for composing attribute names, reused to avoid allocations for each message
+  std::string MetaDataAttributeName;
 
   NodeInfoMapType IncomingMRMLNodeInfoMap;
   MessageDeviceMapType  OutgoingMRMLIDToDeviceMap;
   MessageDeviceMapType  IncomingMRMLIDToDeviceMap;
-  DeviceTypeToNodeTagMapType DeviceTypeToNodeTagMap;
+  DeviceTypeHandlerMapType DeviceTypeHandlers;
+  /// Device types in the order they were registered.
+  /// If a node can be sent as multiple device types then they are preferred in this order.
+  std::vector<std::string> DeviceTypeRegistrationOrder;
+  DeviceTypeHandlerCacheType DeviceTypeHandlerCache;
+  IncomingNodeIndexType IncomingNodeIndex;
+  /// OriginalNodeName attribute value of each indexed node (by node ID) at the time it was indexed
+  std::unordered_map<std::string, std::string> IncomingNodeIndexedNames;
   FrameMapType          PreviousIncomingFramesMap;
+  FramePoolMapType      IncomingVideoFramePools;
+
+  bool UseBackgroundDecoding;
+  std::thread DecodeThread;
+  std::atomic<bool> DecodeThreadRunning;
+  std::mutex DecodeThreadWakeUpMutex;
+  std::condition_variable DecodeThreadWakeUp;
+  /// Frames waiting to be decoded (main thread -> decoding thread)
+  vtkIGTLSPSCRingBuffer<FrameDecodeTask> PendingFrameDecodes;
+  /// Decoded frames waiting to be applied (decoding thread -> main thread)
+  vtkIGTLSPSCRingBuffer<FrameDecodeTask> DecodedFrames;
+  /// Codecs used by the decoding thread, one for each streaming volume node.
+  /// Only accessed from the decoding thread, or from the main thread while the decoding thread is stopped.
+  std::map<std::string, vtkSmartPointer<vtkStreamingVolumeCodec> > DecodeThreadCodecs;
+  /// Pools of the decoded images, one for each streaming volume node. Accessed like DecodeThreadCodecs.
+  FramePoolMapType DecodeThreadImagePools;
+  /// Sequence number of the last frame that has been set in each streaming volume node
+  std::map<std::string, unsigned long> LastAppliedFrameSequence;
+  unsigned long NextFrameSequence;
+  /// Images of streaming volumes that are not displayed are not decoded in the decoding thread
+  bool LazyVideoDecoding;
+  /// Image that receives the decoding results of frames that are only decoded to update the reference frames.
+  /// Accessed like DecodeThreadCodecs.
+  vtkSmartPointer<vtkImageData> DecodeThreadReferenceImage;
+  /// Displayed state of streaming volume nodes (by node ID), cleared when the observed nodes are modified
+  std::unordered_map<std::string, bool> VolumeNodeDisplayedCache;
+  vtkSmartPointer<vtkCallbackCommand> DisplayedStateCallback;
+  vtkWeakPointer<vtkMRMLScene> DisplayedStateScene;
+  /// Slice composite nodes and volume nodes that are observed by DisplayedStateCallback.
+  /// Weak pointers detect if a node has been deleted and another node has been allocated at the same address.
+  std::unordered_map<vtkObject*, vtkWeakPointer<vtkObject> > DisplayedStateObservedNodes;
+
+  /// Notify the main thread that data is ready to be processed. Can be called from any thread.
+  void RequestProcessing();
+  std::mutex ProcessingRequestMutex;
+  vtkMRMLIGTLConnectorNode::ProcessingRequestCallbackType ProcessingRequestCallback;
+  void* ProcessingRequestClientData;
+
+  /// The receiving thread of OpenIGTLinkIO does not notify when messages are received, so the receive monitor thread
+  /// polls the receive buffers and the connection state instead of the main thread, and requests processing when
+  /// they have changed. It polls every 1ms while messages are arriving, every 5ms when idle, and every 100ms
+  /// when not connected. It runs while a processing request callback is set.
+  void StartReceiveMonitorThread();
+  void StopReceiveMonitorThread();
+  void ReceiveMonitorThreadFunction();
+  std::thread ReceiveMonitorThread;
+  std::atomic<bool> ReceiveMonitorThreadRunning;
+  std::mutex ReceiveMonitorMutex;
+  std::condition_variable ReceiveMonitorWakeUp;
+  /// Set when processing has been requested for received messages, cleared by PeriodicProcess()
+  std::atomic<bool> ReceivedMessagesProcessingRequested;
+
+  bool CoalesceIncomingMessages;
+  /// Devices that received messages in the current PeriodicProcess() call, in order of first message
+  std::vector<vtkSmartPointer<igtlioDevice> > CoalescedDevices;
+  std::unordered_set<igtlioDevice*> CoalescedDeviceSet;
+  typedef std::map<std::pair<std::string, std::string>, unsigned long> DroppedMessageCountMapType;
+  /// Number of messages that were replaced by a newer message before being applied, for each (device type, device name)
+  DroppedMessageCountMapType DroppedIncomingMessageCounts;
+  unsigned long NumberOfDroppedIncomingMessages;
+  /// Maximum time in seconds that PeriodicProcess() spends on processing received messages (0: no limit)
+  double ProcessingTimeBudget;
+  /// Priority of message types when the processing time is limited, devices with higher priority are applied first
+  std::map<std::string, int> IncomingMessagePriorities;
+
+  typedef std::vector<vtkSmartPointer<vtkImageData> > ImageBufferPoolType;
+  /// Recycled image buffers of incoming IMAGE devices
+  std::unordered_map<igtlioDevice*, ImageBufferPoolType> IncomingImageBufferPools;
+  int IncomingImageBufferPoolSize;
+  /// Limits of the chain of video frames that are kept in memory for each incoming VIDEO device (0 = no limit)
+  int MaximumVideoFrameChainLength;
+  vtkIdType MaximumVideoFrameChainSize;
+  /// Device events are ignored while the connector modifies the device content
+  bool IgnoreDeviceEvents;
+
+  /// Pack the device content into a message and send it to the client (or to all clients if clientID is -1).
+  /// Each call packs the message once.
+  int SendOutgoingMessage(const igtlioDeviceKeyType& key, igtlioDevice::MESSAGE_PREFIX prefix, int clientID = -1);
+  /// Pack the device content into a message once and send the same buffer to each of the clients.
+  /// Returns the number of clients that the message was sent to.
+  int SendOutgoingMessageToClients(igtlioDevice* device, igtlioDevice::MESSAGE_PREFIX prefix, const std::vector<int>& clientIDs);
+  /// Can be read from any thread while messages are sent
+  std::atomic<unsigned long> NumberOfPackedOutgoingMessages;
+
+  /// Packed message that is shared between the outgoing queues of all clients
+  typedef std::shared_ptr<const std::vector<unsigned char> > OutgoingMessageBufferPointer;
+  /// Message buffers that have been sent to all clients, reused for the next packed messages
+  /// so that large messages (such as images) do not allocate new memory for each push
+  struct OutgoingMessageBufferPool
+  {
+    std::mutex Mutex;
+    std::vector<std::unique_ptr<std::vector<unsigned char> > > Buffers;
+  };
+  /// Buffers may be released by the sending threads, after the pool has been deleted
+  std::shared_ptr<OutgoingMessageBufferPool> OutgoingMessageBuffers;
+  /// Copy the packed message into a buffer from the pool. The buffer returns to the pool when it is released by all queues.
+  OutgoingMessageBufferPointer GetOutgoingMessageBuffer(const unsigned char* data, size_t size);
+  /// Outgoing queue and sending thread of a client, so that a slow client blocks only its own sending thread
+  struct OutgoingClientQueue
+  {
+    std::deque<OutgoingMessageBufferPointer> Messages;
+    /// Total size of the queued messages in bytes
+    vtkIdType Size = 0;
+    std::thread SenderThread;
+    bool SenderThreadRunning = false;
+    /// Notifies the sending thread about new messages
+    std::condition_variable WakeUp;
+    /// Serializes writing to the socket of the client between the main thread and the sending thread
+    std::recursive_mutex SocketMutex;
+  };
+  /// Queues are only added and removed by the main thread
+  typedef std::map<int, std::unique_ptr<OutgoingClientQueue> > OutgoingQueueMapType;
+
+  /// Enable the sending threads, which are started when the first message is queued for a client
+  void StartSenderThreads();
+  /// Stop the sending threads of all clients. Queued messages are kept.
+  void StopSenderThreads();
+  void SenderThreadFunction(int clientID, OutgoingClientQueue* queue);
+  /// Lock the socket of the client (or of all clients if clientID is -1) against its sending thread
+  /// before writing to it from the main thread
+  std::vector<std::unique_lock<std::recursive_mutex> > LockClientSockets(int clientID);
+  /// Pack the device content once and add it to the outgoing queue of each client, except skippedClientID
+  void QueueOutgoingDevice(igtlioDevice* device, const std::vector<int>& clientIDs, int skippedClientID);
+  /// Add message to the outgoing queue of the client, applying the drop policy if the byte budget is exceeded
+  void QueueOutgoingMessage(int clientID, const OutgoingMessageBufferPointer& message);
+  /// Send all queued messages from the calling thread. Sending thread must not be running.
+  void FlushOutgoingQueues();
+  /// Remove queues of clients that are no longer connected
+  void RemoveDisconnectedOutgoingQueues();
+
+  bool UseAsynchronousSending;
+  vtkIdType OutgoingQueueByteBudget;
+  int OutgoingQueueDropPolicy;
+  std::atomic<bool> SenderThreadsEnabled;
+  /// Protects the content of OutgoingQueues and NumberOfDroppedOutgoingMessages.
+  /// It is not held while writing to a socket.
+  std::mutex OutgoingQueueMutex;
+  /// Notifies blocked producers that messages have been removed from the queues
+  std::condition_variable OutgoingQueueSpaceAvailable;
+  OutgoingQueueMapType OutgoingQueues;
+  unsigned long NumberOfDroppedOutgoingMessages;
+
+  /// Send time and pending modification of outgoing nodes that have a maximum send rate
+  struct OutgoingRateLimitState
+  {
+    double LastPushTime = 0.0;
+    bool PushPending = false;
+  };
+  typedef std::map<std::string, OutgoingRateLimitState> OutgoingRateLimitStateMapType;
+  OutgoingRateLimitStateMapType OutgoingRateLimitStates;
+  /// Outgoing POINT content of a markups node, updated incrementally from the modified control points
+  struct OutgoingPointCache
+  {
+    igtlioPointConverter::ContentData Content;
+    unsigned char SelectedColor[3] = { 0, 0, 0 };
+    unsigned char UnselectedColor[3] = { 0, 0, 0 };
+    /// Points that have been modified since the last update.
+    /// Added, removed, and reordered points are reported by point added and removed events, which set AllPointsModified.
+    std::vector<int> ModifiedPointIndices;
+    bool AllPointsModified = true;
+    /// Hash of the sent properties of each point and their sum, updated from the modified points
+    /// that have not been hashed yet (the first NumberOfHashedModifiedPoints of ModifiedPointIndices are up to date).
+    std::vector<vtkTypeUInt64> PointHashes;
+    vtkTypeUInt64 PointsHash = 0;
+    size_t NumberOfHashedModifiedPoints = 0;
+    bool AllPointHashesModified = true;
+    void UpdatePointElement(vtkMRMLMarkupsNode* markupsNode, int controlPointIndex);
+    void UpdatePointHash(vtkMRMLMarkupsNode* markupsNode, int controlPointIndex);
+  };
+  typedef std::map<std::string, OutgoingPointCache> OutgoingPointCacheMapType;
+  OutgoingPointCacheMapType OutgoingPointCaches;
+
+  /// Outgoing TDATA content of a tracking data bundle node, updated from the modified transforms
+  struct OutgoingTrackingDataCache
+  {
+    igtlioTrackingDataConverter::ContentData Content;
+    /// Index of the element of each transform name
+    std::map<std::string, int> ElementIndices;
+    struct TransformState
+    {
+      vtkWeakPointer<vtkMRMLLinearTransformNode> Node;
+      /// Name of the element, to detect renamed transforms
+      std::string Name;
+      /// Matrix of the element, updated in place
+      vtkSmartPointer<vtkMatrix4x4> Matrix;
+      vtkMTimeType ModifiedTime = 0;
+    };
+    std::unordered_map<vtkMRMLLinearTransformNode*, TransformState> TransformStates;
+    /// Transform nodes of the bundle, reused for each update
+    std::vector<vtkMRMLLinearTransformNode*> TransformNodes;
+    /// Remove the element of a transform that has been removed from the bundle or renamed
+    void RemoveElement(const std::string& name);
+  };
+  typedef std::map<std::string, OutgoingTrackingDataCache> OutgoingTrackingDataCacheMapType;
+  OutgoingTrackingDataCacheMapType OutgoingTrackingDataCaches;
+
+  /// Fingerprint of the last pushed content of an outgoing node and the clients that it has been sent to
+  struct OutgoingContentState
+  {
+    vtkTypeUInt64 Fingerprint = 0;
+    std::set<int> ClientIDs;
+  };
+  typedef std::map<std::string, OutgoingContentState> OutgoingContentStateMapType;
+  OutgoingContentStateMapType OutgoingContentStates;
+
+  /// Record which part of an outgoing node has been modified, so that only that part is updated in the next push
+  void RecordOutgoingNodeModification(vtkMRMLNode* node, unsigned long event, void* callData);
+
+  /// Push the modified outgoing node, or defer the push if the node was pushed recently
+  void PushModifiedOutgoingNode(vtkMRMLNode* node);
+  /// Push the latest state of deferred outgoing nodes whose send interval has elapsed
+  void PushPendingRateLimitedNodes();
 };
 
 //----------------------------------------------------------------------------
@@ -153,958 +618,2688 @@ public:
 //---------------------------------------------------------------------------
 vtkMRMLIGTLConnectorNode::vtkInternal::vtkInternal(vtkMRMLIGTLConnectorNode* external)
   : External(external)
+  , UseBackgroundDecoding(false)
+  , DecodeThreadRunning(false)
+  , PendingFrameDecodes(16)
+  , DecodedFrames(16)
+  , NextFrameSequence(0)
+  , LazyVideoDecoding(true)
+  , ProcessingRequestCallback(nullptr)
+  , ProcessingRequestClientData(nullptr)
+  , ReceiveMonitorThreadRunning(false)
+  , ReceivedMessagesProcessingRequested(false)
+  , CoalesceIncomingMessages(false)
+  , NumberOfDroppedIncomingMessages(0)
+  , ProcessingTimeBudget(0.0)
+  , IncomingImageBufferPoolSize(3)
+  , MaximumVideoFrameChainLength(0)
+  , MaximumVideoFrameChainSize(0)
+  , IgnoreDeviceEvents(false)
+  , NumberOfPackedOutgoingMessages(0)
+  , UseAsynchronousSending(false)
+  , OutgoingQueueByteBudget(64 * 1024 * 1024)
+  , OutgoingQueueDropPolicy(vtkMRMLIGTLConnectorNode::OutgoingQueueDropOldest)
+  , SenderThreadsEnabled(false)
+  , OutgoingMessageBuffers(std::make_shared<OutgoingMessageBufferPool>())
+  , NumberOfDroppedOutgoingMessages(0)
 {
   this->IOConnector = igtlioConnector::New();
+
+  this->DisplayedStateCallback = vtkSmartPointer<vtkCallbackCommand>::New();
+  this->DisplayedStateCallback->SetCallback(&vtkInternal::OnDisplayedStateModified);
+  this->DisplayedStateCallback->SetClientData(this);
+
+  this->PendingQueryNodeCallback = vtkSmartPointer<vtkCallbackCommand>::New();
+  this->PendingQueryNodeCallback->SetCallback(&vtkInternal::OnPendingQueryNodeModified);
+  this->PendingQueryNodeCallback->SetClientData(this);
+
+  // Tracking stays responsive while large messages are received
+  const char* trackingDeviceTypes[] = { "TRANSFORM", "POSITION", "TDATA", "QTDATA" };
+  for (const char* deviceType : trackingDeviceTypes)
+  {
+    this->IncomingMessagePriorities[deviceType] = 1;
+  }
+  const char* bulkDeviceTypes[] = { "IMAGE", "POLYDATA", "VIDEO" };
+  for (const char* deviceType : bulkDeviceTypes)
+  {
+    this->IncomingMessagePriorities[deviceType] = -1;
+  }
 }
 
 
 //---------------------------------------------------------------------------
 vtkMRMLIGTLConnectorNode::vtkInternal::~vtkInternal()
 {
+  this->StopReceiveMonitorThread();
+  this->StopDecodeThread();
+  this->StopSenderThreads();
+  this->RemoveDisplayedStateObservers();
+  for (auto& pendingQuery : this->PendingQueries)
+  {
+    if (pendingQuery.second.Node)
+    {
+      pendingQuery.second.Node->RemoveObserver(this->PendingQueryNodeCallback);
+    }
+  }
   this->IOConnector->Delete();
 }
 
 //----------------------------------------------------------------------------
-unsigned int vtkMRMLIGTLConnectorNode::AssignOutGoingNodeToDevice(vtkMRMLNode* node, igtlioDevicePointer device)
+void vtkMRMLIGTLConnectorNode::vtkInternal::StartDecodeThread()
 {
-  this->Internal->OutgoingMRMLIDToDeviceMap[node->GetID()] = device;
-  unsigned int modifiedEvent = 0;
-  if (device->GetDeviceType().compare("IMAGE") == 0)
-  {
-    igtlioImageDevice* imageDevice = static_cast<igtlioImageDevice*>(device.GetPointer());
-    vtkMRMLVolumeNode* imageNode = vtkMRMLVolumeNode::SafeDownCast(node);
-    vtkSmartPointer<vtkMatrix4x4> mat = vtkSmartPointer<vtkMatrix4x4>::New();
-    imageNode->GetIJKToRASMatrix(mat);
-    igtlioImageConverter::ContentData content = { imageNode->GetImageData(), mat };
-    imageDevice->SetContent(content);
-    modifiedEvent = vtkMRMLVolumeNode::ImageDataModifiedEvent;
-  }
-  else if (device->GetDeviceType().compare("STATUS") == 0)
-  {
-    igtlioStatusDevice* statusDevice = static_cast<igtlioStatusDevice*>(device.GetPointer());
-
-    vtkMRMLIGTLStatusNode* statusNode = vtkMRMLIGTLStatusNode::SafeDownCast(node);
-    igtlioStatusConverter::ContentData content = { static_cast<int>(statusNode->GetCode()), static_cast<int>(statusNode->GetSubCode()), statusNode->GetErrorName(), statusNode->GetStatusString() };
-    statusDevice->SetContent(content);
-    modifiedEvent = vtkMRMLIGTLStatusNode::StatusModifiedEvent;
-  }
-  else if (device->GetDeviceType().compare("TRANSFORM") == 0)
-  {
-    igtlioTransformDevice* transformDevice = static_cast<igtlioTransformDevice*>(device.GetPointer());
-    vtkSmartPointer<vtkMatrix4x4> mat = vtkSmartPointer<vtkMatrix4x4>::New();
-    vtkMRMLTransformNode* transformNode = vtkMRMLTransformNode::SafeDownCast(node);
-    transformNode->GetMatrixTransformToParent(mat);
-    igtlioTransformConverter::ContentData content = { mat, transformNode->GetName(), "", "" };
-    transformDevice->SetContent(content);
-    modifiedEvent = vtkMRMLTransformNode::TransformModifiedEvent;
-  }
-  else if (device->GetDeviceType().compare("POLYDATA") == 0)
-  {
-    igtlioPolyDataDevice* polyDevice = static_cast<igtlioPolyDataDevice*>(device.GetPointer());
-    vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(node);
-    igtlioPolyDataConverter::ContentData content = { modelNode->GetPolyData(), modelNode->GetName() };
-    polyDevice->SetContent(content);
-    modifiedEvent = vtkMRMLModelNode::MeshModifiedEvent;
-  }
-  else if (device->GetDeviceType().compare("STRING") == 0)
-  {
-    igtlioStringDevice* stringDevice = static_cast<igtlioStringDevice*>(device.GetPointer());
-    vtkMRMLTextNode* textNode = vtkMRMLTextNode::SafeDownCast(node);
-    std::string text = textNode->GetText();
-    igtlioStringConverter::ContentData content = { static_cast<unsigned int>(textNode->GetEncoding()), text };
-    stringDevice->SetContent(content);
-    modifiedEvent = vtkMRMLTextNode::TextModifiedEvent;
-  }
-  else if (device->GetDeviceType().compare("POINT") == 0)
-  {
-    igtlioPointDevice* pointDevice = static_cast<igtlioPointDevice*>(device.GetPointer());
-    vtkMRMLMarkupsFiducialNode* markupsNode = vtkMRMLMarkupsFiducialNode::SafeDownCast(node);
-    igtlioPointConverter::ContentData content;
-    vtkMRMLMarkupsDisplayNode* displayNode = vtkMRMLMarkupsDisplayNode::SafeDownCast(markupsNode->GetDisplayNode());
-    for (int controlPointIndex = 0; controlPointIndex < markupsNode->GetNumberOfControlPoints(); controlPointIndex++)
-    {
-      igtlioPointConverter::PointElement point;
-      point.Name = markupsNode->GetNthControlPointLabel(controlPointIndex);
-
-      bool pointSelected = markupsNode->GetNthControlPointSelected(controlPointIndex);
-      point.GroupName = (pointSelected ? "Selected" : "Unselected");
-      if (displayNode)
-      {
-        double* color = (pointSelected ? displayNode->GetSelectedColor() : displayNode->GetColor());
-        point.RGBA[0] = int(color[0] * 255);
-        point.RGBA[1] = int(color[1] * 255);
-        point.RGBA[2] = int(color[2] * 255);
-      }
-      else
-      {
-        // No display node, use default generic display colors
-        if (pointSelected)
-        {
-          // red
-          point.RGBA[0] = 255;
-          point.RGBA[1] = 0;
-          point.RGBA[2] = 0;
-        }
-        else
-        {
-          // yellow
-          point.RGBA[0] = 230;
-          point.RGBA[1] = 230;
-          point.RGBA[2] = 77;
-        }
-      }
-      point.RGBA[3] = markupsNode->GetNthControlPointVisibility(controlPointIndex) ? 255 : 0;
+  if (this->DecodeThread.joinable())
+  {
+    return;
+  }
+  this->DecodeThreadRunning = true;
+  this->DecodeThread = std::thread(&vtkInternal::DecodeThreadFunction, this);
+}
 
-      double position[3] = { 0.0 };
-      markupsNode->GetNthControlPointPosition(controlPointIndex, position);
-      point.Position[0] = position[0];
-      point.Position[1] = position[1];
-      point.Position[2] = position[2];
-      point.Radius = 0.0; // TODO: ream from measurement array
-      // point.Owner; TODO: set device name of the ower image
-      content.PointElements.push_back(point);
-    }
-    pointDevice->SetContent(content);
-    modifiedEvent = vtkMRMLMarkupsNode::PointModifiedEvent;
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::StopDecodeThread()
+{
+  if (!this->DecodeThread.joinable())
+  {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(this->DecodeThreadWakeUpMutex);
+    this->DecodeThreadRunning = false;
   }
-  else if (device->GetDeviceType().compare("TDATA") == 0)
+  this->DecodeThreadWakeUp.notify_all();
+  this->DecodeThread.join();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::DecodeThreadFunction()
+{
+  while (this->DecodeThreadRunning)
   {
-    igtlioTrackingDataDevice* tdataDevice = static_cast<igtlioTrackingDataDevice*>(device.GetPointer());
-    igtlioTrackingDataConverter::ContentData content = tdataDevice->GetContent();
-    vtkMRMLIGTLTrackingDataBundleNode* tBundleNode = vtkMRMLIGTLTrackingDataBundleNode::SafeDownCast(node);
-    if (tBundleNode)
+    FrameDecodeTask task;
+    if (!this->PendingFrameDecodes.Pop(task))
     {
-      int nElements = tBundleNode->GetNumberOfTransformNodes();
-      for (int i = 0; i < nElements; i++)
+      // Woken up by QueueFrameDecode
+      std::unique_lock<std::mutex> lock(this->DecodeThreadWakeUpMutex);
+      this->DecodeThreadWakeUp.wait(lock, [this]
       {
-        vtkMRMLLinearTransformNode* transformNode = tBundleNode->GetTransformNode(i);
-        vtkSmartPointer<vtkMatrix4x4> mat = vtkSmartPointer<vtkMatrix4x4>::New();
-        transformNode->GetMatrixTransformToParent(mat);
-        bool found(false);
-        for (auto iter = content.trackingDataElements.begin(); iter != content.trackingDataElements.end(); ++iter)
-        {
-          if (iter->second.deviceName.compare(transformNode->GetName()) == 0)
-          {
-            // already exists, update transform
-            found = true;
-            iter->second.transform = mat;
-            break;
-          }
-        }
-        if (!found)
-        {
-          content.trackingDataElements[static_cast<int>(content.trackingDataElements.size())] = igtlioTrackingDataConverter::ContentEntry(mat, transformNode->GetName(), transformNode->GetName());
-        }
-      }
+        return !this->DecodeThreadRunning || this->PendingFrameDecodes.GetSize() > 0;
+      });
+      continue;
+    }
+
+    this->DecodeQueuedFrame(task);
+
+    // Wait for the main thread to make room for the result, it wakes this thread up in ApplyDecodedFrames
+    {
+      std::unique_lock<std::mutex> lock(this->DecodeThreadWakeUpMutex);
+      this->DecodeThreadWakeUp.wait(lock, [this, &task]
+      {
+        return !this->DecodeThreadRunning || this->DecodedFrames.Push(std::move(task));
+      });
     }
+    this->RequestProcessing();
+  }
+}
 
-    tdataDevice->SetContent(content);
-    modifiedEvent = vtkCommand::ModifiedEvent;
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::DecodeQueuedFrame(FrameDecodeTask& task)
+{
+  std::string codecFourCC = task.Frame->GetCodecFourCC();
+  vtkSmartPointer<vtkStreamingVolumeCodec>& codec = this->DecodeThreadCodecs[task.NodeID];
+  if (!codec || codec->GetFourCC() != codecFourCC)
+  {
+    codec = vtkSmartPointer<vtkStreamingVolumeCodec>::Take(
+      vtkStreamingVolumeCodecFactory::GetInstance()->CreateCodecByFourCC(codecFourCC));
   }
-  else if (device->GetDeviceType().compare("COMMAND") == 0)
+  if (codec && task.DecodeImage)
   {
-    return 0;
-    // Process the modified event from command device.
+    // Images are recycled once the volume node has released them, so decoding does not allocate memory
+    vtkSmartPointer<vtkIGTLVideoFramePool>& imagePool = this->DecodeThreadImagePools[task.NodeID];
+    if (!imagePool)
+    {
+      imagePool = vtkSmartPointer<vtkIGTLVideoFramePool>::New();
+    }
+    vtkImageData* decodedImage = imagePool->GetImage();
+    if (codec->DecodeFrame(task.Frame, decodedImage))
+    {
+      task.DecodedImage = decodedImage;
+    }
   }
-#if defined(OpenIGTLink_ENABLE_VIDEOSTREAMING)
-  else if (device->GetDeviceType().compare("VIDEO") == 0)
-  {
-    igtlioVideoDevice* videoDevice = static_cast<igtlioVideoDevice*>(device.GetPointer());
-    vtkMRMLStreamingVolumeNode* streamingVolumeNode = vtkMRMLStreamingVolumeNode::SafeDownCast(node);
-    igtlioVideoConverter::ContentData content;
-    content.image = streamingVolumeNode->GetImageData();
-    content.frameType = FrameTypeUnKnown;
-    strncpy(content.codecName, videoDevice->GetCurrentCodecType().c_str(), IGTL_VIDEO_CODEC_NAME_SIZE);
-    content.keyFrameMessage = NULL;
-    content.keyFrameUpdated = false;
-    content.videoMessage = NULL;
-    videoDevice->SetContent(content);
-    modifiedEvent = vtkCommand::ModifiedEvent;
+  else if (codec)
+  {
+    // The image is not needed, the frame is decoded so that the following frames can be decoded
+    if (!this->DecodeThreadReferenceImage)
+    {
+      this->DecodeThreadReferenceImage = vtkSmartPointer<vtkImageData>::New();
+    }
+    codec->DecodeFrame(task.Frame, this->DecodeThreadReferenceImage, false);
   }
-#endif
-  return modifiedEvent;
 }
 
 //----------------------------------------------------------------------------
-void vtkMRMLIGTLConnectorNode::vtkInternal::ProcessNewDeviceEvent(
-  vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(event), void* vtkNotUsed(callData))
+void vtkMRMLIGTLConnectorNode::vtkInternal::RequestProcessing()
 {
+  std::lock_guard<std::mutex> lock(this->ProcessingRequestMutex);
+  if (this->ProcessingRequestCallback)
+  {
+    this->ProcessingRequestCallback(this->ProcessingRequestClientData);
+  }
 }
 
 //----------------------------------------------------------------------------
-void vtkMRMLIGTLConnectorNode::vtkInternal::ProcessOutgoingDeviceModifiedEvent(
-  vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(event), igtlioDevice* modifiedDevice)
+void vtkMRMLIGTLConnectorNode::vtkInternal::StartReceiveMonitorThread()
 {
-  this->IOConnector->SendMessage(igtlioDeviceKeyType::CreateDeviceKey(modifiedDevice), modifiedDevice->MESSAGE_PREFIX_NOT_DEFINED);
+  if (this->ReceiveMonitorThread.joinable())
+  {
+    return;
+  }
+  this->ReceiveMonitorThreadRunning = true;
+  this->ReceiveMonitorThread = std::thread(&vtkInternal::ReceiveMonitorThreadFunction, this);
 }
 
 //----------------------------------------------------------------------------
-void vtkMRMLIGTLConnectorNode::ProcessIncomingDeviceModifiedEvent(
-  vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(event), igtlioDevice* modifiedDevice)
+void vtkMRMLIGTLConnectorNode::vtkInternal::StopReceiveMonitorThread()
 {
-  vtkMRMLNode* modifiedNode = this->GetMRMLNodeForDevice(modifiedDevice);
-  bool isNewNodeCreated = false;
-  if (!modifiedNode)
-  {
-    // Could not find node, create new node
-    modifiedNode = this->CreateNewMRMLNodeForDevice(modifiedDevice);
-    // new node created, notify other class about the creation of new node at the end of this function when all content are assigned to the new node.
-    isNewNodeCreated = true;
-  }
-  if (!modifiedNode)
+  if (!this->ReceiveMonitorThread.joinable())
   {
-    // Could not add node.
     return;
   }
-
-  int wasModifyingNode = modifiedNode->StartModify();
-
-  const std::string deviceType = modifiedDevice->GetDeviceType();
-  std::string deviceName = modifiedDevice->GetDeviceName();
-  if (deviceName.empty())
   {
-    deviceName = "OpenIGTLink";
+    std::lock_guard<std::mutex> lock(this->ReceiveMonitorMutex);
+    this->ReceiveMonitorThreadRunning = false;
   }
-  if (this->GetNodeTagFromDeviceType(deviceType.c_str()).size() > 0)
-  {
-    if (strcmp(deviceType.c_str(), "IMAGE") == 0)
-    {
-      igtlioImageDevice* imageDevice = reinterpret_cast<igtlioImageDevice*>(modifiedDevice);
-      vtkMRMLVolumeNode* volumeNode = vtkMRMLVolumeNode::SafeDownCast(modifiedNode);
-      if (volumeNode)
-      {
-        volumeNode->SetIJKToRASMatrix(imageDevice->GetContent().transform);
-        volumeNode->SetAndObserveImageData(imageDevice->GetContent().image);
-        volumeNode->GetImageData()->SetSpacing(1.0, 1.0, 1.0); // IGTL device sets spacing in image data, do not duplicate with IJKtoRAS spacing
-        volumeNode->GetImageData()->SetOrigin(0.0, 0.0, 0.0); // IGTL device sets origin in image data, do not duplicate with IJKtoRAS origin
-#if VTK_MAJOR_VERSION >= 9
-        vtkSmartPointer<vtkMatrix3x3> mat = vtkSmartPointer<vtkMatrix3x3>::New();
-        mat->Identity();
-        volumeNode->GetImageData()->SetDirectionMatrix(mat); // IGTL device sets directions in image data, do not duplicate with IJKtoRAS directions
-#endif
-        volumeNode->Modified();
-      }
-    }
-#if defined(OpenIGTLink_ENABLE_VIDEOSTREAMING)
-    else if (strcmp(deviceType.c_str(), "VIDEO") == 0)
-    {
-      igtlioVideoDevice* videoDevice = reinterpret_cast<igtlioVideoDevice*>(modifiedDevice);
-      vtkSmartPointer<vtkUnsignedCharArray> frameData = vtkSmartPointer<vtkUnsignedCharArray>::New();
-      frameData->Allocate(videoDevice->GetContent().videoMessage->GetBitStreamSize());
-      memcpy(frameData->GetPointer(0), videoDevice->GetContent().frameData->GetPointer(0), videoDevice->GetContent().videoMessage->GetBitStreamSize());
-
-      std::string codecName = videoDevice->GetCurrentCodecType().substr(0, 4);
-      vtkSmartPointer<vtkStreamingVolumeFrame> frame = vtkSmartPointer<vtkStreamingVolumeFrame>::New();
-      frame->SetFrameData(frameData);
-      frame->SetFrameType(videoDevice->GetContent().frameType == igtl::FrameTypeKey ? vtkStreamingVolumeFrame::IFrame : vtkStreamingVolumeFrame::PFrame);
-      videoDevice->GetContent().videoMessage->Unpack(false);
-      frame->SetDimensions(videoDevice->GetContent().videoMessage->GetWidth(),
-        videoDevice->GetContent().videoMessage->GetHeight(),
-        videoDevice->GetContent().videoMessage->GetAdditionalZDimension());
-      frame->SetNumberOfComponents(videoDevice->GetContent().grayscale ? 1 : 3);
-      frame->SetCodecFourCC(codecName);
-      if (!frame->IsKeyFrame() && this->Internal->PreviousIncomingFramesMap.find(videoDevice->GetDeviceName()) != this->Internal->PreviousIncomingFramesMap.end())
-      {
-        // If the current frame is not a keyframe, then it should maintain a reference to the previously received frame
-        // so that the current frame can be decoded
-        frame->SetPreviousFrame(this->Internal->PreviousIncomingFramesMap[videoDevice->GetDeviceName()]);
-      }
-      this->Internal->PreviousIncomingFramesMap[videoDevice->GetDeviceName()] = frame;
-
-      vtkMRMLStreamingVolumeNode* streamingVolumeNode = vtkMRMLStreamingVolumeNode::SafeDownCast(modifiedNode);
-      streamingVolumeNode->SetIJKToRASMatrix(videoDevice->GetContent().transform);
-      streamingVolumeNode->SetAndObserveFrame(frame);
-    }
-#endif
-    else if (strcmp(deviceType.c_str(), "STATUS") == 0)
-    {
-      igtlioStatusDevice* statusDevice = reinterpret_cast<igtlioStatusDevice*>(modifiedDevice);
-      vtkMRMLIGTLStatusNode* statusNode = vtkMRMLIGTLStatusNode::SafeDownCast(modifiedNode);
-      statusNode->SetStatus(statusDevice->GetContent().code, statusDevice->GetContent().subcode, statusDevice->GetContent().errorname.c_str(), statusDevice->GetContent().statusstring.c_str());
-      statusNode->Modified();
-    }
-    else if (strcmp(deviceType.c_str(), "TRANSFORM") == 0)
-    {
-      igtlioTransformDevice* transformDevice = reinterpret_cast<igtlioTransformDevice*>(modifiedDevice);
-      vtkMRMLTransformNode* transformNode = vtkMRMLTransformNode::SafeDownCast(modifiedNode);
-      vtkSmartPointer<vtkMatrix4x4> transfromMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
-      transfromMatrix->DeepCopy(transformDevice->GetContent().transform);
-      transformNode->SetMatrixTransformToParent(transfromMatrix.GetPointer());
-      transformNode->Modified();
+  this->ReceiveMonitorWakeUp.notify_all();
+  this->ReceiveMonitorThread.join();
+}
 
-      // Copy transform status from metadata to node attributes
-      for (igtl::MessageBase::MetaDataMap::const_iterator iter = modifiedDevice->GetMetaData().begin(); iter != modifiedDevice->GetMetaData().end(); ++iter)
-      {
-        if (iter->first.find("Status") != std::string::npos)
-        {
-          transformNode->SetAttribute(iter->first.c_str(), iter->second.second.c_str());
-        }
-      }
-    }
-    else if (strcmp(deviceType.c_str(), "POLYDATA") == 0)
-    {
-      igtlioPolyDataDevice* polyDevice = reinterpret_cast<igtlioPolyDataDevice*>(modifiedDevice);
-      vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(modifiedNode);
-      modelNode->SetAndObservePolyData(polyDevice->GetContent().polydata);
-      modelNode->Modified();
-    }
-    else if (strcmp(deviceType.c_str(), "STRING") == 0)
-    {
-      igtlioStringDevice* stringDevice = reinterpret_cast<igtlioStringDevice*>(modifiedDevice);
-      vtkMRMLTextNode* textNode = vtkMRMLTextNode::SafeDownCast(modifiedNode);
-      textNode->SetEncoding(stringDevice->GetContent().encoding);
-      textNode->SetText(stringDevice->GetContent().string_msg.c_str());
-      textNode->Modified();
-    }
-    else if (strcmp(deviceType.c_str(), "POINT") == 0)
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::ReceiveMonitorThreadFunction()
+{
+  // This thread polls the buffers and the state instead of the main thread. Checking the buffers only takes
+  // the mutex of the buffer list of OpenIGTLinkIO, so polling here does not block the main thread.
+  // The interval is short while messages are arriving, and backs off when the connector is idle or not connected.
+  const std::chrono::milliseconds activeCheckInterval(1);
+  const std::chrono::milliseconds idleCheckInterval(5);
+  const std::chrono::milliseconds disconnectedCheckInterval(100);
+  const std::chrono::milliseconds activityTimeout(100);
+  std::chrono::steady_clock::time_point lastActivityTime;
+  int lastState = -1;
+  igtlioConnector::NameListType updatedBufferNames;
+  std::unique_lock<std::mutex> lock(this->ReceiveMonitorMutex);
+  while (this->ReceiveMonitorThreadRunning)
+  {
+    std::chrono::milliseconds checkInterval = disconnectedCheckInterval;
+    if (lastState == igtlioConnector::STATE_CONNECTED)
     {
-      igtlioPointDevice* pointDevice = reinterpret_cast<igtlioPointDevice*>(modifiedDevice);
-      double selectedColor[3] = { 1.0, 1.0, 1.0 };
-      double unselectedColor[3] = { 1.0, 1.0, 1.0 };
-      bool selectedColorDefined = false;
-      bool unselectedColorDefined = false;
-      vtkMRMLMarkupsFiducialNode* markupsNode = vtkMRMLMarkupsFiducialNode::SafeDownCast(modifiedNode);
-      MRMLNodeModifyBlocker blocker(markupsNode);
-
-      const igtlioPointConverter::PointList& points = pointDevice->GetContent().PointElements;
-      // Remove unneeded existing points
-      int numberOfPointsToRemove = markupsNode->GetNumberOfControlPoints() - points.size();
-      for (int i = 0; i < numberOfPointsToRemove; i++)
-      {
-        markupsNode->RemoveNthControlPoint(markupsNode->GetNumberOfControlPoints() - 1);
-      }
-      // Add/update other control points
-      for (int controlPointIndex = 0; controlPointIndex < points.size(); controlPointIndex++)
-      {
-        const igtlioPointConverter::PointElement& point = points[controlPointIndex];
-        bool selected = (point.GroupName != "Unselected");
-
-        // Use the first encountered selected/unselected color and opacity for all points
-        if (selected && !selectedColorDefined)
-        {
-          selectedColor[0] = point.RGBA[0] / 255.0;
-          selectedColor[1] = point.RGBA[1] / 255.0;
-          selectedColor[2] = point.RGBA[2] / 255.0;
-          selectedColorDefined = true;
-        }
-        else if (!selected && !unselectedColorDefined)
-        {
-          unselectedColor[0] = point.RGBA[0] / 255.0;
-          unselectedColor[1] = point.RGBA[1] / 255.0;
-          unselectedColor[2] = point.RGBA[2] / 255.0;
-          unselectedColorDefined = true;
-        }
-
-        if (markupsNode->GetNumberOfControlPoints() <= controlPointIndex)
-        {
-          markupsNode->AddControlPoint(vtkVector3d(point.Position[0], point.Position[1], point.Position[2]), point.Name);
-        }
-        else
-        {
-          markupsNode->SetNthControlPointLabel(controlPointIndex, point.Name);
-          markupsNode->SetNthControlPointPosition(controlPointIndex, point.Position[0], point.Position[1], point.Position[2]);
-        }
-        markupsNode->SetNthControlPointSelected(controlPointIndex, selected);
-        markupsNode->SetNthControlPointVisibility(controlPointIndex, point.RGBA[3]>0);
-        // Note: we currently do not preserve point.Radius and point.Owner information
-      }
-
-      vtkMRMLMarkupsDisplayNode* displayNode = vtkMRMLMarkupsDisplayNode::SafeDownCast(markupsNode->GetDisplayNode());
-      if (displayNode)
-      {
-        MRMLNodeModifyBlocker blocker(displayNode);
-        if (selectedColorDefined)
-        {
-          displayNode->SetSelectedColor(selectedColor);
-        }
-        if (unselectedColorDefined)
-        {
-          displayNode->SetColor(unselectedColor);
-        }
-      }
+      checkInterval = (std::chrono::steady_clock::now() - lastActivityTime < activityTimeout ? activeCheckInterval : idleCheckInterval);
     }
-    else if (strcmp(deviceType.c_str(), "IMGMETA") == 0)
+    this->ReceiveMonitorWakeUp.wait_for(lock, checkInterval);
+    if (!this->ReceiveMonitorThreadRunning)
     {
-      igtlioImageMetaDevice* imageMetaDevice = reinterpret_cast<igtlioImageMetaDevice*>(modifiedDevice);
-      vtkMRMLImageMetaListNode* imageMetaNode = vtkMRMLImageMetaListNode::SafeDownCast(modifiedNode);
-      imageMetaNode->ClearImageMetaElement();
-      igtlioImageMetaConverter::ImageMetaDataList imageMetaList = imageMetaDevice->GetContent().ImageMetaDataElements;
-      for (igtlioImageMetaConverter::ImageMetaDataList::iterator imageMetaIt = imageMetaList.begin(); imageMetaIt != imageMetaList.end(); ++imageMetaIt)
-      {
-        vtkMRMLImageMetaElement imageMetaElement;
-        imageMetaElement.DeviceName = imageMetaIt->DeviceName;
-        imageMetaElement.Modality = imageMetaIt->Modality;
-        imageMetaElement.Name = imageMetaIt->Name;
-        imageMetaElement.PatientID = imageMetaIt->PatientID;
-        imageMetaElement.PatientName = imageMetaIt->PatientName;
-        imageMetaElement.ScalarType = imageMetaIt->ScalarType;
-        for (int i = 0; i < 3; ++i)
-        {
-          imageMetaElement.Size[i] = imageMetaIt->Size[i];
-        }
-        imageMetaElement.TimeStamp = imageMetaIt->Timestamp;
-        imageMetaNode->AddImageMetaElement(imageMetaElement);
-      }
+      break;
     }
-    else if (strcmp(deviceType.c_str(), "LBMETA") == 0)
+    int state = this->IOConnector->GetState();
+    bool stateChanged = (state != lastState);
+    lastState = state;
+    bool messagesReceived = false;
+    if (state == igtlioConnector::STATE_CONNECTED && !this->ReceivedMessagesProcessingRequested)
     {
-      igtlioLabelMetaDevice* labelMetaDevice = reinterpret_cast<igtlioLabelMetaDevice*>(modifiedDevice);
-      vtkMRMLLabelMetaListNode* labelMetaNode = vtkMRMLLabelMetaListNode::SafeDownCast(modifiedNode);
-      labelMetaNode->ClearLabelMetaElement();
-      igtlioLabelMetaConverter::LabelMetaDataList labelMetaList = labelMetaDevice->GetContent().LabelMetaDataElements;
-      for (igtlioLabelMetaConverter::LabelMetaDataList::iterator labelMetaIt = labelMetaList.begin(); labelMetaIt != labelMetaList.end(); ++labelMetaIt)
-      {
-        vtkMRMLLabelMetaListNode::LabelMetaElement labelMetaElement;
-        labelMetaElement.DeviceName = labelMetaIt->DeviceName;
-        labelMetaElement.Label = labelMetaIt->Label;
-        labelMetaElement.Name = labelMetaIt->Name;
-        labelMetaElement.Owner = labelMetaIt->Owner;
-        for (int i = 0; i < 4; ++i)
-        {
-          labelMetaElement.RGBA[i] = labelMetaIt->RGBA[i];
-        }
-        for (int i = 0; i < 3; ++i)
-        {
-          labelMetaElement.Size[i] = labelMetaIt->Size[i];
-        }
-        labelMetaNode->AddLabelMetaElement(labelMetaElement);
-      }
+      messagesReceived = (this->IOConnector->GetUpdatedBuffersList(updatedBufferNames) > 0);
     }
-    else if (strcmp(deviceType.c_str(), "TDATA") == 0)
+    if (!stateChanged && !messagesReceived)
     {
-      igtlioTrackingDataDevice* tdataDevice = reinterpret_cast<igtlioTrackingDataDevice*>(modifiedDevice);
-      vtkMRMLIGTLTrackingDataBundleNode* tBundleNode = vtkMRMLIGTLTrackingDataBundleNode::SafeDownCast(modifiedNode);
-      if (tBundleNode)
-      {
-        int nElements = tBundleNode->GetNumberOfTransformNodes();
-        igtlioTrackingDataConverter::ContentData content = tdataDevice->GetContent();
-
-        // We read the TDATA elements in the reverse order so that only the first occurrence
-        // of each transform name is used if duplicates are present.
-        // See https://discourse.slicer.org/t/unexpected-behavior-in-transforms-module-and-igt-reslicedriver/42828/8
-        for (auto iter = content.trackingDataElements.rbegin(); iter != content.trackingDataElements.rend(); ++iter)
-        {
-          bool found(false);
-          vtkSmartPointer<vtkMatrix4x4> mat = vtkSmartPointer<vtkMatrix4x4>::New();
-          // if a new tracking data is added, its name is in the key of the tBundleNode TrackingDataList,
-          // the tBundleNode element will be nElements + 1, but nElements is still not changed, resulting in
-          // the searching not completed.  the found flag will be false though the transformnode is there in the
-          // tBundleNode. resulting the Node->Delete() in UpdateTransformNode() function call.
-          // In the TrackingDataList of type std::map, the position of the element is determined by the key’s sorted order, not by when you insert it. For example "Instruement"< "Pointer"<"Reference", Instruement will be at first position.
-          for (int i = 0; i < nElements; i++)
-          {
-            vtkMRMLLinearTransformNode* transformNode = tBundleNode->GetTransformNode(i);
-            if (iter->second.deviceName.compare(transformNode->GetName()) == 0)
-            {
-              // already exists, update transform
-              found = true;
-              mat->DeepCopy(iter->second.transform);
-              transformNode->SetMatrixTransformToParent(mat.GetPointer());
-              transformNode->Modified();
-              break;
-            }
-          }
-          if (!found)
-          {
-            tBundleNode->UpdateTransformNode(iter->second.deviceName.c_str(), mat, iter->second.type);
-            nElements = tBundleNode->GetNumberOfTransformNodes(); // update of the number of transformnode in tBundleNode when new node added.
-          }
-        }
-      }
+      continue;
     }
-
-    // copy metadata from igtl message to MRML node
-    for (igtl::MessageBase::MetaDataMap::const_iterator iter = modifiedDevice->GetMetaData().begin(); iter != modifiedDevice->GetMetaData().end(); ++iter)
+    if (messagesReceived)
     {
-      std::string tag = "OpenIGTLink." + iter->first;
-      modifiedNode->SetAttribute(tag.c_str(), iter->second.second.c_str());
+      this->ReceivedMessagesProcessingRequested = true;
+      lastActivityTime = std::chrono::steady_clock::now();
     }
+    lock.unlock();
+    this->RequestProcessing();
+    lock.lock();
   }
+}
 
-  vtkMRMLIGTLQueryNode* queryNode = this->Internal->GetPendingQueryNodeForDevice(modifiedDevice);
-  if (queryNode && modifiedNode)
+//----------------------------------------------------------------------------
+bool vtkMRMLIGTLConnectorNode::vtkInternal::QueueFrameDecode(FrameDecodeTask& task)
+{
+  if (!this->PendingFrameDecodes.Push(std::move(task)))
   {
-    this->Internal->RemovePendingQueryNode(queryNode);
-    queryNode->SetResponseDataNodeID(modifiedNode->GetID());
-    queryNode->SetQueryStatus(vtkMRMLIGTLQueryNode::STATUS_SUCCESS);
-    queryNode->InvokeEvent(vtkMRMLIGTLQueryNode::ResponseEvent);
+    return false;
   }
+  this->NotifyDecodeThread();
+  return true;
+}
 
-  this->Internal->IncomingNodeClientIDMap[modifiedNode->GetName()] = modifiedDevice->GetClientID();
-  modifiedNode->EndModify(wasModifyingNode);
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::ApplyDecodedFrames(double deadline)
+{
+  FrameDecodeTask task;
+  bool frameApplied = false;
+  // Frames that are not applied remain in the queue for the next call
+  while ((!frameApplied || deadline <= 0.0 || vtkTimerLog::GetUniversalTime() <= deadline) && this->DecodedFrames.Pop(task))
+  {
+    if (!frameApplied)
+    {
+      // The decoding thread may be waiting for room in the queue
+      this->NotifyDecodeThread();
+    }
+    this->ApplyQueuedFrame(task);
+    frameApplied = true;
+  }
+}
 
-  if(isNewNodeCreated)
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::NotifyDecodeThread()
+{
+  // The queues are not protected by the mutex, so it is locked here to ensure that the decoding thread
+  // is either waiting already or still going to check the queues before it waits
   {
-     //New device event needs to be forward with the MRMLNode to other objects, such as openigtlinkRemote. where the node will be processed to set name accordingly.
-     this->InvokeEvent(NewDeviceEvent, modifiedNode);
+    std::lock_guard<std::mutex> lock(this->DecodeThreadWakeUpMutex);
   }
+  this->DecodeThreadWakeUp.notify_one();
 }
 
 //----------------------------------------------------------------------------
-void vtkMRMLIGTLConnectorNode::vtkInternal::DeviceAboutToReceiveEvent(igtlioDevice* modifiedDevice)
+void vtkMRMLIGTLConnectorNode::vtkInternal::ApplyQueuedFrame(FrameDecodeTask& task)
 {
-  if (!modifiedDevice)
+  vtkMRMLScene* scene = this->External->GetScene();
+  if (!scene)
   {
-    vtkErrorWithObjectMacro(modifiedDevice, "Invalid device");
     return;
   }
-
-  vtkMRMLNode* modifiedNode = this->External->GetMRMLNodeForDevice(modifiedDevice);
-  if (!modifiedNode)
+  vtkMRMLStreamingVolumeNode* streamingVolumeNode = vtkMRMLStreamingVolumeNode::SafeDownCast(scene->GetNodeByID(task.NodeID));
+  if (!streamingVolumeNode)
   {
-    // Could not find node, create new node
-    modifiedNode = this->External->CreateNewMRMLNodeForDevice(modifiedDevice);
-    if (modifiedNode)
-    {
-      //New device event needs to be forward with the MRMLNode to other objects, such as openigtlinkRemote. where the node will be processed to set name accordingly.
-      this->External->InvokeEvent(NewDeviceEvent, modifiedNode);
-    }
+    // Node has been removed while the frame was decoded
+    return;
   }
-  if (!modifiedNode)
+  std::map<std::string, unsigned long>::iterator lastAppliedIt = this->LastAppliedFrameSequence.find(task.NodeID);
+  if (lastAppliedIt != this->LastAppliedFrameSequence.end() && lastAppliedIt->second >= task.Sequence)
   {
-    // Could not add node.
+    // A more recent frame is already shown
     return;
   }
-
-  vtkInternal::NodeModification modifying;
-  modifying.Node = modifiedNode;
-  modifying.Modifying = modifiedNode->StartModify();
-  this->PendingNodeModifications.push_back(modifying);
+  this->LastAppliedFrameSequence[task.NodeID] = task.Sequence;
+  this->ApplyFrame(streamingVolumeNode, task);
 }
 
 //----------------------------------------------------------------------------
-vtkMRMLNode* vtkMRMLIGTLConnectorNode::GetMRMLNodeForDevice(igtlioDevice* device)
+void vtkMRMLIGTLConnectorNode::vtkInternal::ApplyFrame(vtkMRMLStreamingVolumeNode* streamingVolumeNode, FrameDecodeTask& task)
 {
-  if (!this->GetScene())
+  MRMLNodeModifyBlocker blocker(streamingVolumeNode);
+  streamingVolumeNode->SetIJKToRASMatrix(task.IJKToRASMatrix);
+  streamingVolumeNode->SetAndObserveFrame(task.Frame);
+  if (task.DecodedImage)
   {
-    // No scene to add nodes to.
-    return nullptr;
+    streamingVolumeNode->SetAndObserveImageData(task.DecodedImage);
   }
+}
 
-  const std::string deviceType = device->GetDeviceType();
-  std::string deviceName = device->GetDeviceName();
-
-  // Found the node and return the node;
-  vtkInternal::NodeInfoMapType::iterator inIter;
-  for (inIter = this->Internal->IncomingMRMLNodeInfoMap.begin();
-    inIter != this->Internal->IncomingMRMLNodeInfoMap.end();
-    inIter++)
+//----------------------------------------------------------------------------
+bool vtkMRMLIGTLConnectorNode::vtkInternal::IsVolumeNodeDisplayed(vtkMRMLVolumeNode* volumeNode)
+{
+  vtkMRMLScene* scene = volumeNode->GetScene();
+  const char* volumeNodeID = volumeNode->GetID();
+  if (!scene || !volumeNodeID)
   {
-    vtkMRMLNode* node = this->GetScene()->GetNodeByID((inIter->first));
-    if (node)
-    {
-      bool typeMatched = false;
-      for (unsigned int i = 0; i < this->GetNodeTagFromDeviceType(deviceType.c_str()).size(); i++)
-      {
-        const std::string nodeTag = this->GetNodeTagFromDeviceType(deviceType.c_str())[i];
-        if (strcmp(node->GetNodeTagName(), nodeTag.c_str()) == 0)
-        {
-          typeMatched = 1;
-          break;
-        }
-      }
-      //Node name can be modified by other module, it is not a concrete way to find the match to the device name
-      // OriginalNodeNameKey arrtribute was added during node creation.
-      if (typeMatched && node->GetAttribute(OriginalNodeNameKey) && strcmp(node->GetAttribute(OriginalNodeNameKey), deviceName.c_str()) == 0)
+    return false;
+  }
+  if (scene != this->DisplayedStateScene)
+  {
+    this->ObserveDisplayedStateScene(scene);
+  }
+  std::unordered_map<std::string, bool>::iterator cacheIt = this->VolumeNodeDisplayedCache.find(volumeNodeID);
+  if (cacheIt != this->VolumeNodeDisplayedCache.end())
+  {
+    return cacheIt->second;
+  }
+  // Display nodes of the volume are modified, added, or removed
+  this->ObserveDisplayedStateNode(volumeNode, vtkMRMLDisplayableNode::DisplayModifiedEvent);
+  bool displayed = vtkInternal::ComputeVolumeNodeDisplayed(volumeNode);
+  this->VolumeNodeDisplayedCache[volumeNodeID] = displayed;
+  return displayed;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLIGTLConnectorNode::vtkInternal::ComputeVolumeNodeDisplayed(vtkMRMLVolumeNode* volumeNode)
+{
+  vtkMRMLScene* scene = volumeNode->GetScene();
+  const char* volumeNodeID = volumeNode->GetID();
+  if (!scene || !volumeNodeID)
+  {
+    return false;
+  }
+  std::vector<vtkMRMLNode*> sliceCompositeNodes;
+  scene->GetNodesByClass("vtkMRMLSliceCompositeNode", sliceCompositeNodes);
+  for (std::vector<vtkMRMLNode*>::iterator nodeIt = sliceCompositeNodes.begin(); nodeIt != sliceCompositeNodes.end(); ++nodeIt)
+  {
+    vtkMRMLSliceCompositeNode* sliceCompositeNode = vtkMRMLSliceCompositeNode::SafeDownCast(*nodeIt);
+    const char* layerVolumeNodeIDs[3] =
+    {
+      sliceCompositeNode->GetBackgroundVolumeID(),
+      sliceCompositeNode->GetForegroundVolumeID(),
+      sliceCompositeNode->GetLabelVolumeID()
+    };
+    for (int layer = 0; layer < 3; ++layer)
+    {
+      if (layerVolumeNodeIDs[layer] && !strcmp(layerVolumeNodeIDs[layer], volumeNodeID))
       {
-        return node;
+        return true;
       }
     }
   }
-  return nullptr;
+  // The default volume display node is visible even if the volume is not shown in any view,
+  // other display nodes (volume rendering) are only visible if they are shown.
+  for (int displayNodeIndex = 0; displayNodeIndex < volumeNode->GetNumberOfDisplayNodes(); ++displayNodeIndex)
+  {
+    vtkMRMLDisplayNode* displayNode = volumeNode->GetNthDisplayNode(displayNodeIndex);
+    if (displayNode && displayNode->GetVisibility() && !vtkMRMLVolumeDisplayNode::SafeDownCast(displayNode))
+    {
+      return true;
+    }
+  }
+  return false;
 }
 
 //----------------------------------------------------------------------------
-vtkMRMLNode* vtkMRMLIGTLConnectorNode::CreateNewMRMLNodeForDevice(igtlioDevice *device)
+void vtkMRMLIGTLConnectorNode::vtkInternal::ObserveDisplayedStateScene(vtkMRMLScene* scene)
 {
-  vtkMRMLScene* scene = this->GetScene();
+  this->RemoveDisplayedStateObservers();
+  this->DisplayedStateScene = scene;
   if (!scene)
   {
-    return nullptr;
+    return;
+  }
+  scene->AddObserver(vtkMRMLScene::NodeAddedEvent, this->DisplayedStateCallback);
+  scene->AddObserver(vtkMRMLScene::NodeRemovedEvent, this->DisplayedStateCallback);
+  scene->AddObserver(vtkMRMLScene::EndBatchProcessEvent, this->DisplayedStateCallback);
+  std::vector<vtkMRMLNode*> sliceCompositeNodes;
+  scene->GetNodesByClass("vtkMRMLSliceCompositeNode", sliceCompositeNodes);
+  for (vtkMRMLNode* sliceCompositeNode : sliceCompositeNodes)
+  {
+    this->ObserveDisplayedStateNode(sliceCompositeNode, vtkCommand::ModifiedEvent);
   }
+}
 
-  const std::string deviceType = device->GetDeviceType();
-  std::string deviceName = device->GetDeviceName();
-  // Device name is empty, we will not be able to find a node in the scene
-  if (device->GetDeviceName().empty())
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::ObserveDisplayedStateNode(vtkObject* node, unsigned long event)
+{
+  vtkWeakPointer<vtkObject>& observedNode = this->DisplayedStateObservedNodes[node];
+  if (observedNode)
   {
-    deviceName = "OpenIGTLink";
+    return;
   }
+  observedNode = node;
+  node->AddObserver(event, this->DisplayedStateCallback);
+}
 
-  // Node not found and add the node
-  if (strcmp(device->GetDeviceType().c_str(), "IMAGE") == 0)
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::RemoveDisplayedStateObservers()
+{
+  if (this->DisplayedStateScene)
+  {
+    this->DisplayedStateScene->RemoveObserver(this->DisplayedStateCallback);
+  }
+  for (auto& observedNode : this->DisplayedStateObservedNodes)
   {
-    vtkSmartPointer<vtkMRMLVolumeNode> volumeNode;
-    int numberOfComponents = 1;
-    vtkSmartPointer<vtkImageData> image;
-    igtlioImageDevice* imageDevice = reinterpret_cast<igtlioImageDevice*>(device);
-    igtlioImageConverter::ContentData content = imageDevice->GetContent();
-    if (!content.image)
+    if (observedNode.second)
     {
-      // Image data has not been set yet
-      return NULL;
+      observedNode.second->RemoveObserver(this->DisplayedStateCallback);
     }
-    numberOfComponents = content.image->GetNumberOfScalarComponents(); //to improve the io module to be able to cope with video data
-    image = content.image;
-#if defined(OpenIGTLink_ENABLE_VIDEOSTREAMING)
-    if (this->UseStreamingVolume)
+  }
+  this->DisplayedStateObservedNodes.clear();
+  this->DisplayedStateScene = nullptr;
+  this->VolumeNodeDisplayedCache.clear();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::OnDisplayedStateModified(vtkObject* caller, unsigned long event, void* clientData, void* callData)
+{
+  vtkInternal* self = static_cast<vtkInternal*>(clientData);
+  self->VolumeNodeDisplayedCache.clear();
+  if (caller != self->DisplayedStateScene)
+  {
+    return;
+  }
+  vtkMRMLNode* node = static_cast<vtkMRMLNode*>(callData);
+  if (event == vtkMRMLScene::NodeAddedEvent && vtkMRMLSliceCompositeNode::SafeDownCast(node))
+  {
+    self->ObserveDisplayedStateNode(node, vtkCommand::ModifiedEvent);
+  }
+  else if (event == vtkMRMLScene::NodeRemovedEvent && node)
+  {
+    std::unordered_map<vtkObject*, vtkWeakPointer<vtkObject> >::iterator observedNodeIt = self->DisplayedStateObservedNodes.find(node);
+    if (observedNodeIt != self->DisplayedStateObservedNodes.end())
     {
-      volumeNode = vtkMRMLStreamingVolumeNode::SafeDownCast(this->GetScene()->GetFirstNode(deviceName.c_str(), "vtkMRMLStreamingVolumeNode"));
-      if (volumeNode)
-      {
-        this->RegisterIncomingMRMLNode(volumeNode, device);
-        return volumeNode;
-      }
-      volumeNode = vtkSmartPointer<vtkMRMLVolumeNode>::Take(vtkMRMLVolumeNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLStreamingVolumeNode")));
+      node->RemoveObserver(self->DisplayedStateCallback);
+      self->DisplayedStateObservedNodes.erase(observedNodeIt);
     }
-    else
+  }
+  else if (event == vtkMRMLScene::EndBatchProcessEvent)
+  {
+    // Nodes may have been added or removed without events while the scene was imported or closed
+    self->ObserveDisplayedStateScene(self->DisplayedStateScene);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::KeepDecodersOfCutChains()
+{
+  std::set<std::string> mainThreadDecodedNodeIDs;
+  for (FrameMapType::iterator frameIt = this->PreviousIncomingFramesMap.begin(); frameIt != this->PreviousIncomingFramesMap.end(); ++frameIt)
+  {
+    PreviousFrameInfo& previousFrame = frameIt->second;
+    // True if the previous frames have been decoded by the codec of the decoding thread, and not by the volume node.
+    // UseBackgroundDecoding has already been changed, so the flags describe the previous decoding mode.
+    bool decodedByThreadCodec = (this->UseBackgroundDecoding ? previousFrame.DecodeOnMainThread : !previousFrame.DecodeInVolumeNode);
+    previousFrame.DecodeInVolumeNode = false;
+    previousFrame.DecodeOnMainThread = false;
+    if (!previousFrame.ChainCut)
     {
-      if (numberOfComponents > 1)
-      {
-        volumeNode = vtkMRMLVectorVolumeNode::SafeDownCast(this->GetScene()->GetFirstNode(deviceName.c_str(), "vtkMRMLVectorVolumeNode"));
-        if (volumeNode)
-        {
-          this->RegisterIncomingMRMLNode(volumeNode, device);
-          return volumeNode;
-        }
-        volumeNode = vtkSmartPointer<vtkMRMLVolumeNode>::Take(vtkMRMLVolumeNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLVectorVolumeNode")));
-      }
-      else
-      {
-        volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(this->GetScene()->GetFirstNode(deviceName.c_str(), "vtkMRMLScalarVolumeNode"));
-        if (volumeNode)
-        {
-          this->RegisterIncomingMRMLNode(volumeNode, device);
-          return volumeNode;
-        }
-        volumeNode = vtkSmartPointer<vtkMRMLVolumeNode>::Take(vtkMRMLVolumeNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLScalarVolumeNode")));
-      }
+      // Any decoder can decode the chain
+      continue;
     }
-#else
-    if (numberOfComponents > 1)
+    if (this->UseBackgroundDecoding)
     {
-      volumeNode = vtkMRMLVectorVolumeNode::SafeDownCast(this->GetScene()->GetFirstNode(deviceName.c_str(), "vtkMRMLVectorVolumeNode"));
-      if (volumeNode)
-      {
-        this->RegisterIncomingMRMLNode(volumeNode, device);
-        return volumeNode;
-      }
-      volumeNode = vtkSmartPointer<vtkMRMLVolumeNode>::Take(vtkMRMLVolumeNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLVectorVolumeNode")));
+      // Only the volume node can continue the chain, unless the codec of the decoding thread has decoded it
+      previousFrame.DecodeInVolumeNode = !decodedByThreadCodec;
     }
-    else
+    else if (decodedByThreadCodec)
     {
-      volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(this->GetScene()->GetFirstNode(deviceName.c_str(), "vtkMRMLScalarVolumeNode"));
-      if (volumeNode)
+      previousFrame.DecodeOnMainThread = true;
+      mainThreadDecodedNodeIDs.insert(previousFrame.NodeID);
+    }
+  }
+  if (!this->UseBackgroundDecoding)
+  {
+    // Release the codecs of the stopped decoding thread that are not needed
+    for (std::map<std::string, vtkSmartPointer<vtkStreamingVolumeCodec> >::iterator codecIt = this->DecodeThreadCodecs.begin();
+      codecIt != this->DecodeThreadCodecs.end();)
+    {
+      if (mainThreadDecodedNodeIDs.count(codecIt->first))
       {
-        this->RegisterIncomingMRMLNode(volumeNode, device);
-        return volumeNode;
+        ++codecIt;
+        continue;
       }
-      volumeNode = vtkSmartPointer<vtkMRMLVolumeNode>::Take(vtkMRMLVolumeNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLScalarVolumeNode")));
+      this->DecodeThreadImagePools.erase(codecIt->first);
+      codecIt = this->DecodeThreadCodecs.erase(codecIt);
     }
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLIGTLConnectorNode::vtkInternal::CoalesceIncomingDevice(igtlioDevice* device)
+{
+  if (!this->CoalesceIncomingMessages && this->ProcessingTimeBudget <= 0.0)
+  {
+    return false;
+  }
+#if defined(OpenIGTLink_ENABLE_VIDEOSTREAMING)
+  if (igtlioVideoDevice::SafeDownCast(device))
+  {
+    // Video frames may be decoded only if all previous frames since the last key frame are available
+    return false;
+  }
 #endif
-    volumeNode->SetIJKToRASMatrix(content.transform);
-    volumeNode->SetAndObserveImageData(image);
-    volumeNode->SetName(deviceName.c_str());
-    this->GetScene()->SaveStateForUndo();
-    volumeNode->SetDescription("Received by OpenIGTLink");
-    vtkDebugWithObjectMacro(this, "Name vol node " << volumeNode->GetClassName());
-    this->GetScene()->AddNode(volumeNode);
+  if (!this->CoalescedDeviceSet.insert(device).second)
+  {
+    // The previous message of this device has not been applied yet and its content is now overwritten
+    this->DroppedIncomingMessageCounts[std::make_pair(device->GetDeviceType(), device->GetDeviceName())]++;
+    this->NumberOfDroppedIncomingMessages++;
+    return true;
+  }
+  this->CoalescedDevices.push_back(device);
+  return true;
+}
 
-    vtkDebugWithObjectMacro(this, "Set basic display info");
-    bool scalarDisplayNodeRequired = (numberOfComponents == 1);
-    vtkSmartPointer<vtkMRMLVolumeDisplayNode> displayNode;
-    if (scalarDisplayNodeRequired)
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::ApplyCoalescedDevices(double deadline)
+{
+  // Applying content may invoke events that lead to receiving more messages, so process a copy of the list
+  std::vector<vtkSmartPointer<igtlioDevice> > devices;
+  devices.swap(this->CoalescedDevices);
+  if (deadline > 0.0)
+  {
+    // Priorities are looked up once for each device, not for each comparison.
+    // Devices of the same priority are applied in the order they were received.
+    std::vector<std::pair<int, igtlioDevice*> > prioritizedDevices;
+    prioritizedDevices.reserve(devices.size());
+    for (const vtkSmartPointer<igtlioDevice>& device : devices)
     {
-      displayNode = vtkSmartPointer<vtkMRMLScalarVolumeDisplayNode>::Take(vtkMRMLScalarVolumeDisplayNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLScalarVolumeDisplayNode")));
+      prioritizedDevices.push_back(std::make_pair(this->External->GetIncomingMessagePriority(device->GetDeviceType()), device.GetPointer()));
     }
-    else
+    std::stable_sort(prioritizedDevices.begin(), prioritizedDevices.end(),
+      [](const std::pair<int, igtlioDevice*>& a, const std::pair<int, igtlioDevice*>& b)
+      {
+        return a.first > b.first;
+      });
+    // devices keeps the devices alive until the sorted list replaces it
+    std::vector<vtkSmartPointer<igtlioDevice> > sortedDevices;
+    sortedDevices.reserve(prioritizedDevices.size());
+    for (const std::pair<int, igtlioDevice*>& prioritizedDevice : prioritizedDevices)
     {
-      displayNode = vtkSmartPointer<vtkMRMLVectorVolumeDisplayNode>::Take(vtkMRMLVectorVolumeDisplayNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLVectorVolumeDisplayNode")));
+      sortedDevices.push_back(prioritizedDevice.second);
     }
-
-    this->GetScene()->AddNode(displayNode);
-
-    if (scalarDisplayNodeRequired)
+    devices.swap(sortedDevices);
+  }
+  size_t deviceIndex = 0;
+  for (; deviceIndex < devices.size(); ++deviceIndex)
+  {
+    // At least one device is applied in each call, so that all devices are applied eventually
+    if (deadline > 0.0 && deviceIndex > 0 && vtkTimerLog::GetUniversalTime() > deadline)
     {
-      const char* colorTableId = vtkMRMLColorLogic::GetColorTableNodeID(vtkMRMLColorTableNode::Grey);
-      displayNode->SetAndObserveColorNodeID(colorTableId);
+      break;
     }
-    else
+    igtlioDevice* device = devices[deviceIndex];
+    this->CoalescedDeviceSet.erase(device);
+    if (deadline > 0.0)
     {
-      displayNode->SetDefaultColorMap();
+      // The node may have been received in a previous call, so modifications are grouped here
+      vtkMRMLNode* node = this->External->GetMRMLNodeForDevice(device);
+      if (node)
+      {
+        vtkInternal::NodeModification modifying;
+        modifying.Node = node;
+        modifying.Modifying = node->StartModify();
+        this->PendingNodeModifications.push_back(modifying);
+      }
     }
-
-    volumeNode->SetAndObserveDisplayNodeID(displayNode->GetID());
-    this->RegisterIncomingMRMLNode(volumeNode, device);
-    return volumeNode;
+    this->External->ProcessIncomingDeviceModifiedEvent(device, device->GetDeviceContentModifiedEvent(), device);
+    this->External->InvokeEvent(DeviceModifiedEvent, device);
   }
-#if defined(OpenIGTLink_ENABLE_VIDEOSTREAMING)
-  else if (strcmp(device->GetDeviceType().c_str(), "VIDEO") == 0)
+  // Devices that did not fit in the time budget are applied first in the next call
+  this->CoalescedDevices.insert(this->CoalescedDevices.begin(), devices.begin() + deviceIndex, devices.end());
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::AssignIncomingImageBuffer(igtlioImageDevice* imageDevice)
+{
+  if (this->IncomingImageBufferPoolSize <= 0)
   {
-    igtlioVideoDevice* videoDevice = reinterpret_cast<igtlioVideoDevice*>(device);
-    igtlioVideoConverter::ContentData content = videoDevice->GetContent();
-    if (!content.frameData)
-    {
-      // frame data has not been set yet
-      return NULL;
-    }
-    int numberOfComponents = content.grayscale ? 1 : 3;
+    return;
+  }
+  igtlioImageConverter::ContentData content = imageDevice->GetContent();
+  ImageBufferPoolType& pool = this->IncomingImageBufferPools[imageDevice];
 
-    vtkSmartPointer<vtkMRMLStreamingVolumeNode> streamingVolumeNode =
-      vtkMRMLStreamingVolumeNode::SafeDownCast(this->GetScene()->GetFirstNode(deviceName.c_str(), "vtkMRMLStreamingVolumeNode"));
-    if (streamingVolumeNode)
+  // A buffer is free if it is only referenced by the pool
+  vtkImageData* freeBuffer = nullptr;
+  for (ImageBufferPoolType::iterator bufferIt = pool.begin(); bufferIt != pool.end(); ++bufferIt)
+  {
+    if ((*bufferIt)->GetReferenceCount() == 1)
     {
-      this->RegisterIncomingMRMLNode(streamingVolumeNode, device);
-      return streamingVolumeNode;
+      freeBuffer = *bufferIt;
+      break;
     }
-
-    this->GetScene()->SaveStateForUndo();
-    bool scalarDisplayNodeRequired = (numberOfComponents == 1);
-    streamingVolumeNode = vtkSmartPointer<vtkMRMLStreamingVolumeNode>::Take(vtkMRMLStreamingVolumeNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLStreamingVolumeNode")));
-    streamingVolumeNode->SetName(deviceName.c_str());
-    streamingVolumeNode->SetDescription("Received by OpenIGTLink");
-    this->GetScene()->AddNode(streamingVolumeNode);
-    vtkSmartPointer<vtkMRMLVolumeDisplayNode> displayNode;
-    if (scalarDisplayNodeRequired)
+  }
+  if (!freeBuffer)
+  {
+    if (pool.size() >= static_cast<size_t>(this->IncomingImageBufferPoolSize))
     {
-      displayNode = vtkSmartPointer<vtkMRMLScalarVolumeDisplayNode>::Take(vtkMRMLScalarVolumeDisplayNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLScalarVolumeDisplayNode")));
+      // All buffers are in use, the image is written into the current image data of the device
+      return;
     }
-    else
+    vtkSmartPointer<vtkImageData> newBuffer = vtkSmartPointer<vtkImageData>::New();
+    if (content.image)
     {
-      displayNode = vtkSmartPointer<vtkMRMLVectorVolumeDisplayNode>::Take(vtkMRMLVectorVolumeDisplayNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLVectorVolumeDisplayNode")));
+      // Allocate with the current geometry, so that the image converter can reuse the scalars
+      newBuffer->CopyStructure(content.image);
+      newBuffer->AllocateScalars(content.image->GetScalarType(), content.image->GetNumberOfScalarComponents());
     }
-    this->GetScene()->AddNode(displayNode);
-    if (scalarDisplayNodeRequired)
+    pool.push_back(newBuffer);
+    freeBuffer = newBuffer;
+  }
+
+  content.image = freeBuffer;
+  this->IgnoreDeviceEvents = true;
+  imageDevice->SetContent(content);
+  this->IgnoreDeviceEvents = false;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::RegisterDefaultDeviceTypeHandlers()
+{
+  // VIDEO is registered before IMAGE, so that streaming volumes are sent as VIDEO if possible
+  DeviceTypeHandler videoHandler;
+  videoHandler.NodeTags = { "StreamingVolume" };
+#if defined(OpenIGTLink_ENABLE_VIDEOSTREAMING)
+  videoHandler.ApplyIncoming = &vtkInternal::ApplyIncomingVideo;
+  videoHandler.AssignOutgoing = &vtkInternal::AssignOutgoingVideo;
+  videoHandler.CreateIncomingNode = &vtkInternal::CreateIncomingVideoNode;
+  videoHandler.OutgoingContentFingerprint = &vtkInternal::GetOutgoingImageFingerprint;
+#endif
+  this->SetDeviceTypeHandler("VIDEO", videoHandler);
+
+  DeviceTypeHandler imageHandler;
+  imageHandler.NodeTags = { "Volume", "VectorVolume", "StreamingVolume" };
+  imageHandler.ApplyIncoming = &vtkInternal::ApplyIncomingImage;
+  imageHandler.AssignOutgoing = &vtkInternal::AssignOutgoingImage;
+  imageHandler.CreateIncomingNode = &vtkInternal::CreateIncomingImageNode;
+  imageHandler.OutgoingContentFingerprint = &vtkInternal::GetOutgoingImageFingerprint;
+  this->SetDeviceTypeHandler("IMAGE", imageHandler);
+
+  DeviceTypeHandler statusHandler;
+  statusHandler.NodeTags = { "IGTLStatus" };
+  statusHandler.ApplyIncoming = &vtkInternal::ApplyIncomingStatus;
+  statusHandler.AssignOutgoing = &vtkInternal::AssignOutgoingStatus;
+  statusHandler.CreateIncomingNode = &vtkInternal::CreateIncomingStatusNode;
+  this->SetDeviceTypeHandler("STATUS", statusHandler);
+
+  DeviceTypeHandler transformHandler;
+  transformHandler.NodeTags = { "LinearTransform" };
+  transformHandler.ApplyIncoming = &vtkInternal::ApplyIncomingTransform;
+  transformHandler.AssignOutgoing = &vtkInternal::AssignOutgoingTransform;
+  transformHandler.CreateIncomingNode = &vtkInternal::CreateIncomingTransformNode;
+  transformHandler.OutgoingContentFingerprint = &vtkInternal::GetOutgoingTransformFingerprint;
+  this->SetDeviceTypeHandler("TRANSFORM", transformHandler);
+
+  DeviceTypeHandler polyDataHandler;
+  polyDataHandler.NodeTags = { "Model", "FiberBundle" };
+  polyDataHandler.ApplyIncoming = &vtkInternal::ApplyIncomingPolyData;
+  polyDataHandler.AssignOutgoing = &vtkInternal::AssignOutgoingPolyData;
+  polyDataHandler.CreateIncomingNode = &vtkInternal::CreateIncomingPolyDataNode;
+  polyDataHandler.OutgoingContentFingerprint = &vtkInternal::GetOutgoingPolyDataFingerprint;
+  this->SetDeviceTypeHandler("POLYDATA", polyDataHandler);
+
+  DeviceTypeHandler stringHandler;
+  stringHandler.NodeTags = { "Text" };
+  stringHandler.ApplyIncoming = &vtkInternal::ApplyIncomingString;
+  stringHandler.AssignOutgoing = &vtkInternal::AssignOutgoingString;
+  stringHandler.CreateIncomingNode = &vtkInternal::CreateIncomingStringNode;
+  stringHandler.OutgoingContentFingerprint = &vtkInternal::GetOutgoingStringFingerprint;
+  this->SetDeviceTypeHandler("STRING", stringHandler);
+
+  DeviceTypeHandler pointHandler;
+  pointHandler.NodeTags = { "MarkupsFiducial" };
+  pointHandler.ApplyIncoming = &vtkInternal::ApplyIncomingPoint;
+  pointHandler.AssignOutgoing = &vtkInternal::AssignOutgoingPoint;
+  pointHandler.CreateIncomingNode = &vtkInternal::CreateIncomingPointNode;
+  pointHandler.OutgoingContentFingerprint = &vtkInternal::GetOutgoingPointFingerprint;
+  this->SetDeviceTypeHandler("POINT", pointHandler);
+
+  DeviceTypeHandler imageMetaHandler;
+  imageMetaHandler.NodeTags = { "ImageMetaList" };
+  imageMetaHandler.ApplyIncoming = &vtkInternal::ApplyIncomingImageMeta;
+  imageMetaHandler.CreateIncomingNode = &vtkInternal::CreateIncomingImageMetaNode;
+  this->SetDeviceTypeHandler("IMGMETA", imageMetaHandler);
+
+  DeviceTypeHandler labelMetaHandler;
+  labelMetaHandler.NodeTags = { "LabelMetaList" };
+  labelMetaHandler.ApplyIncoming = &vtkInternal::ApplyIncomingLabelMeta;
+  labelMetaHandler.CreateIncomingNode = &vtkInternal::CreateIncomingLabelMetaNode;
+  this->SetDeviceTypeHandler("LBMETA", labelMetaHandler);
+
+  DeviceTypeHandler trackingDataHandler;
+  trackingDataHandler.NodeTags = { "IGTLTrackingDataSplitter" };
+  trackingDataHandler.ApplyIncoming = &vtkInternal::ApplyIncomingTrackingData;
+  trackingDataHandler.AssignOutgoing = &vtkInternal::AssignOutgoingTrackingData;
+  trackingDataHandler.CreateIncomingNode = &vtkInternal::CreateIncomingTrackingDataNode;
+  this->SetDeviceTypeHandler("TDATA", trackingDataHandler);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::SetDeviceTypeHandler(const std::string& deviceType, const DeviceTypeHandler& handler)
+{
+  if (!this->DeviceTypeHandlers.count(deviceType))
+  {
+    this->DeviceTypeRegistrationOrder.push_back(deviceType);
+  }
+  this->DeviceTypeHandlers[deviceType] = handler;
+  // Devices may have been resolved to the previous handler of this type
+  this->DeviceTypeHandlerCache.clear();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::RemoveDeviceTypeHandler(const std::string& deviceType)
+{
+  this->DeviceTypeHandlers.erase(deviceType);
+  this->DeviceTypeRegistrationOrder.erase(std::remove(this->DeviceTypeRegistrationOrder.begin(),
+    this->DeviceTypeRegistrationOrder.end(), deviceType), this->DeviceTypeRegistrationOrder.end());
+  this->DeviceTypeHandlerCache.clear();
+}
+
+//----------------------------------------------------------------------------
+const vtkMRMLIGTLConnectorNode::DeviceTypeHandler* vtkMRMLIGTLConnectorNode::vtkInternal::GetDeviceTypeHandler(igtlioDevice* device)
+{
+  if (!device)
+  {
+    return nullptr;
+  }
+
+  // The device type of a device never changes, so the handler only needs to be looked up once per device.
+  DeviceTypeHandlerCacheType::iterator cachedHandlerIt = this->DeviceTypeHandlerCache.find(device);
+  if (cachedHandlerIt != this->DeviceTypeHandlerCache.end())
+  {
+    return cachedHandlerIt->second;
+  }
+
+  const DeviceTypeHandler* handler = nullptr;
+  DeviceTypeHandlerMapType::iterator handlerIt = this->DeviceTypeHandlers.find(device->GetDeviceType());
+  if (handlerIt != this->DeviceTypeHandlers.end())
+  {
+    handler = &(handlerIt->second);
+  }
+  this->DeviceTypeHandlerCache[device] = handler;
+  return handler;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::AddIncomingNodeToIndex(vtkMRMLNode* node)
+{
+  if (!node)
+  {
+    return;
+  }
+  const char* deviceName = node->GetAttribute(OriginalNodeNameKey);
+  if (!deviceName)
+  {
+    // The attribute is set when the node is registered
+    return;
+  }
+  this->IncomingNodeIndexedNames[node->GetID()] = deviceName;
+  const char* nodeTag = node->GetNodeTagName();
+  for (DeviceTypeHandlerMapType::iterator handlerIt = this->DeviceTypeHandlers.begin(); handlerIt != this->DeviceTypeHandlers.end(); ++handlerIt)
+  {
+    const std::vector<std::string>& nodeTags = handlerIt->second.NodeTags;
+    if (std::find(nodeTags.begin(), nodeTags.end(), nodeTag) == nodeTags.end())
     {
-      const char* colorTableId = vtkMRMLColorLogic::GetColorTableNodeID(vtkMRMLColorTableNode::Grey);
-      displayNode->SetAndObserveColorNodeID(colorTableId);
+      continue;
     }
-    else
+    // If there are multiple nodes for the same device then the first one is used
+    vtkWeakPointer<vtkMRMLNode>& indexedNode = this->IncomingNodeIndex[handlerIt->first][deviceName];
+    if (!indexedNode)
     {
-      displayNode->SetDefaultColorMap();
+      indexedNode = node;
     }
-    streamingVolumeNode->SetAndObserveDisplayNodeID(displayNode->GetID());
-    this->RegisterIncomingMRMLNode(streamingVolumeNode, device);
-    return streamingVolumeNode;
   }
-#endif
-  else if (strcmp(device->GetDeviceType().c_str(), "STATUS") == 0)
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::RebuildIncomingNodeIndex()
+{
+  this->IncomingNodeIndex.clear();
+  this->IncomingNodeIndexedNames.clear();
+  vtkMRMLScene* scene = this->External->GetScene();
+  if (!scene)
   {
-    vtkSmartPointer<vtkMRMLIGTLStatusNode> statusNode =
-      vtkMRMLIGTLStatusNode::SafeDownCast(this->GetScene()->GetFirstNode(deviceName.c_str(), "vtkMRMLIGTLStatusNode"));
-    if (statusNode)
-    {
-      this->RegisterIncomingMRMLNode(statusNode, device);
-      return statusNode;
-    }
+    return;
+  }
+  for (NodeInfoMapType::iterator inIter = this->IncomingMRMLNodeInfoMap.begin(); inIter != this->IncomingMRMLNodeInfoMap.end(); ++inIter)
+  {
+    this->AddIncomingNodeToIndex(scene->GetNodeByID(inIter->first));
+  }
+}
 
-    statusNode = vtkSmartPointer<vtkMRMLIGTLStatusNode>::Take(vtkMRMLIGTLStatusNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLIGTLStatusNode")));
-    statusNode->SetName(deviceName.c_str());
-    statusNode->SetDescription("Received by OpenIGTLink");
-    this->GetScene()->AddNode(statusNode);
-    this->RegisterIncomingMRMLNode(statusNode, device);
-    return statusNode;
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::UpdateIncomingNodeIndex(vtkMRMLNode* node)
+{
+  if (!node || !node->GetID())
+  {
+    return;
   }
-  else if (strcmp(device->GetDeviceType().c_str(), "TRANSFORM") == 0)
+  const char* deviceName = node->GetAttribute(OriginalNodeNameKey);
+  std::unordered_map<std::string, std::string>::iterator indexedNameIt = this->IncomingNodeIndexedNames.find(node->GetID());
+  if (indexedNameIt != this->IncomingNodeIndexedNames.end())
   {
-    vtkSmartPointer<vtkMRMLTransformNode> transformNode =
-      vtkMRMLTransformNode::SafeDownCast(this->GetScene()->GetFirstNode(deviceName.c_str(), "vtkMRMLTransformNode"));
-    if (transformNode)
+    if (deviceName && indexedNameIt->second == deviceName)
     {
-      this->RegisterIncomingMRMLNode(transformNode, device);
-      return transformNode;
+      // Index is up-to-date
+      return;
     }
+  }
+  else if (!deviceName || this->IncomingMRMLNodeInfoMap.find(node->GetID()) == this->IncomingMRMLNodeInfoMap.end())
+  {
+    // Not an incoming node or it cannot be indexed
+    return;
+  }
+  // Rebuild the whole index, so that another node of the same device name can take the place of this node
+  this->RebuildIncomingNodeIndex();
+}
 
-    transformNode = vtkSmartPointer<vtkMRMLLinearTransformNode>::Take(vtkMRMLLinearTransformNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLLinearTransformNode")));
-    transformNode->SetName(deviceName.c_str());
-    transformNode->SetDescription("Received by OpenIGTLink");
-    vtkNew<vtkMatrix4x4> transform;
-    transformNode->SetMatrixTransformToParent(transform);
-    this->GetScene()->AddNode(transformNode);
-    this->RegisterIncomingMRMLNode(transformNode, device);
-    return transformNode;
+//----------------------------------------------------------------------------
+vtkMRMLNode* vtkMRMLIGTLConnectorNode::vtkInternal::FindIndexedIncomingNode(const std::string& deviceType, const std::string& deviceName)
+{
+  IncomingNodeIndexType::iterator typeIt = this->IncomingNodeIndex.find(deviceType);
+  if (typeIt == this->IncomingNodeIndex.end())
+  {
+    return nullptr;
   }
-  else if (strcmp(device->GetDeviceType().c_str(), "POLYDATA") == 0)
+  DeviceNameToNodeMapType::iterator nodeIt = typeIt->second.find(deviceName);
+  if (nodeIt == typeIt->second.end())
   {
-    vtkSmartPointer<vtkMRMLModelNode> modelNode =
-      vtkMRMLModelNode::SafeDownCast(this->GetScene()->GetFirstNode(deviceName.c_str(), "vtkMRMLModelNode"));
-    if (modelNode)
-    {
-      this->RegisterIncomingMRMLNode(modelNode, device);
-      return modelNode;
-    }
+    return nullptr;
+  }
+  vtkMRMLNode* node = nodeIt->second;
+  if (!node || node->GetScene() != this->External->GetScene())
+  {
+    return nullptr;
+  }
+  const char* originalNodeName = node->GetAttribute(OriginalNodeNameKey);
+  if (!originalNodeName || deviceName != originalNodeName)
+  {
+    // Attribute has been changed since the node was indexed
+    return nullptr;
+  }
+  return node;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::SetIncomingNodeClientID(vtkMRMLNode* node, int clientID)
+{
+  if (!node)
+  {
+    return;
+  }
+  IncomingNodeClientID& incomingNodeClientID = this->IncomingNodeClientIDMap[node];
+  if (incomingNodeClientID.Node != node)
+  {
+    incomingNodeClientID.Node = node;
+  }
+  incomingNodeClientID.ClientID = clientID;
+}
 
-    igtlioPolyDataDevice* polyDevice = reinterpret_cast<igtlioPolyDataDevice*>(device);
-    igtlioPolyDataConverter::ContentData content = polyDevice->GetContent();
+//----------------------------------------------------------------------------
+int vtkMRMLIGTLConnectorNode::vtkInternal::GetIncomingNodeClientID(vtkMRMLNode* node)
+{
+  IncomingNodeClientIDMapType::iterator incomingClientIDIt = this->IncomingNodeClientIDMap.find(node);
+  if (incomingClientIDIt == this->IncomingNodeClientIDMap.end() || incomingClientIDIt->second.Node != node)
+  {
+    return -1;
+  }
+  return incomingClientIDIt->second.ClientID;
+}
 
-    std::string mrmlNodeTagName = "";
-    if (device->GetMetaDataElement(MRMLNodeNameKey, mrmlNodeTagName))
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::RemoveDeletedIncomingNodeClientIDs()
+{
+  for (IncomingNodeClientIDMapType::iterator incomingClientIDIt = this->IncomingNodeClientIDMap.begin(); incomingClientIDIt != this->IncomingNodeClientIDMap.end();)
+  {
+    if (!incomingClientIDIt->second.Node)
     {
-      std::string className = this->GetScene()->GetClassNameByTag(mrmlNodeTagName.c_str());
-      vtkMRMLNode* createdNode = this->GetScene()->CreateNodeByClass(className.c_str());
-      if (createdNode)
-      {
-        modelNode = vtkMRMLModelNode::SafeDownCast(createdNode);
-      }
-      else
-      {
-        modelNode = vtkSmartPointer<vtkMRMLModelNode>::Take(vtkMRMLModelNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLModelNode")));
-      }
+      incomingClientIDIt = this->IncomingNodeClientIDMap.erase(incomingClientIDIt);
     }
     else
     {
-      modelNode = vtkSmartPointer<vtkMRMLModelNode>::Take(vtkMRMLModelNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLModelNode")));
+      ++incomingClientIDIt;
     }
-    modelNode->SetName(deviceName.c_str());
-    modelNode->SetDescription("Received by OpenIGTLink");
-    this->GetScene()->AddNode(modelNode);
-    modelNode->SetAndObservePolyData(content.polydata);
-    modelNode->CreateDefaultDisplayNodes();
-    this->RegisterIncomingMRMLNode(modelNode, device);
-    return modelNode;
   }
-  else if (strcmp(device->GetDeviceType().c_str(), "STRING") == 0)
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::CopyMetaDataToNodeAttributes(igtlioDevice* device, vtkMRMLNode* node)
+{
+  const igtl::MessageBase::MetaDataMap& metaData = device->GetMetaData();
+  for (igtl::MessageBase::MetaDataMap::const_iterator iter = metaData.begin(); iter != metaData.end(); ++iter)
   {
-    vtkSmartPointer<vtkMRMLTextNode> textNode =
-      vtkMRMLTextNode::SafeDownCast(this->GetScene()->GetFirstNode(deviceName.c_str(), "vtkMRMLTextNode"));
-    if (textNode)
+    this->MetaDataAttributeName = "OpenIGTLink.";
+    this->MetaDataAttributeName += iter->first;
+    const char* currentValue = node->GetAttribute(this->MetaDataAttributeName.c_str());
+    if (currentValue && iter->second.second.compare(currentValue) == 0)
     {
-      this->RegisterIncomingMRMLNode(textNode, device);
-      return textNode;
+      continue;
     }
+    node->SetAttribute(this->MetaDataAttributeName.c_str(), iter->second.second.c_str());
+  }
+}
 
-    igtlioStringDevice* modifiedDevice = reinterpret_cast<igtlioStringDevice*>(device);
-    textNode = vtkSmartPointer<vtkMRMLTextNode>::Take(vtkMRMLTextNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLTextNode")));
-    textNode->SetEncoding(modifiedDevice->GetContent().encoding);
-    textNode->SetText(modifiedDevice->GetContent().string_msg.c_str());
-    textNode->SetName(deviceName.c_str());
-    textNode->SetDescription("Received by OpenIGTLink");
-    this->GetScene()->AddNode(textNode);
-    this->RegisterIncomingMRMLNode(textNode, device);
-    return textNode;
+//----------------------------------------------------------------------------
+unsigned int vtkMRMLIGTLConnectorNode::vtkInternal::AssignOutgoingImage(vtkMRMLIGTLConnectorNode* vtkNotUsed(self), vtkMRMLNode* node, igtlioDevice* device)
+{
+  igtlioImageDevice* imageDevice = static_cast<igtlioImageDevice*>(device);
+  vtkMRMLVolumeNode* imageNode = vtkMRMLVolumeNode::SafeDownCast(node);
+  vtkSmartPointer<vtkMatrix4x4> mat = vtkSmartPointer<vtkMatrix4x4>::New();
+  imageNode->GetIJKToRASMatrix(mat);
+  igtlioImageConverter::ContentData content = { imageNode->GetImageData(), mat };
+  imageDevice->SetContent(content);
+  return vtkMRMLVolumeNode::ImageDataModifiedEvent;
+}
+
+//----------------------------------------------------------------------------
+unsigned int vtkMRMLIGTLConnectorNode::vtkInternal::AssignOutgoingStatus(vtkMRMLIGTLConnectorNode* vtkNotUsed(self), vtkMRMLNode* node, igtlioDevice* device)
+{
+  igtlioStatusDevice* statusDevice = static_cast<igtlioStatusDevice*>(device);
+  vtkMRMLIGTLStatusNode* statusNode = vtkMRMLIGTLStatusNode::SafeDownCast(node);
+  igtlioStatusConverter::ContentData content = { static_cast<int>(statusNode->GetCode()), static_cast<int>(statusNode->GetSubCode()), statusNode->GetErrorName(), statusNode->GetStatusString() };
+  statusDevice->SetContent(content);
+  return vtkMRMLIGTLStatusNode::StatusModifiedEvent;
+}
+
+//----------------------------------------------------------------------------
+unsigned int vtkMRMLIGTLConnectorNode::vtkInternal::AssignOutgoingTransform(vtkMRMLIGTLConnectorNode* vtkNotUsed(self), vtkMRMLNode* node, igtlioDevice* device)
+{
+  igtlioTransformDevice* transformDevice = static_cast<igtlioTransformDevice*>(device);
+  vtkSmartPointer<vtkMatrix4x4> mat = vtkSmartPointer<vtkMatrix4x4>::New();
+  vtkMRMLTransformNode* transformNode = vtkMRMLTransformNode::SafeDownCast(node);
+  transformNode->GetMatrixTransformToParent(mat);
+  igtlioTransformConverter::ContentData content = { mat, transformNode->GetName(), "", "" };
+  transformDevice->SetContent(content);
+  return vtkMRMLTransformNode::TransformModifiedEvent;
+}
+
+//----------------------------------------------------------------------------
+unsigned int vtkMRMLIGTLConnectorNode::vtkInternal::AssignOutgoingPolyData(vtkMRMLIGTLConnectorNode* vtkNotUsed(self), vtkMRMLNode* node, igtlioDevice* device)
+{
+  igtlioPolyDataDevice* polyDevice = static_cast<igtlioPolyDataDevice*>(device);
+  vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(node);
+  igtlioPolyDataConverter::ContentData content = { modelNode->GetPolyData(), modelNode->GetName() };
+  polyDevice->SetContent(content);
+  return vtkMRMLModelNode::MeshModifiedEvent;
+}
+
+//----------------------------------------------------------------------------
+unsigned int vtkMRMLIGTLConnectorNode::vtkInternal::AssignOutgoingString(vtkMRMLIGTLConnectorNode* vtkNotUsed(self), vtkMRMLNode* node, igtlioDevice* device)
+{
+  igtlioStringDevice* stringDevice = static_cast<igtlioStringDevice*>(device);
+  vtkMRMLTextNode* textNode = vtkMRMLTextNode::SafeDownCast(node);
+  std::string text = textNode->GetText();
+  igtlioStringConverter::ContentData content = { static_cast<unsigned int>(textNode->GetEncoding()), text };
+  stringDevice->SetContent(content);
+  return vtkMRMLTextNode::TextModifiedEvent;
+}
+
+//----------------------------------------------------------------------------
+unsigned int vtkMRMLIGTLConnectorNode::vtkInternal::AssignOutgoingPoint(vtkMRMLIGTLConnectorNode* self, vtkMRMLNode* node, igtlioDevice* device)
+{
+  igtlioPointDevice* pointDevice = static_cast<igtlioPointDevice*>(device);
+  vtkMRMLMarkupsFiducialNode* markupsNode = vtkMRMLMarkupsFiducialNode::SafeDownCast(node);
+  vtkMRMLMarkupsDisplayNode* displayNode = vtkMRMLMarkupsDisplayNode::SafeDownCast(markupsNode->GetDisplayNode());
+  OutgoingPointCache& cache = self->Internal->OutgoingPointCaches[node->GetID()];
+
+  // No display node, use default generic display colors
+  unsigned char selectedColor[3] = { 255, 0, 0 }; // red
+  unsigned char unselectedColor[3] = { 230, 230, 77 }; // yellow
+  if (displayNode)
+  {
+    double* color = displayNode->GetSelectedColor();
+    selectedColor[0] = int(color[0] * 255);
+    selectedColor[1] = int(color[1] * 255);
+    selectedColor[2] = int(color[2] * 255);
+    color = displayNode->GetColor();
+    unselectedColor[0] = int(color[0] * 255);
+    unselectedColor[1] = int(color[1] * 255);
+    unselectedColor[2] = int(color[2] * 255);
+  }
+
+  // All points are updated if the modified points are not known (the node is not observed by this connector),
+  // or if points have been added, removed, or reordered, or the colors have changed since the last update.
+  int numberOfControlPoints = markupsNode->GetNumberOfControlPoints();
+  bool updateAllPoints = cache.AllPointsModified
+    || !self->HasNodeReferenceID(self->GetOutgoingNodeReferenceRole(), node->GetID())
+    || static_cast<int>(cache.Content.PointElements.size()) != numberOfControlPoints
+    || memcmp(cache.SelectedColor, selectedColor, sizeof(selectedColor)) != 0
+    || memcmp(cache.UnselectedColor, unselectedColor, sizeof(unselectedColor)) != 0;
+  memcpy(cache.SelectedColor, selectedColor, sizeof(selectedColor));
+  memcpy(cache.UnselectedColor, unselectedColor, sizeof(unselectedColor));
+
+  if (updateAllPoints)
+  {
+    cache.Content.PointElements.resize(numberOfControlPoints);
+    for (int controlPointIndex = 0; controlPointIndex < numberOfControlPoints; controlPointIndex++)
+    {
+      cache.UpdatePointElement(markupsNode, controlPointIndex);
+    }
+  }
+  else
+  {
+    for (std::vector<int>::iterator indexIt = cache.ModifiedPointIndices.begin(); indexIt != cache.ModifiedPointIndices.end(); ++indexIt)
+    {
+      if (*indexIt >= 0 && *indexIt < numberOfControlPoints)
+      {
+        cache.UpdatePointElement(markupsNode, *indexIt);
+      }
+    }
+  }
+  if (cache.NumberOfHashedModifiedPoints < cache.ModifiedPointIndices.size())
+  {
+    // The content was assigned without computing the fingerprint first
+    cache.AllPointHashesModified = true;
+  }
+  cache.ModifiedPointIndices.clear();
+  cache.NumberOfHashedModifiedPoints = 0;
+  cache.AllPointsModified = false;
+
+  // The device stores a copy of the content, which is only made when the content fingerprint has changed
+  pointDevice->SetContent(cache.Content);
+  return vtkMRMLMarkupsNode::PointModifiedEvent;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::OutgoingPointCache::UpdatePointElement(vtkMRMLMarkupsNode* markupsNode, int controlPointIndex)
+{
+  const vtkMRMLMarkupsNode::ControlPoint* controlPoint = markupsNode->GetNthControlPoint(controlPointIndex);
+  igtlioPointConverter::PointElement& point = this->Content.PointElements[controlPointIndex];
+  point.Name = controlPoint->Label;
+  point.GroupName = (controlPoint->Selected ? "Selected" : "Unselected");
+  const unsigned char* color = (controlPoint->Selected ? this->SelectedColor : this->UnselectedColor);
+  point.RGBA[0] = color[0];
+  point.RGBA[1] = color[1];
+  point.RGBA[2] = color[2];
+  point.RGBA[3] = controlPoint->Visibility ? 255 : 0;
+  point.Position[0] = controlPoint->Position[0];
+  point.Position[1] = controlPoint->Position[1];
+  point.Position[2] = controlPoint->Position[2];
+  point.Radius = 0.0; // TODO: ream from measurement array
+  // point.Owner; TODO: set device name of the ower image
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::RecordOutgoingNodeModification(vtkMRMLNode* node, unsigned long event, void* callData)
+{
+  OutgoingPointCacheMapType::iterator cacheIt = this->OutgoingPointCaches.find(node->GetID());
+  if (cacheIt == this->OutgoingPointCaches.end())
+  {
+    return;
+  }
+  OutgoingPointCache& cache = cacheIt->second;
+  int* controlPointIndex = static_cast<int*>(callData);
+  if (event != vtkMRMLMarkupsNode::PointModifiedEvent || !controlPointIndex || *controlPointIndex < 0
+    || cache.ModifiedPointIndices.size() >= cache.Content.PointElements.size())
+  {
+    // Not a single point modification (points are added, removed, or reordered), or most points are modified anyway
+    cache.AllPointsModified = true;
+    cache.AllPointHashesModified = true;
+    cache.ModifiedPointIndices.clear();
+    cache.NumberOfHashedModifiedPoints = 0;
+    return;
+  }
+  if (!cache.ModifiedPointIndices.empty() && cache.ModifiedPointIndices.back() == *controlPointIndex
+    && cache.NumberOfHashedModifiedPoints < cache.ModifiedPointIndices.size())
+  {
+    // The same point is modified repeatedly (for example while it is dragged)
+    return;
+  }
+  cache.ModifiedPointIndices.push_back(*controlPointIndex);
+}
+
+//----------------------------------------------------------------------------
+unsigned int vtkMRMLIGTLConnectorNode::vtkInternal::AssignOutgoingTrackingData(vtkMRMLIGTLConnectorNode* self, vtkMRMLNode* node, igtlioDevice* device)
+{
+  igtlioTrackingDataDevice* tdataDevice = static_cast<igtlioTrackingDataDevice*>(device);
+  vtkMRMLIGTLTrackingDataBundleNode* tBundleNode = vtkMRMLIGTLTrackingDataBundleNode::SafeDownCast(node);
+  OutgoingTrackingDataCacheMapType::iterator cacheIt = self->Internal->OutgoingTrackingDataCaches.find(node->GetID());
+  if (cacheIt == self->Internal->OutgoingTrackingDataCaches.end())
+  {
+    // Elements that are already in the device are kept
+    cacheIt = self->Internal->OutgoingTrackingDataCaches.insert(std::make_pair(std::string(node->GetID()), OutgoingTrackingDataCache())).first;
+    cacheIt->second.Content = tdataDevice->GetContent();
+    for (auto iter = cacheIt->second.Content.trackingDataElements.begin(); iter != cacheIt->second.Content.trackingDataElements.end(); ++iter)
+    {
+      cacheIt->second.ElementIndices[iter->second.deviceName] = iter->first;
+    }
+  }
+  OutgoingTrackingDataCache& cache = cacheIt->second;
+
+  if (tBundleNode)
+  {
+    tBundleNode->GetTransformNodes(cache.TransformNodes);
+    for (std::vector<vtkMRMLLinearTransformNode*>::iterator transformNodeIt = cache.TransformNodes.begin(); transformNodeIt != cache.TransformNodes.end(); ++transformNodeIt)
+    {
+      vtkMRMLLinearTransformNode* transformNode = *transformNodeIt;
+      OutgoingTrackingDataCache::TransformState& state = cache.TransformStates[transformNode];
+      if (state.Node != transformNode || !state.Matrix || state.Name != transformNode->GetName())
+      {
+        // New transform in the bundle (or a new transform node that has the address of a deleted one), or a renamed transform
+        if (state.Matrix)
+        {
+          cache.RemoveElement(state.Name);
+        }
+        state.Node = transformNode;
+        state.Name = transformNode->GetName();
+        state.Matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+        state.ModifiedTime = 0;
+        std::map<std::string, int>::iterator indexIt = cache.ElementIndices.find(transformNode->GetName());
+        if (indexIt != cache.ElementIndices.end())
+        {
+          // already exists, update transform
+          cache.Content.trackingDataElements[indexIt->second].transform = state.Matrix;
+        }
+        else
+        {
+          // Indices of removed elements are not reused, so the new element is added after the last one
+          int elementIndex = (cache.Content.trackingDataElements.empty() ? 0 : cache.Content.trackingDataElements.rbegin()->first + 1);
+          cache.ElementIndices[transformNode->GetName()] = elementIndex;
+          cache.Content.trackingDataElements[elementIndex] = igtlioTrackingDataConverter::ContentEntry(state.Matrix, transformNode->GetName(), transformNode->GetName());
+        }
+      }
+
+      // The matrix is only recomputed if the transform has been modified since the last update
+      vtkMTimeType modifiedTime = transformNode->GetMTime();
+      if (transformNode->GetTransformToParent() && transformNode->GetTransformToParent()->GetMTime() > modifiedTime)
+      {
+        modifiedTime = transformNode->GetTransformToParent()->GetMTime();
+      }
+      if (modifiedTime != state.ModifiedTime)
+      {
+        transformNode->GetMatrixTransformToParent(state.Matrix);
+        state.ModifiedTime = modifiedTime;
+      }
+    }
+
+    if (cache.TransformStates.size() > cache.TransformNodes.size())
+    {
+      // Transforms have been removed from the bundle
+      std::unordered_set<vtkMRMLLinearTransformNode*> transformNodes(cache.TransformNodes.begin(), cache.TransformNodes.end());
+      for (auto stateIt = cache.TransformStates.begin(); stateIt != cache.TransformStates.end();)
+      {
+        if (transformNodes.count(stateIt->first))
+        {
+          ++stateIt;
+          continue;
+        }
+        cache.RemoveElement(stateIt->second.Name);
+        stateIt = cache.TransformStates.erase(stateIt);
+      }
+    }
+  }
+
+  tdataDevice->SetContent(cache.Content);
+  return vtkCommand::ModifiedEvent;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::OutgoingTrackingDataCache::RemoveElement(const std::string& name)
+{
+  std::map<std::string, int>::iterator indexIt = this->ElementIndices.find(name);
+  if (indexIt == this->ElementIndices.end())
+  {
+    return;
+  }
+  this->Content.trackingDataElements.erase(indexIt->second);
+  this->ElementIndices.erase(indexIt);
+}
+
+#if defined(OpenIGTLink_ENABLE_VIDEOSTREAMING)
+//----------------------------------------------------------------------------
+unsigned int vtkMRMLIGTLConnectorNode::vtkInternal::AssignOutgoingVideo(vtkMRMLIGTLConnectorNode* vtkNotUsed(self), vtkMRMLNode* node, igtlioDevice* device)
+{
+  igtlioVideoDevice* videoDevice = static_cast<igtlioVideoDevice*>(device);
+  vtkMRMLStreamingVolumeNode* streamingVolumeNode = vtkMRMLStreamingVolumeNode::SafeDownCast(node);
+  igtlioVideoConverter::ContentData content;
+  content.image = streamingVolumeNode->GetImageData();
+  content.frameType = FrameTypeUnKnown;
+  strncpy(content.codecName, videoDevice->GetCurrentCodecType().c_str(), IGTL_VIDEO_CODEC_NAME_SIZE);
+  content.keyFrameMessage = NULL;
+  content.keyFrameUpdated = false;
+  content.videoMessage = NULL;
+  videoDevice->SetContent(content);
+  return vtkCommand::ModifiedEvent;
+}
+#endif
+
+//----------------------------------------------------------------------------
+vtkTypeUInt64 vtkMRMLIGTLConnectorNode::vtkInternal::HashBytes(vtkTypeUInt64 hash, const void* data, size_t size)
+{
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+//----------------------------------------------------------------------------
+vtkTypeUInt64 vtkMRMLIGTLConnectorNode::vtkInternal::HashString(vtkTypeUInt64 hash, const char* text)
+{
+  if (!text)
+  {
+    text = "";
+  }
+  return HashBytes(hash, text, strlen(text) + 1);
+}
+
+//----------------------------------------------------------------------------
+// Node attributes (such as the status that is sent in the message metadata) modify the node,
+// therefore the node modified time is part of the fingerprint of all node types that are not hashed.
+vtkTypeUInt64 vtkMRMLIGTLConnectorNode::vtkInternal::GetOutgoingImageFingerprint(vtkMRMLIGTLConnectorNode* vtkNotUsed(self), vtkMRMLNode* node)
+{
+  vtkMRMLVolumeNode* volumeNode = vtkMRMLVolumeNode::SafeDownCast(node);
+  if (!volumeNode)
+  {
+    return 0;
+  }
+  vtkMTimeType modifiedTime = volumeNode->GetMTime();
+  if (volumeNode->GetImageData() && volumeNode->GetImageData()->GetMTime() > modifiedTime)
+  {
+    modifiedTime = volumeNode->GetImageData()->GetMTime();
+  }
+  return modifiedTime;
+}
+
+//----------------------------------------------------------------------------
+vtkTypeUInt64 vtkMRMLIGTLConnectorNode::vtkInternal::GetOutgoingTransformFingerprint(vtkMRMLIGTLConnectorNode* vtkNotUsed(self), vtkMRMLNode* node)
+{
+  vtkMRMLTransformNode* transformNode = vtkMRMLTransformNode::SafeDownCast(node);
+  if (!transformNode)
+  {
+    return 0;
+  }
+  vtkMTimeType modifiedTime = transformNode->GetMTime();
+  if (transformNode->GetTransformToParent() && transformNode->GetTransformToParent()->GetMTime() > modifiedTime)
+  {
+    modifiedTime = transformNode->GetTransformToParent()->GetMTime();
+  }
+  return modifiedTime;
+}
+
+//----------------------------------------------------------------------------
+vtkTypeUInt64 vtkMRMLIGTLConnectorNode::vtkInternal::GetOutgoingPolyDataFingerprint(vtkMRMLIGTLConnectorNode* vtkNotUsed(self), vtkMRMLNode* node)
+{
+  vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(node);
+  if (!modelNode)
+  {
+    return 0;
+  }
+  vtkMTimeType modifiedTime = modelNode->GetMTime();
+  if (modelNode->GetPolyData() && modelNode->GetPolyData()->GetMTime() > modifiedTime)
+  {
+    modifiedTime = modelNode->GetPolyData()->GetMTime();
+  }
+  return modifiedTime;
+}
+
+//----------------------------------------------------------------------------
+// Text and markups nodes are modified by changes that are not sent (such as display or lock state),
+// therefore the sent content is hashed instead.
+vtkTypeUInt64 vtkMRMLIGTLConnectorNode::vtkInternal::GetOutgoingStringFingerprint(vtkMRMLIGTLConnectorNode* vtkNotUsed(self), vtkMRMLNode* node)
+{
+  vtkMRMLTextNode* textNode = vtkMRMLTextNode::SafeDownCast(node);
+  if (!textNode)
+  {
+    return 0;
+  }
+  vtkTypeUInt64 hash = 14695981039346656037ULL;
+  int encoding = textNode->GetEncoding();
+  hash = HashBytes(hash, &encoding, sizeof(encoding));
+  hash = HashString(hash, textNode->GetText());
+  hash = HashString(hash, textNode->GetAttribute("Status"));
+  return hash;
+}
+
+//----------------------------------------------------------------------------
+vtkTypeUInt64 vtkMRMLIGTLConnectorNode::vtkInternal::GetOutgoingPointFingerprint(vtkMRMLIGTLConnectorNode* self, vtkMRMLNode* node)
+{
+  vtkMRMLMarkupsNode* markupsNode = vtkMRMLMarkupsNode::SafeDownCast(node);
+  if (!markupsNode)
+  {
+    return 0;
+  }
+  OutgoingPointCache& cache = self->Internal->OutgoingPointCaches[node->GetID()];
+
+  // Only the points that have been modified since the last fingerprint are hashed again,
+  // unless the modified points are not known (the node is not observed by this connector).
+  int numberOfControlPoints = markupsNode->GetNumberOfControlPoints();
+  if (cache.AllPointHashesModified
+    || !self->HasNodeReferenceID(self->GetOutgoingNodeReferenceRole(), node->GetID())
+    || static_cast<int>(cache.PointHashes.size()) != numberOfControlPoints)
+  {
+    cache.PointHashes.assign(numberOfControlPoints, 0);
+    cache.PointsHash = 0;
+    for (int controlPointIndex = 0; controlPointIndex < numberOfControlPoints; controlPointIndex++)
+    {
+      cache.UpdatePointHash(markupsNode, controlPointIndex);
+    }
+    cache.AllPointHashesModified = false;
+  }
+  else
+  {
+    for (size_t i = cache.NumberOfHashedModifiedPoints; i < cache.ModifiedPointIndices.size(); ++i)
+    {
+      int controlPointIndex = cache.ModifiedPointIndices[i];
+      if (controlPointIndex >= 0 && controlPointIndex < numberOfControlPoints)
+      {
+        cache.UpdatePointHash(markupsNode, controlPointIndex);
+      }
+    }
+  }
+  cache.NumberOfHashedModifiedPoints = cache.ModifiedPointIndices.size();
+
+  vtkTypeUInt64 hash = 14695981039346656037ULL;
+  vtkMRMLMarkupsDisplayNode* displayNode = vtkMRMLMarkupsDisplayNode::SafeDownCast(markupsNode->GetDisplayNode());
+  if (displayNode)
+  {
+    hash = HashBytes(hash, displayNode->GetSelectedColor(), 3 * sizeof(double));
+    hash = HashBytes(hash, displayNode->GetColor(), 3 * sizeof(double));
+  }
+  hash = HashBytes(hash, &numberOfControlPoints, sizeof(numberOfControlPoints));
+  hash = HashBytes(hash, &cache.PointsHash, sizeof(cache.PointsHash));
+  hash = HashString(hash, markupsNode->GetAttribute("Status"));
+  return hash;
+}
+
+//----------------------------------------------------------------------------
+// The hash of all points is the sum of the point hashes, so that a modified point is updated
+// by replacing its term. The point index is part of the term to detect reordered points.
+void vtkMRMLIGTLConnectorNode::vtkInternal::OutgoingPointCache::UpdatePointHash(vtkMRMLMarkupsNode* markupsNode, int controlPointIndex)
+{
+  const vtkMRMLMarkupsNode::ControlPoint* controlPoint = markupsNode->GetNthControlPoint(controlPointIndex);
+  vtkTypeUInt64 hash = 14695981039346656037ULL;
+  hash = HashBytes(hash, &controlPointIndex, sizeof(controlPointIndex));
+  hash = HashString(hash, controlPoint->Label.c_str());
+  hash = HashBytes(hash, controlPoint->Position, sizeof(controlPoint->Position));
+  unsigned char flags[2] = { controlPoint->Selected ? 1 : 0, controlPoint->Visibility ? 1 : 0 };
+  hash = HashBytes(hash, flags, sizeof(flags));
+  this->PointsHash += hash - this->PointHashes[controlPointIndex];
+  this->PointHashes[controlPointIndex] = hash;
+}
+
+//----------------------------------------------------------------------------
+unsigned int vtkMRMLIGTLConnectorNode::AssignOutGoingNodeToDevice(vtkMRMLNode* node, igtlioDevicePointer device)
+{
+  this->Internal->OutgoingMRMLIDToDeviceMap[node->GetID()] = device;
+  const DeviceTypeHandler* handler = this->Internal->GetDeviceTypeHandler(device);
+  if (!handler || !handler->AssignOutgoing)
+  {
+    // Device type cannot be sent (for example COMMAND devices are processed separately)
+    return 0;
+  }
+  return handler->AssignOutgoing(this, node, device);
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::ProcessNewDeviceEvent(
+  vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(event), void* vtkNotUsed(callData))
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::ProcessOutgoingDeviceModifiedEvent(
+  vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(event), igtlioDevice* modifiedDevice)
+{
+  this->SendOutgoingMessage(igtlioDeviceKeyType::CreateDeviceKey(modifiedDevice), modifiedDevice->MESSAGE_PREFIX_NOT_DEFINED);
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLIGTLConnectorNode::vtkInternal::SendOutgoingMessage(const igtlioDeviceKeyType& key, igtlioDevice::MESSAGE_PREFIX prefix, int clientID)
+{
+  this->NumberOfPackedOutgoingMessages++;
+  std::vector<std::unique_lock<std::recursive_mutex> > socketLocks = this->LockClientSockets(clientID);
+  return this->IOConnector->SendMessage(key, prefix, clientID);
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLIGTLConnectorNode::vtkInternal::SendOutgoingMessageToClients(igtlioDevice* device, igtlioDevice::MESSAGE_PREFIX prefix, const std::vector<int>& clientIDs)
+{
+  igtl::MessageBase::Pointer packedMessage = device->GetIGTLMessage(prefix);
+  this->NumberOfPackedOutgoingMessages++;
+  if (!packedMessage)
+  {
+    return 0;
+  }
+  int numberOfSentMessages = 0;
+  for (std::vector<int>::const_iterator clientIDIt = clientIDs.begin(); clientIDIt != clientIDs.end(); ++clientIDIt)
+  {
+    std::vector<std::unique_lock<std::recursive_mutex> > socketLocks = this->LockClientSockets(*clientIDIt);
+    if (this->IOConnector->SendData(packedMessage->GetPackSize(), static_cast<unsigned char*>(packedMessage->GetPackPointer()), *clientIDIt))
+    {
+      ++numberOfSentMessages;
+    }
+  }
+  return numberOfSentMessages;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::PushModifiedOutgoingNode(vtkMRMLNode* node)
+{
+  double maximumSendRate = vtkMRMLIGTLConnectorNode::GetOutgoingNodeMaximumSendRate(node);
+  if (maximumSendRate <= 0.0)
+  {
+    this->External->PushNode(node);
+    return;
+  }
+  OutgoingRateLimitState& state = this->OutgoingRateLimitStates[node->GetID()];
+  double currentTime = vtkTimerLog::GetUniversalTime();
+  if (currentTime - state.LastPushTime >= 1.0 / maximumSendRate)
+  {
+    state.LastPushTime = currentTime;
+    state.PushPending = false;
+    this->External->PushNode(node);
+  }
+  else
+  {
+    // Modifications are coalesced, the latest state is sent when the interval elapsed
+    if (!state.PushPending)
+    {
+      state.PushPending = true;
+      // Processing is rescheduled for the deferred push
+      this->RequestProcessing();
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::PushPendingRateLimitedNodes()
+{
+  vtkMRMLScene* scene = this->External->GetScene();
+  if (!scene)
+  {
+    return;
+  }
+  double currentTime = vtkTimerLog::GetUniversalTime();
+  for (OutgoingRateLimitStateMapType::iterator stateIt = this->OutgoingRateLimitStates.begin(); stateIt != this->OutgoingRateLimitStates.end(); ++stateIt)
+  {
+    OutgoingRateLimitState& state = stateIt->second;
+    if (!state.PushPending)
+    {
+      continue;
+    }
+    vtkMRMLNode* node = scene->GetNodeByID(stateIt->first);
+    if (!node)
+    {
+      state.PushPending = false;
+      continue;
+    }
+    double maximumSendRate = vtkMRMLIGTLConnectorNode::GetOutgoingNodeMaximumSendRate(node);
+    if (maximumSendRate > 0.0 && currentTime - state.LastPushTime < 1.0 / maximumSendRate)
+    {
+      continue;
+    }
+    state.LastPushTime = currentTime;
+    state.PushPending = false;
+    this->External->PushNode(node);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::StartSenderThreads()
+{
+  this->SenderThreadsEnabled = true;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::StopSenderThreads()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->OutgoingQueueMutex);
+    this->SenderThreadsEnabled = false;
+    for (OutgoingQueueMapType::iterator queueIt = this->OutgoingQueues.begin(); queueIt != this->OutgoingQueues.end(); ++queueIt)
+    {
+      queueIt->second->SenderThreadRunning = false;
+      queueIt->second->WakeUp.notify_all();
+    }
+  }
+  this->OutgoingQueueSpaceAvailable.notify_all();
+  for (OutgoingQueueMapType::iterator queueIt = this->OutgoingQueues.begin(); queueIt != this->OutgoingQueues.end(); ++queueIt)
+  {
+    if (queueIt->second->SenderThread.joinable())
+    {
+      queueIt->second->SenderThread.join();
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::SenderThreadFunction(int clientID, OutgoingClientQueue* queue)
+{
+  std::unique_lock<std::mutex> lock(this->OutgoingQueueMutex);
+  while (queue->SenderThreadRunning)
+  {
+    if (queue->Messages.empty())
+    {
+      queue->WakeUp.wait(lock);
+      continue;
+    }
+    OutgoingMessageBufferPointer message = queue->Messages.front();
+    queue->Messages.pop_front();
+    queue->Size -= static_cast<vtkIdType>(message->size());
+    lock.unlock();
+    this->OutgoingQueueSpaceAvailable.notify_all();
+    {
+      // Only the socket of this client is locked while writing
+      std::lock_guard<std::recursive_mutex> socketLock(queue->SocketMutex);
+      if (!this->IOConnector->SendData(static_cast<int>(message->size()), const_cast<unsigned char*>(message->data()), clientID))
+      {
+        // The client may have disconnected, its queue is removed in PeriodicProcess()
+        this->RequestProcessing();
+      }
+    }
+    lock.lock();
+  }
+}
+
+//----------------------------------------------------------------------------
+std::vector<std::unique_lock<std::recursive_mutex> > vtkMRMLIGTLConnectorNode::vtkInternal::LockClientSockets(int clientID)
+{
+  std::vector<OutgoingClientQueue*> queues;
+  {
+    std::lock_guard<std::mutex> lock(this->OutgoingQueueMutex);
+    for (OutgoingQueueMapType::iterator queueIt = this->OutgoingQueues.begin(); queueIt != this->OutgoingQueues.end(); ++queueIt)
+    {
+      if (clientID < 0 || queueIt->first == clientID)
+      {
+        queues.push_back(queueIt->second.get());
+      }
+    }
+  }
+  // Sending threads lock only their own socket, so the sockets can be locked one after the other
+  std::vector<std::unique_lock<std::recursive_mutex> > socketLocks;
+  for (std::vector<OutgoingClientQueue*>::iterator queueIt = queues.begin(); queueIt != queues.end(); ++queueIt)
+  {
+    socketLocks.emplace_back((*queueIt)->SocketMutex);
+  }
+  return socketLocks;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::QueueOutgoingDevice(igtlioDevice* device, const std::vector<int>& clientIDs, int skippedClientID)
+{
+  igtl::MessageBase::Pointer packedMessage = device->GetIGTLMessage(igtlioDevice::MESSAGE_PREFIX_NOT_DEFINED);
+  this->NumberOfPackedOutgoingMessages++;
+  if (!packedMessage)
+  {
+    return;
+  }
+  // The device reuses its message for the next push, so the packed message is copied to a buffer that is shared by all queues
+  OutgoingMessageBufferPointer message = this->GetOutgoingMessageBuffer(
+    static_cast<const unsigned char*>(packedMessage->GetPackPointer()), packedMessage->GetPackSize());
+  for (std::vector<int>::const_iterator clientIDIt = clientIDs.begin(); clientIDIt != clientIDs.end(); ++clientIDIt)
+  {
+    if (*clientIDIt == skippedClientID)
+    {
+      continue;
+    }
+    this->QueueOutgoingMessage(*clientIDIt, message);
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLIGTLConnectorNode::vtkInternal::OutgoingMessageBufferPointer vtkMRMLIGTLConnectorNode::vtkInternal::GetOutgoingMessageBuffer(const unsigned char* data, size_t size)
+{
+  // Enough for the messages that are being sent while the next ones are packed
+  const size_t maximumNumberOfPooledBuffers = 8;
+
+  std::unique_ptr<std::vector<unsigned char> > buffer;
+  {
+    std::lock_guard<std::mutex> lock(this->OutgoingMessageBuffers->Mutex);
+    if (!this->OutgoingMessageBuffers->Buffers.empty())
+    {
+      buffer = std::move(this->OutgoingMessageBuffers->Buffers.back());
+      this->OutgoingMessageBuffers->Buffers.pop_back();
+    }
+  }
+  if (!buffer)
+  {
+    buffer.reset(new std::vector<unsigned char>);
+  }
+  buffer->assign(data, data + size);
+
+  std::weak_ptr<OutgoingMessageBufferPool> weakPool = this->OutgoingMessageBuffers;
+  return OutgoingMessageBufferPointer(buffer.release(), [weakPool, maximumNumberOfPooledBuffers](const std::vector<unsigned char>* releasedBuffer)
+    {
+      std::unique_ptr<std::vector<unsigned char> > ownedBuffer(const_cast<std::vector<unsigned char>*>(releasedBuffer));
+      std::shared_ptr<OutgoingMessageBufferPool> pool = weakPool.lock();
+      if (!pool)
+      {
+        return;
+      }
+      std::lock_guard<std::mutex> lock(pool->Mutex);
+      if (pool->Buffers.size() < maximumNumberOfPooledBuffers)
+      {
+        pool->Buffers.push_back(std::move(ownedBuffer));
+      }
+    });
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::QueueOutgoingMessage(int clientID, const OutgoingMessageBufferPointer& message)
+{
+  std::unique_lock<std::mutex> lock(this->OutgoingQueueMutex);
+  std::unique_ptr<OutgoingClientQueue>& queuePointer = this->OutgoingQueues[clientID];
+  if (!queuePointer)
+  {
+    queuePointer.reset(new OutgoingClientQueue);
+  }
+  OutgoingClientQueue& queue = *queuePointer;
+  if (this->SenderThreadsEnabled && !queue.SenderThread.joinable())
+  {
+    queue.SenderThreadRunning = true;
+    queue.SenderThread = std::thread(&vtkInternal::SenderThreadFunction, this, clientID, &queue);
+  }
+  vtkIdType messageSize = static_cast<vtkIdType>(message->size());
+  // A message that is larger than the budget is still sent if the queue is empty
+  while (this->OutgoingQueueByteBudget > 0 && !queue.Messages.empty() && queue.Size + messageSize > this->OutgoingQueueByteBudget)
+  {
+    if (this->OutgoingQueueDropPolicy == vtkMRMLIGTLConnectorNode::OutgoingQueueDropNewest)
+    {
+      this->NumberOfDroppedOutgoingMessages++;
+      return;
+    }
+    else if (this->OutgoingQueueDropPolicy == vtkMRMLIGTLConnectorNode::OutgoingQueueDropOldest)
+    {
+      queue.Size -= static_cast<vtkIdType>(queue.Messages.front()->size());
+      queue.Messages.pop_front();
+      this->NumberOfDroppedOutgoingMessages++;
+    }
+    else
+    {
+      if (!queue.SenderThreadRunning)
+      {
+        break;
+      }
+      // The queue is only removed by the main thread, which is waiting here
+      this->OutgoingQueueSpaceAvailable.wait(lock);
+    }
+  }
+  queue.Messages.push_back(message);
+  queue.Size += messageSize;
+  lock.unlock();
+  queue.WakeUp.notify_one();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::FlushOutgoingQueues()
+{
+  OutgoingQueueMapType queues;
+  {
+    std::lock_guard<std::mutex> lock(this->OutgoingQueueMutex);
+    queues.swap(this->OutgoingQueues);
+  }
+  for (OutgoingQueueMapType::iterator queueIt = queues.begin(); queueIt != queues.end(); ++queueIt)
+  {
+    for (std::deque<OutgoingMessageBufferPointer>::iterator messageIt = queueIt->second->Messages.begin(); messageIt != queueIt->second->Messages.end(); ++messageIt)
+    {
+      this->IOConnector->SendData(static_cast<int>((*messageIt)->size()), const_cast<unsigned char*>((*messageIt)->data()), queueIt->first);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::RemoveDisconnectedOutgoingQueues()
+{
+  std::vector<int> clientIDs = this->IOConnector->GetClientIds();
+  std::vector<std::unique_ptr<OutgoingClientQueue> > removedQueues;
+  {
+    std::lock_guard<std::mutex> lock(this->OutgoingQueueMutex);
+    for (OutgoingQueueMapType::iterator queueIt = this->OutgoingQueues.begin(); queueIt != this->OutgoingQueues.end();)
+    {
+      if (std::find(clientIDs.begin(), clientIDs.end(), queueIt->first) == clientIDs.end())
+      {
+        queueIt->second->SenderThreadRunning = false;
+        queueIt->second->WakeUp.notify_all();
+        removedQueues.push_back(std::move(queueIt->second));
+        queueIt = this->OutgoingQueues.erase(queueIt);
+      }
+      else
+      {
+        ++queueIt;
+      }
+    }
+  }
+  this->OutgoingQueueSpaceAvailable.notify_all();
+  for (std::vector<std::unique_ptr<OutgoingClientQueue> >::iterator queueIt = removedQueues.begin(); queueIt != removedQueues.end(); ++queueIt)
+  {
+    if ((*queueIt)->SenderThread.joinable())
+    {
+      (*queueIt)->SenderThread.join();
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+std::string vtkMRMLIGTLConnectorNode::vtkInternal::GetIncomingNodeName(igtlioDevice* device)
+{
+  std::string deviceName = device->GetDeviceName();
+  // Device name is empty, we will not be able to find a node in the scene
+  if (deviceName.empty())
+  {
+    deviceName = "OpenIGTLink";
+  }
+  return deviceName;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLNode* vtkMRMLIGTLConnectorNode::vtkInternal::CreateIncomingImageNode(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device)
+{
+  vtkMRMLScene* scene = self->GetScene();
+  const std::string deviceName = vtkInternal::GetIncomingNodeName(device);
+
+  vtkSmartPointer<vtkMRMLVolumeNode> volumeNode;
+  int numberOfComponents = 1;
+  vtkSmartPointer<vtkImageData> image;
+  igtlioImageDevice* imageDevice = reinterpret_cast<igtlioImageDevice*>(device);
+  igtlioImageConverter::ContentData content = imageDevice->GetContent();
+  if (!content.image)
+  {
+    // Image data has not been set yet
+    return nullptr;
+  }
+  numberOfComponents = content.image->GetNumberOfScalarComponents(); //to improve the io module to be able to cope with video data
+  image = content.image;
+#if defined(OpenIGTLink_ENABLE_VIDEOSTREAMING)
+  if (self->UseStreamingVolume)
+  {
+    volumeNode = vtkMRMLStreamingVolumeNode::SafeDownCast(scene->GetFirstNode(deviceName.c_str(), "vtkMRMLStreamingVolumeNode"));
+    if (volumeNode)
+    {
+      return volumeNode;
+    }
+    volumeNode = vtkSmartPointer<vtkMRMLVolumeNode>::Take(vtkMRMLVolumeNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLStreamingVolumeNode")));
+  }
+  else
+  {
+    if (numberOfComponents > 1)
+    {
+      volumeNode = vtkMRMLVectorVolumeNode::SafeDownCast(scene->GetFirstNode(deviceName.c_str(), "vtkMRMLVectorVolumeNode"));
+      if (volumeNode)
+      {
+        return volumeNode;
+      }
+      volumeNode = vtkSmartPointer<vtkMRMLVolumeNode>::Take(vtkMRMLVolumeNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLVectorVolumeNode")));
+    }
+    else
+    {
+      volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(scene->GetFirstNode(deviceName.c_str(), "vtkMRMLScalarVolumeNode"));
+      if (volumeNode)
+      {
+        return volumeNode;
+      }
+      volumeNode = vtkSmartPointer<vtkMRMLVolumeNode>::Take(vtkMRMLVolumeNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLScalarVolumeNode")));
+    }
+  }
+#else
+  if (numberOfComponents > 1)
+  {
+    volumeNode = vtkMRMLVectorVolumeNode::SafeDownCast(scene->GetFirstNode(deviceName.c_str(), "vtkMRMLVectorVolumeNode"));
+    if (volumeNode)
+    {
+      return volumeNode;
+    }
+    volumeNode = vtkSmartPointer<vtkMRMLVolumeNode>::Take(vtkMRMLVolumeNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLVectorVolumeNode")));
+  }
+  else
+  {
+    volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(scene->GetFirstNode(deviceName.c_str(), "vtkMRMLScalarVolumeNode"));
+    if (volumeNode)
+    {
+      return volumeNode;
+    }
+    volumeNode = vtkSmartPointer<vtkMRMLVolumeNode>::Take(vtkMRMLVolumeNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLScalarVolumeNode")));
+  }
+#endif
+  volumeNode->SetIJKToRASMatrix(content.transform);
+  volumeNode->SetAndObserveImageData(image);
+  volumeNode->SetName(deviceName.c_str());
+  scene->SaveStateForUndo();
+  volumeNode->SetDescription("Received by OpenIGTLink");
+  vtkDebugWithObjectMacro(self, "Name vol node " << volumeNode->GetClassName());
+  scene->AddNode(volumeNode);
+
+  vtkDebugWithObjectMacro(self, "Set basic display info");
+  bool scalarDisplayNodeRequired = (numberOfComponents == 1);
+  vtkSmartPointer<vtkMRMLVolumeDisplayNode> displayNode;
+  if (scalarDisplayNodeRequired)
+  {
+    displayNode = vtkSmartPointer<vtkMRMLScalarVolumeDisplayNode>::Take(vtkMRMLScalarVolumeDisplayNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLScalarVolumeDisplayNode")));
+  }
+  else
+  {
+    displayNode = vtkSmartPointer<vtkMRMLVectorVolumeDisplayNode>::Take(vtkMRMLVectorVolumeDisplayNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLVectorVolumeDisplayNode")));
+  }
+
+  scene->AddNode(displayNode);
+
+  if (scalarDisplayNodeRequired)
+  {
+    const char* colorTableId = vtkMRMLColorLogic::GetColorTableNodeID(vtkMRMLColorTableNode::Grey);
+    displayNode->SetAndObserveColorNodeID(colorTableId);
+  }
+  else
+  {
+    displayNode->SetDefaultColorMap();
+  }
+
+  volumeNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+  return volumeNode;
+}
+
+#if defined(OpenIGTLink_ENABLE_VIDEOSTREAMING)
+//----------------------------------------------------------------------------
+vtkMRMLNode* vtkMRMLIGTLConnectorNode::vtkInternal::CreateIncomingVideoNode(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device)
+{
+  vtkMRMLScene* scene = self->GetScene();
+  const std::string deviceName = vtkInternal::GetIncomingNodeName(device);
+
+  igtlioVideoDevice* videoDevice = reinterpret_cast<igtlioVideoDevice*>(device);
+  igtlioVideoConverter::ContentData content = videoDevice->GetContent();
+  if (!content.frameData)
+  {
+    // frame data has not been set yet
+    return nullptr;
+  }
+  int numberOfComponents = content.grayscale ? 1 : 3;
+
+  vtkSmartPointer<vtkMRMLStreamingVolumeNode> streamingVolumeNode =
+    vtkMRMLStreamingVolumeNode::SafeDownCast(scene->GetFirstNode(deviceName.c_str(), "vtkMRMLStreamingVolumeNode"));
+  if (streamingVolumeNode)
+  {
+    return streamingVolumeNode;
+  }
+
+  scene->SaveStateForUndo();
+  bool scalarDisplayNodeRequired = (numberOfComponents == 1);
+  streamingVolumeNode = vtkSmartPointer<vtkMRMLStreamingVolumeNode>::Take(vtkMRMLStreamingVolumeNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLStreamingVolumeNode")));
+  streamingVolumeNode->SetName(deviceName.c_str());
+  streamingVolumeNode->SetDescription("Received by OpenIGTLink");
+  scene->AddNode(streamingVolumeNode);
+  vtkSmartPointer<vtkMRMLVolumeDisplayNode> displayNode;
+  if (scalarDisplayNodeRequired)
+  {
+    displayNode = vtkSmartPointer<vtkMRMLScalarVolumeDisplayNode>::Take(vtkMRMLScalarVolumeDisplayNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLScalarVolumeDisplayNode")));
+  }
+  else
+  {
+    displayNode = vtkSmartPointer<vtkMRMLVectorVolumeDisplayNode>::Take(vtkMRMLVectorVolumeDisplayNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLVectorVolumeDisplayNode")));
+  }
+  scene->AddNode(displayNode);
+  if (scalarDisplayNodeRequired)
+  {
+    const char* colorTableId = vtkMRMLColorLogic::GetColorTableNodeID(vtkMRMLColorTableNode::Grey);
+    displayNode->SetAndObserveColorNodeID(colorTableId);
+  }
+  else
+  {
+    displayNode->SetDefaultColorMap();
+  }
+  streamingVolumeNode->SetAndObserveDisplayNodeID(displayNode->GetID());
+  return streamingVolumeNode;
+}
+#endif
+
+//----------------------------------------------------------------------------
+vtkMRMLNode* vtkMRMLIGTLConnectorNode::vtkInternal::CreateIncomingStatusNode(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device)
+{
+  vtkMRMLScene* scene = self->GetScene();
+  const std::string deviceName = vtkInternal::GetIncomingNodeName(device);
+
+  vtkSmartPointer<vtkMRMLIGTLStatusNode> statusNode =
+    vtkMRMLIGTLStatusNode::SafeDownCast(scene->GetFirstNode(deviceName.c_str(), "vtkMRMLIGTLStatusNode"));
+  if (statusNode)
+  {
+    return statusNode;
+  }
+
+  statusNode = vtkSmartPointer<vtkMRMLIGTLStatusNode>::Take(vtkMRMLIGTLStatusNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLIGTLStatusNode")));
+  statusNode->SetName(deviceName.c_str());
+  statusNode->SetDescription("Received by OpenIGTLink");
+  scene->AddNode(statusNode);
+  return statusNode;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLNode* vtkMRMLIGTLConnectorNode::vtkInternal::CreateIncomingTransformNode(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device)
+{
+  vtkMRMLScene* scene = self->GetScene();
+  const std::string deviceName = vtkInternal::GetIncomingNodeName(device);
+
+  vtkSmartPointer<vtkMRMLTransformNode> transformNode =
+    vtkMRMLTransformNode::SafeDownCast(scene->GetFirstNode(deviceName.c_str(), "vtkMRMLTransformNode"));
+  if (transformNode)
+  {
+    return transformNode;
+  }
+
+  transformNode = vtkSmartPointer<vtkMRMLLinearTransformNode>::Take(vtkMRMLLinearTransformNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLLinearTransformNode")));
+  transformNode->SetName(deviceName.c_str());
+  transformNode->SetDescription("Received by OpenIGTLink");
+  vtkSmartPointer<vtkMatrix4x4> transform = vtkSmartPointer<vtkMatrix4x4>::New();
+  transformNode->SetMatrixTransformToParent(transform);
+  scene->AddNode(transformNode);
+  return transformNode;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLNode* vtkMRMLIGTLConnectorNode::vtkInternal::CreateIncomingPolyDataNode(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device)
+{
+  vtkMRMLScene* scene = self->GetScene();
+  const std::string deviceName = vtkInternal::GetIncomingNodeName(device);
+
+  vtkSmartPointer<vtkMRMLModelNode> modelNode =
+    vtkMRMLModelNode::SafeDownCast(scene->GetFirstNode(deviceName.c_str(), "vtkMRMLModelNode"));
+  if (modelNode)
+  {
+    return modelNode;
+  }
+
+  igtlioPolyDataDevice* polyDevice = reinterpret_cast<igtlioPolyDataDevice*>(device);
+  igtlioPolyDataConverter::ContentData content = polyDevice->GetContent();
+
+  std::string mrmlNodeTagName = "";
+  if (device->GetMetaDataElement(MRMLNodeNameKey, mrmlNodeTagName))
+  {
+    std::string className = scene->GetClassNameByTag(mrmlNodeTagName.c_str());
+    vtkMRMLNode* createdNode = scene->CreateNodeByClass(className.c_str());
+    if (createdNode)
+    {
+      modelNode = vtkMRMLModelNode::SafeDownCast(createdNode);
+    }
+    else
+    {
+      modelNode = vtkSmartPointer<vtkMRMLModelNode>::Take(vtkMRMLModelNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLModelNode")));
+    }
+  }
+  else
+  {
+    modelNode = vtkSmartPointer<vtkMRMLModelNode>::Take(vtkMRMLModelNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLModelNode")));
+  }
+  modelNode->SetName(deviceName.c_str());
+  modelNode->SetDescription("Received by OpenIGTLink");
+  scene->AddNode(modelNode);
+  modelNode->SetAndObservePolyData(content.polydata);
+  modelNode->CreateDefaultDisplayNodes();
+  return modelNode;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLNode* vtkMRMLIGTLConnectorNode::vtkInternal::CreateIncomingStringNode(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device)
+{
+  vtkMRMLScene* scene = self->GetScene();
+  const std::string deviceName = vtkInternal::GetIncomingNodeName(device);
+
+  vtkSmartPointer<vtkMRMLTextNode> textNode =
+    vtkMRMLTextNode::SafeDownCast(scene->GetFirstNode(deviceName.c_str(), "vtkMRMLTextNode"));
+  if (textNode)
+  {
+    return textNode;
+  }
+
+  igtlioStringDevice* modifiedDevice = reinterpret_cast<igtlioStringDevice*>(device);
+  textNode = vtkSmartPointer<vtkMRMLTextNode>::Take(vtkMRMLTextNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLTextNode")));
+  textNode->SetEncoding(modifiedDevice->GetContent().encoding);
+  textNode->SetText(modifiedDevice->GetContent().string_msg.c_str());
+  textNode->SetName(deviceName.c_str());
+  textNode->SetDescription("Received by OpenIGTLink");
+  scene->AddNode(textNode);
+  return textNode;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLNode* vtkMRMLIGTLConnectorNode::vtkInternal::CreateIncomingPointNode(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device)
+{
+  vtkMRMLScene* scene = self->GetScene();
+  const std::string deviceName = vtkInternal::GetIncomingNodeName(device);
+
+  vtkSmartPointer<vtkMRMLMarkupsFiducialNode> markupsNode =
+    vtkMRMLMarkupsFiducialNode::SafeDownCast(scene->GetFirstNode(deviceName.c_str(), "vtkMRMLMarkupsFiducialNode"));
+  if (markupsNode)
+  {
+    return markupsNode;
+  }
+  markupsNode = vtkMRMLMarkupsFiducialNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLMarkupsFiducialNode"));
+  markupsNode->SetName(deviceName.c_str());
+  markupsNode->SetDescription("Received by OpenIGTLink");
+  markupsNode->CreateDefaultDisplayNodes();
+  // its contents will be updated later
+  return markupsNode;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLNode* vtkMRMLIGTLConnectorNode::vtkInternal::CreateIncomingImageMetaNode(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device)
+{
+  vtkMRMLScene* scene = self->GetScene();
+  const std::string deviceName = vtkInternal::GetIncomingNodeName(device);
+
+  vtkSmartPointer<vtkMRMLImageMetaListNode> imageMetaNode =
+    vtkMRMLImageMetaListNode::SafeDownCast(scene->GetFirstNode(deviceName.c_str(), "vtkMRMLImageMetaListNode"));
+  if (imageMetaNode)
+  {
+    return imageMetaNode;
+  }
+
+  igtlioImageMetaDevice* imageMetaDevice = reinterpret_cast<igtlioImageMetaDevice*>(device);
+  imageMetaNode = vtkSmartPointer<vtkMRMLImageMetaListNode>::Take(vtkMRMLImageMetaListNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLImageMetaListNode")));
+  imageMetaNode->SetName(deviceName.c_str());
+  imageMetaNode->SetDescription("Received by OpenIGTLink");
+  igtlioImageMetaConverter::ImageMetaDataList imageMetaList = imageMetaDevice->GetContent().ImageMetaDataElements;
+  for (igtlioImageMetaConverter::ImageMetaDataList::iterator imageMetaIt = imageMetaList.begin(); imageMetaIt != imageMetaList.end(); ++imageMetaIt)
+  {
+    vtkMRMLImageMetaElement imageMetaElement;
+    imageMetaElement.DeviceName = imageMetaIt->DeviceName;
+    imageMetaElement.Modality = imageMetaIt->Modality;
+    imageMetaElement.Name = imageMetaIt->Name;
+    imageMetaElement.PatientID = imageMetaIt->PatientID;
+    imageMetaElement.PatientName = imageMetaIt->PatientName;
+    imageMetaElement.ScalarType = imageMetaIt->ScalarType;
+    for (int i = 0; i < 3; ++i)
+    {
+      imageMetaElement.Size[i] = imageMetaIt->Size[i];
+    }
+    imageMetaElement.TimeStamp = imageMetaIt->Timestamp;
+    imageMetaNode->AddImageMetaElement(imageMetaElement);
+  }
+  scene->AddNode(imageMetaNode);
+  return imageMetaNode;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLNode* vtkMRMLIGTLConnectorNode::vtkInternal::CreateIncomingLabelMetaNode(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device)
+{
+  vtkMRMLScene* scene = self->GetScene();
+  const std::string deviceName = vtkInternal::GetIncomingNodeName(device);
+
+  vtkSmartPointer<vtkMRMLLabelMetaListNode> labelMetaNode =
+    vtkMRMLLabelMetaListNode::SafeDownCast(scene->GetFirstNode(deviceName.c_str(), "vtkMRMLLabelMetaListNode"));
+  if (labelMetaNode)
+  {
+    return labelMetaNode;
+  }
+
+  igtlioLabelMetaDevice* labelMetaDevice = reinterpret_cast<igtlioLabelMetaDevice*>(device);
+  labelMetaNode = vtkSmartPointer<vtkMRMLLabelMetaListNode>::Take(vtkMRMLLabelMetaListNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLLabelMetaListNode")));
+  labelMetaNode->SetName(deviceName.c_str());
+  labelMetaNode->SetDescription("Received by OpenIGTLink");
+  igtlioLabelMetaConverter::LabelMetaDataList labelMetaList = labelMetaDevice->GetContent().LabelMetaDataElements;
+  for (igtlioLabelMetaConverter::LabelMetaDataList::iterator labelMetaIt = labelMetaList.begin(); labelMetaIt != labelMetaList.end(); ++labelMetaIt)
+  {
+    vtkMRMLLabelMetaListNode::LabelMetaElement labelMetaElement;
+    labelMetaElement.DeviceName = labelMetaIt->DeviceName;
+    labelMetaElement.Label = labelMetaIt->Label;
+    labelMetaElement.Name = labelMetaIt->Name;
+    labelMetaElement.Owner = labelMetaIt->Owner;
+    for (int i = 0; i < 4; ++i)
+    {
+      labelMetaElement.RGBA[i] = labelMetaIt->RGBA[i];
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+      labelMetaElement.Size[i] = labelMetaIt->Size[i];
+    }
+    labelMetaNode->AddLabelMetaElement(labelMetaElement);
+  }
+  scene->AddNode(labelMetaNode);
+  return labelMetaNode;
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLNode* vtkMRMLIGTLConnectorNode::vtkInternal::CreateIncomingTrackingDataNode(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device)
+{
+  vtkMRMLScene* scene = self->GetScene();
+  const std::string deviceName = vtkInternal::GetIncomingNodeName(device);
+
+  igtlioTrackingDataDevice* tdata = dynamic_cast<igtlioTrackingDataDevice*>(device);
+  if (tdata == nullptr)
+  {
+    vtkErrorWithObjectMacro(self, "TDATA message type but not a TDATA device. Cannot process.");
+    return nullptr;
+  }
+  auto contentCopy = tdata->GetContent();
+
+  vtkSmartPointer<vtkMRMLIGTLTrackingDataBundleNode> tdatanode =
+    vtkMRMLIGTLTrackingDataBundleNode::SafeDownCast(scene->GetFirstNode(deviceName.c_str(), "vtkMRMLIGTLTrackingDataBundleNode"));
+  if (tdatanode)
+  {
+    return tdatanode;
+  }
+  tdatanode = vtkSmartPointer<vtkMRMLIGTLTrackingDataBundleNode>::Take(vtkMRMLIGTLTrackingDataBundleNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLIGTLTrackingDataBundleNode")));
+  tdatanode->SetName(deviceName.c_str());
+  tdatanode->SetDescription("Received by OpenIGTLink");
+  // The bundle is added to the scene first, so that its transform nodes are added to the scene as well
+  scene->AddNode(tdatanode);
+  for (auto iter = contentCopy.trackingDataElements.cbegin(); iter != contentCopy.trackingDataElements.cend(); ++iter)
+  {
+    tdatanode->UpdateTransformNode(iter->second.deviceName.c_str(), iter->second.transform, iter->second.type);
+  }
+  return tdatanode;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::ApplyIncomingImage(vtkMRMLIGTLConnectorNode* vtkNotUsed(self), igtlioDevice* device, vtkMRMLNode* node)
+{
+  igtlioImageDevice* imageDevice = reinterpret_cast<igtlioImageDevice*>(device);
+  vtkMRMLVolumeNode* volumeNode = vtkMRMLVolumeNode::SafeDownCast(node);
+  if (volumeNode)
+  {
+    volumeNode->SetIJKToRASMatrix(imageDevice->GetContent().transform);
+    volumeNode->SetAndObserveImageData(imageDevice->GetContent().image);
+    volumeNode->GetImageData()->SetSpacing(1.0, 1.0, 1.0); // IGTL device sets spacing in image data, do not duplicate with IJKtoRAS spacing
+    volumeNode->GetImageData()->SetOrigin(0.0, 0.0, 0.0); // IGTL device sets origin in image data, do not duplicate with IJKtoRAS origin
+#if VTK_MAJOR_VERSION >= 9
+    vtkSmartPointer<vtkMatrix3x3> mat = vtkSmartPointer<vtkMatrix3x3>::New();
+    mat->Identity();
+    volumeNode->GetImageData()->SetDirectionMatrix(mat); // IGTL device sets directions in image data, do not duplicate with IJKtoRAS directions
+#endif
+    volumeNode->Modified();
+  }
+}
+
+#if defined(OpenIGTLink_ENABLE_VIDEOSTREAMING)
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::ApplyIncomingVideo(vtkMRMLIGTLConnectorNode* self, igtlioDevice* device, vtkMRMLNode* node)
+{
+  igtlioVideoDevice* videoDevice = reinterpret_cast<igtlioVideoDevice*>(device);
+  PreviousFrameInfo& previousFrame = self->Internal->PreviousIncomingFramesMap[videoDevice->GetDeviceName()];
+  bool keyFrame = (videoDevice->GetContent().frameType == igtl::FrameTypeKey);
+  previousFrame.NodeID = node->GetID();
+  vtkSmartPointer<vtkIGTLVideoFramePool>& framePool = self->Internal->IncomingVideoFramePools[videoDevice->GetDeviceName()];
+  if (!framePool)
+  {
+    framePool = vtkSmartPointer<vtkIGTLVideoFramePool>::New();
+  }
+  // Frames and their buffers are recycled once they are not referenced by the volume node or a later frame
+  vtkStreamingVolumeFrame* frame = framePool->GetFrame(videoDevice->GetContent().frameData->GetPointer(0),
+    videoDevice->GetContent().videoMessage->GetBitStreamSize());
+
+  std::string codecName = videoDevice->GetCurrentCodecType().substr(0, 4);
+  frame->SetFrameType(keyFrame ? vtkStreamingVolumeFrame::IFrame : vtkStreamingVolumeFrame::PFrame);
+  videoDevice->GetContent().videoMessage->Unpack(false);
+  frame->SetDimensions(videoDevice->GetContent().videoMessage->GetWidth(),
+    videoDevice->GetContent().videoMessage->GetHeight(),
+    videoDevice->GetContent().videoMessage->GetAdditionalZDimension());
+  frame->SetNumberOfComponents(videoDevice->GetContent().grayscale ? 1 : 3);
+  frame->SetCodecFourCC(codecName);
+  vtkIdType frameSize = videoDevice->GetContent().videoMessage->GetBitStreamSize();
+  bool chainLimitReached =
+    (self->Internal->MaximumVideoFrameChainLength > 0 && previousFrame.ChainLength >= self->Internal->MaximumVideoFrameChainLength)
+    || (self->Internal->MaximumVideoFrameChainSize > 0 && previousFrame.ChainSize + frameSize > self->Internal->MaximumVideoFrameChainSize);
+  bool chainStart = (frame->IsKeyFrame() || !previousFrame.Frame);
+  if (chainStart)
+  {
+    // Any decoder can decode the following frames
+    previousFrame.ChainCut = false;
+    previousFrame.DecodingThreadMissedFrame = false;
+    previousFrame.DecodeInVolumeNode = false;
+    previousFrame.DecodeOnMainThread = false;
+  }
+  // Cut chains are decoded by the codec of the decoding thread: in the decoding thread,
+  // or on the main thread if the decoding thread has been stopped since the cut
+  bool decodeWithThreadCodec = (self->Internal->UseBackgroundDecoding && !previousFrame.DecodeInVolumeNode)
+    || previousFrame.DecodeOnMainThread;
+  if (chainStart)
+  {
+    chainLimitReached = false;
+    previousFrame.ChainLength = 0;
+    previousFrame.ChainSize = 0;
+  }
+  else if (chainLimitReached && decodeWithThreadCodec && !previousFrame.DecodingThreadMissedFrame)
+  {
+    // The codec of the decoding thread decodes all frames in order, so it does not need the previous frames.
+    // Frames that are already queued for decoding must not be modified, so the chain is restarted at this frame.
+    previousFrame.ChainLength = 0;
+    previousFrame.ChainSize = 0;
+    previousFrame.ChainCut = true;
+  }
+  else
+  {
+    // If the current frame is not a keyframe, then it should maintain a reference to the previously received frame
+    // so that the current frame can be decoded
+    frame->SetPreviousFrame(previousFrame.Frame);
+  }
+  previousFrame.Frame = frame;
+  previousFrame.ChainLength++;
+  previousFrame.ChainSize += frameSize;
+
+  vtkMRMLStreamingVolumeNode* streamingVolumeNode = vtkMRMLStreamingVolumeNode::SafeDownCast(node);
+  FrameDecodeTask task;
+  task.Frame = frame;
+  if (decodeWithThreadCodec)
+  {
+    task.NodeID = node->GetID();
+    task.Sequence = self->Internal->NextFrameSequence++;
+    // All frames are decoded to keep the decoder up-to-date, but the image is only created if it is displayed.
+    // Otherwise the volume node decodes the image if it is requested, which is only possible if the chain
+    // of the frame is complete.
+    task.DecodeImage = !self->Internal->LazyVideoDecoding || previousFrame.ChainCut
+      || self->Internal->IsVolumeNodeDisplayed(streamingVolumeNode);
+    task.IJKToRASMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    task.IJKToRASMatrix->DeepCopy(videoDevice->GetContent().transform);
+    if (previousFrame.DecodeOnMainThread)
+    {
+      // The decoding thread is stopped, so its codec can be used on the main thread
+      self->Internal->DecodeQueuedFrame(task);
+      self->Internal->ApplyQueuedFrame(task);
+      return;
+    }
+    if (self->Internal->QueueFrameDecode(task))
+    {
+      // The frame is applied to the node in PeriodicProcess() after it is decoded
+      previousFrame.DecodingThreadMissedFrame = false;
+      return;
+    }
+    // Decoding thread cannot keep up. The next frame references this frame, so the decoding thread decodes
+    // this frame before the next frame, and the following frames are not lost.
+    previousFrame.DecodingThreadMissedFrame = true;
+    if (previousFrame.ChainCut)
+    {
+      // Only the codec of the decoding thread can decode this frame, it is shown once the next frame is decoded
+      return;
+    }
+    // The frame is applied on the main thread instead, the volume node decodes it when needed
+    task.DecodedImage = nullptr;
+    self->Internal->ApplyQueuedFrame(task);
+    return;
+  }
+
+  // The volume node decodes the frame when needed
+  task.IJKToRASMatrix = videoDevice->GetContent().transform;
+  self->Internal->ApplyFrame(streamingVolumeNode, task);
+
+  if (chainLimitReached)
+  {
+    // Decode the frame now, while all previous frames are available, so that the references to them can be released.
+    // The codec of the volume node then continues decoding from this frame.
+    streamingVolumeNode->GetImageData();
+    frame->SetPreviousFrame(nullptr);
+    previousFrame.ChainLength = 1;
+    previousFrame.ChainSize = frameSize;
+    previousFrame.ChainCut = true;
+  }
+}
+#endif
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::ApplyIncomingStatus(vtkMRMLIGTLConnectorNode* vtkNotUsed(self), igtlioDevice* device, vtkMRMLNode* node)
+{
+  igtlioStatusDevice* statusDevice = reinterpret_cast<igtlioStatusDevice*>(device);
+  vtkMRMLIGTLStatusNode* statusNode = vtkMRMLIGTLStatusNode::SafeDownCast(node);
+  statusNode->SetStatus(statusDevice->GetContent().code, statusDevice->GetContent().subcode, statusDevice->GetContent().errorname.c_str(), statusDevice->GetContent().statusstring.c_str());
+  statusNode->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::ApplyIncomingTransform(vtkMRMLIGTLConnectorNode* vtkNotUsed(self), igtlioDevice* device, vtkMRMLNode* node)
+{
+  igtlioTransformDevice* transformDevice = reinterpret_cast<igtlioTransformDevice*>(device);
+  vtkMRMLTransformNode* transformNode = vtkMRMLTransformNode::SafeDownCast(node);
+  // The matrix is copied by the transform node
+  transformNode->SetMatrixTransformToParent(transformDevice->GetContent().transform);
+  transformNode->Modified();
+
+  // Copy transform status from metadata to node attributes
+  for (igtl::MessageBase::MetaDataMap::const_iterator iter = device->GetMetaData().begin(); iter != device->GetMetaData().end(); ++iter)
+  {
+    if (iter->first.find("Status") == std::string::npos)
+    {
+      continue;
+    }
+    const char* currentValue = transformNode->GetAttribute(iter->first.c_str());
+    if (!currentValue || iter->second.second.compare(currentValue) != 0)
+    {
+      transformNode->SetAttribute(iter->first.c_str(), iter->second.second.c_str());
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::ApplyIncomingPolyData(vtkMRMLIGTLConnectorNode* vtkNotUsed(self), igtlioDevice* device, vtkMRMLNode* node)
+{
+  igtlioPolyDataDevice* polyDevice = reinterpret_cast<igtlioPolyDataDevice*>(device);
+  vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(node);
+  modelNode->SetAndObservePolyData(polyDevice->GetContent().polydata);
+  modelNode->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::ApplyIncomingString(vtkMRMLIGTLConnectorNode* vtkNotUsed(self), igtlioDevice* device, vtkMRMLNode* node)
+{
+  igtlioStringDevice* stringDevice = reinterpret_cast<igtlioStringDevice*>(device);
+  vtkMRMLTextNode* textNode = vtkMRMLTextNode::SafeDownCast(node);
+  textNode->SetEncoding(stringDevice->GetContent().encoding);
+  textNode->SetText(stringDevice->GetContent().string_msg.c_str());
+  textNode->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::ApplyIncomingPoint(vtkMRMLIGTLConnectorNode* vtkNotUsed(self), igtlioDevice* device, vtkMRMLNode* node)
+{
+  igtlioPointDevice* pointDevice = reinterpret_cast<igtlioPointDevice*>(device);
+  double selectedColor[3] = { 1.0, 1.0, 1.0 };
+  double unselectedColor[3] = { 1.0, 1.0, 1.0 };
+  bool selectedColorDefined = false;
+  bool unselectedColorDefined = false;
+  vtkMRMLMarkupsFiducialNode* markupsNode = vtkMRMLMarkupsFiducialNode::SafeDownCast(node);
+  MRMLNodeModifyBlocker blocker(markupsNode);
+
+  const igtlioPointConverter::PointList& points = pointDevice->GetContent().PointElements;
+  int numberOfPoints = static_cast<int>(points.size());
+
+  // Positions of all control points are set in a single call if any of them changed
+  bool positionsChanged = (markupsNode->GetNumberOfControlPoints() != numberOfPoints);
+  for (int controlPointIndex = 0; controlPointIndex < numberOfPoints && !positionsChanged; controlPointIndex++)
+  {
+    const igtlioPointConverter::PointElement& point = points[controlPointIndex];
+    vtkMRMLMarkupsNode::ControlPoint* controlPoint = markupsNode->GetNthControlPoint(controlPointIndex);
+    positionsChanged = controlPoint->PositionStatus != vtkMRMLMarkupsNode::PositionDefined
+      || controlPoint->Position[0] != point.Position[0]
+      || controlPoint->Position[1] != point.Position[1]
+      || controlPoint->Position[2] != point.Position[2];
+  }
+  // Received positions are in the coordinate system of the markups node. They are compared and set
+  // in local coordinates, so that round-off errors of the transform to world do not make them appear changed.
+  if (positionsChanged && !markupsNode->GetParentTransformNode())
+  {
+    // Local and world coordinates are the same
+    vtkSmartPointer<vtkPoints> positions = vtkSmartPointer<vtkPoints>::New();
+    positions->SetNumberOfPoints(numberOfPoints);
+    for (int controlPointIndex = 0; controlPointIndex < numberOfPoints; controlPointIndex++)
+    {
+      const igtlioPointConverter::PointElement& point = points[controlPointIndex];
+      positions->SetPoint(controlPointIndex, point.Position[0], point.Position[1], point.Position[2]);
+    }
+    markupsNode->SetControlPointPositionsWorld(positions);
+  }
+  else if (positionsChanged)
+  {
+    // Remove unneeded existing points
+    while (markupsNode->GetNumberOfControlPoints() > numberOfPoints)
+    {
+      markupsNode->RemoveNthControlPoint(markupsNode->GetNumberOfControlPoints() - 1);
+    }
+    for (int controlPointIndex = 0; controlPointIndex < numberOfPoints; controlPointIndex++)
+    {
+      const igtlioPointConverter::PointElement& point = points[controlPointIndex];
+      if (controlPointIndex >= markupsNode->GetNumberOfControlPoints())
+      {
+        markupsNode->AddControlPoint(vtkVector3d(point.Position[0], point.Position[1], point.Position[2]), point.Name);
+        continue;
+      }
+      vtkMRMLMarkupsNode::ControlPoint* controlPoint = markupsNode->GetNthControlPoint(controlPointIndex);
+      if (controlPoint->PositionStatus != vtkMRMLMarkupsNode::PositionDefined
+        || controlPoint->Position[0] != point.Position[0]
+        || controlPoint->Position[1] != point.Position[1]
+        || controlPoint->Position[2] != point.Position[2])
+      {
+        markupsNode->SetNthControlPointPosition(controlPointIndex, point.Position[0], point.Position[1], point.Position[2]);
+      }
+    }
+  }
+
+  // Update labels and flags that changed
+  for (int controlPointIndex = 0; controlPointIndex < numberOfPoints; controlPointIndex++)
+  {
+    const igtlioPointConverter::PointElement& point = points[controlPointIndex];
+    bool selected = (point.GroupName != "Unselected");
+
+    // Use the first encountered selected/unselected color and opacity for all points
+    if (selected && !selectedColorDefined)
+    {
+      selectedColor[0] = point.RGBA[0] / 255.0;
+      selectedColor[1] = point.RGBA[1] / 255.0;
+      selectedColor[2] = point.RGBA[2] / 255.0;
+      selectedColorDefined = true;
+    }
+    else if (!selected && !unselectedColorDefined)
+    {
+      unselectedColor[0] = point.RGBA[0] / 255.0;
+      unselectedColor[1] = point.RGBA[1] / 255.0;
+      unselectedColor[2] = point.RGBA[2] / 255.0;
+      unselectedColorDefined = true;
+    }
+
+    vtkMRMLMarkupsNode::ControlPoint* controlPoint = markupsNode->GetNthControlPoint(controlPointIndex);
+    if (controlPoint->Label != point.Name)
+    {
+      markupsNode->SetNthControlPointLabel(controlPointIndex, point.Name);
+    }
+    if (controlPoint->Selected != selected)
+    {
+      markupsNode->SetNthControlPointSelected(controlPointIndex, selected);
+    }
+    bool visible = (point.RGBA[3] > 0);
+    if (controlPoint->Visibility != visible)
+    {
+      markupsNode->SetNthControlPointVisibility(controlPointIndex, visible);
+    }
+    // Note: we currently do not preserve point.Radius and point.Owner information
+  }
+
+  vtkMRMLMarkupsDisplayNode* displayNode = vtkMRMLMarkupsDisplayNode::SafeDownCast(markupsNode->GetDisplayNode());
+  if (displayNode)
+  {
+    MRMLNodeModifyBlocker blocker(displayNode);
+    if (selectedColorDefined)
+    {
+      displayNode->SetSelectedColor(selectedColor);
+    }
+    if (unselectedColorDefined)
+    {
+      displayNode->SetColor(unselectedColor);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::ApplyIncomingImageMeta(vtkMRMLIGTLConnectorNode* vtkNotUsed(self), igtlioDevice* device, vtkMRMLNode* node)
+{
+  igtlioImageMetaDevice* imageMetaDevice = reinterpret_cast<igtlioImageMetaDevice*>(device);
+  vtkMRMLImageMetaListNode* imageMetaNode = vtkMRMLImageMetaListNode::SafeDownCast(node);
+  imageMetaNode->ClearImageMetaElement();
+  igtlioImageMetaConverter::ImageMetaDataList imageMetaList = imageMetaDevice->GetContent().ImageMetaDataElements;
+  for (igtlioImageMetaConverter::ImageMetaDataList::iterator imageMetaIt = imageMetaList.begin(); imageMetaIt != imageMetaList.end(); ++imageMetaIt)
+  {
+    vtkMRMLImageMetaElement imageMetaElement;
+    imageMetaElement.DeviceName = imageMetaIt->DeviceName;
+    imageMetaElement.Modality = imageMetaIt->Modality;
+    imageMetaElement.Name = imageMetaIt->Name;
+    imageMetaElement.PatientID = imageMetaIt->PatientID;
+    imageMetaElement.PatientName = imageMetaIt->PatientName;
+    imageMetaElement.ScalarType = imageMetaIt->ScalarType;
+    for (int i = 0; i < 3; ++i)
+    {
+      imageMetaElement.Size[i] = imageMetaIt->Size[i];
+    }
+    imageMetaElement.TimeStamp = imageMetaIt->Timestamp;
+    imageMetaNode->AddImageMetaElement(imageMetaElement);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::ApplyIncomingLabelMeta(vtkMRMLIGTLConnectorNode* vtkNotUsed(self), igtlioDevice* device, vtkMRMLNode* node)
+{
+  igtlioLabelMetaDevice* labelMetaDevice = reinterpret_cast<igtlioLabelMetaDevice*>(device);
+  vtkMRMLLabelMetaListNode* labelMetaNode = vtkMRMLLabelMetaListNode::SafeDownCast(node);
+  labelMetaNode->ClearLabelMetaElement();
+  igtlioLabelMetaConverter::LabelMetaDataList labelMetaList = labelMetaDevice->GetContent().LabelMetaDataElements;
+  for (igtlioLabelMetaConverter::LabelMetaDataList::iterator labelMetaIt = labelMetaList.begin(); labelMetaIt != labelMetaList.end(); ++labelMetaIt)
+  {
+    vtkMRMLLabelMetaListNode::LabelMetaElement labelMetaElement;
+    labelMetaElement.DeviceName = labelMetaIt->DeviceName;
+    labelMetaElement.Label = labelMetaIt->Label;
+    labelMetaElement.Name = labelMetaIt->Name;
+    labelMetaElement.Owner = labelMetaIt->Owner;
+    for (int i = 0; i < 4; ++i)
+    {
+      labelMetaElement.RGBA[i] = labelMetaIt->RGBA[i];
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+      labelMetaElement.Size[i] = labelMetaIt->Size[i];
+    }
+    labelMetaNode->AddLabelMetaElement(labelMetaElement);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::ApplyIncomingTrackingData(vtkMRMLIGTLConnectorNode* vtkNotUsed(self), igtlioDevice* device, vtkMRMLNode* node)
+{
+  igtlioTrackingDataDevice* tdataDevice = reinterpret_cast<igtlioTrackingDataDevice*>(device);
+  vtkMRMLIGTLTrackingDataBundleNode* tBundleNode = vtkMRMLIGTLTrackingDataBundleNode::SafeDownCast(node);
+  if (!tBundleNode)
+  {
+    return;
+  }
+
+  igtlioTrackingDataConverter::ContentData content = tdataDevice->GetContent();
+
+  // All transforms of the message are updated before observers of the transform nodes are notified,
+  // and the bundle node (being modified by the caller) is notified only once.
+  std::vector<std::pair<vtkMRMLLinearTransformNode*, int> > modifiedTransformNodes;
+  std::unordered_set<vtkMRMLLinearTransformNode*> updatedTransformNodes;
+  for (auto iter = content.trackingDataElements.begin(); iter != content.trackingDataElements.end(); ++iter)
+  {
+    const char* name = iter->second.deviceName.c_str();
+    vtkMRMLLinearTransformNode* transformNode = tBundleNode->GetTransformNodeByName(name);
+    if (!transformNode)
+    {
+      tBundleNode->UpdateTransformNode(name, iter->second.transform, iter->second.type);
+      transformNode = tBundleNode->GetTransformNodeByName(name);
+      updatedTransformNodes.insert(transformNode);
+      modifiedTransformNodes.push_back(std::make_pair(transformNode, transformNode->StartModify()));
+      continue;
+    }
+
+    // Only the first occurrence of each transform name is used if duplicates are present.
+    // See https://discourse.slicer.org/t/unexpected-behavior-in-transforms-module-and-igt-reslicedriver/42828/8
+    if (!updatedTransformNodes.insert(transformNode).second)
+    {
+      continue;
+    }
+
+    modifiedTransformNodes.push_back(std::make_pair(transformNode, transformNode->StartModify()));
+    // The matrix is copied by the transform node
+    transformNode->SetMatrixTransformToParent(iter->second.transform);
+  }
+  if (!modifiedTransformNodes.empty())
+  {
+    tBundleNode->Modified();
+  }
+
+  for (auto modifiedIt = modifiedTransformNodes.begin(); modifiedIt != modifiedTransformNodes.end(); ++modifiedIt)
+  {
+    modifiedIt->first->EndModify(modifiedIt->second);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::ProcessIncomingDeviceModifiedEvent(
+  vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(event), igtlioDevice* modifiedDevice)
+{
+  vtkMRMLNode* modifiedNode = this->GetMRMLNodeForDevice(modifiedDevice);
+  bool isNewNodeCreated = false;
+  if (!modifiedNode)
+  {
+    // Could not find node, create new node
+    modifiedNode = this->CreateNewMRMLNodeForDevice(modifiedDevice);
+    // new node created, notify other class about the creation of new node at the end of this function when all content are assigned to the new node.
+    isNewNodeCreated = true;
+  }
+  if (!modifiedNode)
+  {
+    // Could not add node.
+    return;
+  }
+
+  int wasModifyingNode = modifiedNode->StartModify();
+
+  const DeviceTypeHandler* handler = this->Internal->GetDeviceTypeHandler(modifiedDevice);
+  if (handler)
+  {
+    if (handler->ApplyIncoming)
+    {
+      handler->ApplyIncoming(this, modifiedDevice, modifiedNode);
+    }
+
+    // copy metadata from igtl message to MRML node
+    this->Internal->CopyMetaDataToNodeAttributes(modifiedDevice, modifiedNode);
+  }
+
+  vtkMRMLIGTLQueryNode* queryNode = this->Internal->GetPendingQueryNodeForDevice(modifiedDevice);
+  if (queryNode && modifiedNode)
+  {
+    this->Internal->RemovePendingQueryNode(queryNode);
+    queryNode->SetResponseDataNodeID(modifiedNode->GetID());
+    queryNode->SetQueryStatus(vtkMRMLIGTLQueryNode::STATUS_SUCCESS);
+    queryNode->InvokeEvent(vtkMRMLIGTLQueryNode::ResponseEvent);
+  }
+
+  this->Internal->SetIncomingNodeClientID(modifiedNode, modifiedDevice->GetClientID());
+  modifiedNode->EndModify(wasModifyingNode);
+
+  if(isNewNodeCreated)
+  {
+     //New device event needs to be forward with the MRMLNode to other objects, such as openigtlinkRemote. where the node will be processed to set name accordingly.
+     this->InvokeEvent(NewDeviceEvent, modifiedNode);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::DeviceAboutToReceiveEvent(igtlioDevice* modifiedDevice)
+{
+  if (!modifiedDevice)
+  {
+    vtkErrorWithObjectMacro(modifiedDevice, "Invalid device");
+    return;
+  }
+
+  vtkMRMLNode* modifiedNode = this->External->GetMRMLNodeForDevice(modifiedDevice);
+  if (!modifiedNode)
+  {
+    // Could not find node, create new node
+    modifiedNode = this->External->CreateNewMRMLNodeForDevice(modifiedDevice);
+    if (modifiedNode)
+    {
+      //New device event needs to be forward with the MRMLNode to other objects, such as openigtlinkRemote. where the node will be processed to set name accordingly.
+      this->External->InvokeEvent(NewDeviceEvent, modifiedNode);
+    }
+  }
+  if (!modifiedNode)
+  {
+    // Could not add node.
+    return;
+  }
+
+  vtkInternal::NodeModification modifying;
+  modifying.Node = modifiedNode;
+  modifying.Modifying = modifiedNode->StartModify();
+  this->PendingNodeModifications.push_back(modifying);
+
+  igtlioImageDevice* imageDevice = igtlioImageDevice::SafeDownCast(modifiedDevice);
+  if (imageDevice)
+  {
+    this->AssignIncomingImageBuffer(imageDevice);
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkMRMLNode* vtkMRMLIGTLConnectorNode::GetMRMLNodeForDevice(igtlioDevice* device)
+{
+  if (!this->GetScene())
+  {
+    // No scene to add nodes to.
+    return nullptr;
   }
-  else if (strcmp(device->GetDeviceType().c_str(), "POINT") == 0)
+
+  //Node name can be modified by other module, it is not a concrete way to find the match to the device name
+  // OriginalNodeNameKey arrtribute was added during node creation.
+  const std::string deviceType = device->GetDeviceType();
+  const std::string deviceName = device->GetDeviceName();
+  vtkMRMLNode* node = this->Internal->FindIndexedIncomingNode(deviceType, deviceName);
+  if (!node && this->Internal->IncomingNodeIndex.count(deviceType) && this->Internal->IncomingNodeIndex[deviceType].count(deviceName))
   {
-    vtkSmartPointer<vtkMRMLMarkupsFiducialNode> markupsNode =
-      vtkMRMLMarkupsFiducialNode::SafeDownCast(this->GetScene()->GetFirstNode(deviceName.c_str(), "vtkMRMLMarkupsFiducialNode"));
-    if (markupsNode)
-    {
-      this->RegisterIncomingMRMLNode(markupsNode, device);
-      return markupsNode;
-    }
-    markupsNode = vtkMRMLMarkupsFiducialNode::SafeDownCast(this->GetScene()->AddNewNodeByClass("vtkMRMLMarkupsFiducialNode"));
-    markupsNode->SetName(deviceName.c_str());
-    markupsNode->SetDescription("Received by OpenIGTLink");
-    markupsNode->CreateDefaultDisplayNodes();
-    // its contents will be updated later
-    this->RegisterIncomingMRMLNode(markupsNode, device);
-    return markupsNode;
+    // Indexed node is no longer valid (removed from the scene or its attribute changed), update the index
+    this->Internal->RebuildIncomingNodeIndex();
+    node = this->Internal->FindIndexedIncomingNode(deviceType, deviceName);
   }
-  else if (strcmp(device->GetDeviceType().c_str(), "IMGMETA") == 0)
-  {
-    vtkSmartPointer<vtkMRMLImageMetaListNode> imageMetaNode =
-      vtkMRMLImageMetaListNode::SafeDownCast(this->GetScene()->GetFirstNode(deviceName.c_str(), "vtkMRMLImageMetaListNode"));
-    if (imageMetaNode)
-    {
-      this->RegisterIncomingMRMLNode(imageMetaNode, device);
-      return imageMetaNode;
-    }
+  return node;
+}
 
-    igtlioImageMetaDevice* imageMetaDevice = reinterpret_cast<igtlioImageMetaDevice*>(device);
-    imageMetaNode = vtkSmartPointer<vtkMRMLImageMetaListNode>::Take(vtkMRMLImageMetaListNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLImageMetaListNode")));
-    imageMetaNode->SetName(deviceName.c_str());
-    imageMetaNode->SetDescription("Received by OpenIGTLink");
-    igtlioImageMetaConverter::ImageMetaDataList imageMetaList = imageMetaDevice->GetContent().ImageMetaDataElements;
-    for (igtlioImageMetaConverter::ImageMetaDataList::iterator imageMetaIt = imageMetaList.begin(); imageMetaIt != imageMetaList.end(); ++imageMetaIt)
-    {
-      vtkMRMLImageMetaElement imageMetaElement;
-      imageMetaElement.DeviceName = imageMetaIt->DeviceName;
-      imageMetaElement.Modality = imageMetaIt->Modality;
-      imageMetaElement.Name = imageMetaIt->Name;
-      imageMetaElement.PatientID = imageMetaIt->PatientID;
-      imageMetaElement.PatientName = imageMetaIt->PatientName;
-      imageMetaElement.ScalarType = imageMetaIt->ScalarType;
-      for (int i = 0; i < 3; ++i)
-      {
-        imageMetaElement.Size[i] = imageMetaIt->Size[i];
-      }
-      imageMetaElement.TimeStamp = imageMetaIt->Timestamp;
-      imageMetaNode->AddImageMetaElement(imageMetaElement);
-    }
-    this->GetScene()->AddNode(imageMetaNode);
-    this->RegisterIncomingMRMLNode(imageMetaNode, device);
-    return imageMetaNode;
-  }
-  else if (strcmp(device->GetDeviceType().c_str(), "LBMETA") == 0)
+//----------------------------------------------------------------------------
+vtkMRMLNode* vtkMRMLIGTLConnectorNode::CreateNewMRMLNodeForDevice(igtlioDevice *device)
+{
+  vtkMRMLScene* scene = this->GetScene();
+  if (!scene)
   {
-    vtkSmartPointer<vtkMRMLLabelMetaListNode> labelMetaNode =
-      vtkMRMLLabelMetaListNode::SafeDownCast(this->GetScene()->GetFirstNode(deviceName.c_str(), "vtkMRMLLabelMetaListNode"));
-    if (labelMetaNode)
-    {
-      this->RegisterIncomingMRMLNode(labelMetaNode, device);
-      return labelMetaNode;
-    }
-
-    igtlioLabelMetaDevice* labelMetaDevice = reinterpret_cast<igtlioLabelMetaDevice*>(device);
-    labelMetaNode = vtkSmartPointer<vtkMRMLLabelMetaListNode>::Take(vtkMRMLLabelMetaListNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLLabelMetaListNode")));
-    labelMetaNode->SetName(deviceName.c_str());
-    labelMetaNode->SetDescription("Received by OpenIGTLink");
-    igtlioLabelMetaConverter::LabelMetaDataList labelMetaList = labelMetaDevice->GetContent().LabelMetaDataElements;
-    for (igtlioLabelMetaConverter::LabelMetaDataList::iterator labelMetaIt = labelMetaList.begin(); labelMetaIt != labelMetaList.end(); ++labelMetaIt)
-    {
-      vtkMRMLLabelMetaListNode::LabelMetaElement labelMetaElement;
-      labelMetaElement.DeviceName = labelMetaIt->DeviceName;
-      labelMetaElement.Label = labelMetaIt->Label;
-      labelMetaElement.Name = labelMetaIt->Name;
-      labelMetaElement.Owner = labelMetaIt->Owner;
-      for (int i = 0; i < 4; ++i)
-      {
-        labelMetaElement.RGBA[i] = labelMetaIt->RGBA[i];
-      }
-      for (int i = 0; i < 3; ++i)
-      {
-        labelMetaElement.Size[i] = labelMetaIt->Size[i];
-      }
-      labelMetaNode->AddLabelMetaElement(labelMetaElement);
-    }
-    this->GetScene()->AddNode(labelMetaNode);
-    this->RegisterIncomingMRMLNode(labelMetaNode, device);
-    return labelMetaNode;
+    return nullptr;
   }
-  else if (strcmp(device->GetDeviceType().c_str(), "TDATA") == 0)
-  {
-    igtlioTrackingDataDevice* tdata = dynamic_cast<igtlioTrackingDataDevice*>(device);
-    if (tdata == nullptr)
-    {
-      vtkErrorWithObjectMacro(this, "TDATA message type but not a TDATA device. Cannot process.");
-      return NULL;
-    }
-    auto contentCopy = tdata->GetContent();
 
-    vtkSmartPointer<vtkMRMLIGTLTrackingDataBundleNode> tdatanode =
-      vtkMRMLIGTLTrackingDataBundleNode::SafeDownCast(this->GetScene()->GetFirstNode(deviceName.c_str(), "vtkMRMLIGTLTrackingDataBundleNode"));
-    if (tdatanode)
-    {
-      this->RegisterIncomingMRMLNode(tdatanode, device);
-      return tdatanode;
-    }
-    tdatanode = vtkSmartPointer<vtkMRMLIGTLTrackingDataBundleNode>::Take(vtkMRMLIGTLTrackingDataBundleNode::SafeDownCast(scene->CreateNodeByClass("vtkMRMLIGTLTrackingDataBundleNode")));
-    tdatanode->SetName(deviceName.c_str());
-    tdatanode->SetDescription("Received by OpenIGTLink");
-    for (auto iter = contentCopy.trackingDataElements.cbegin(); iter != contentCopy.trackingDataElements.cend(); ++iter)
+  const DeviceTypeHandler* handler = this->Internal->GetDeviceTypeHandler(device);
+  if (handler && handler->CreateIncomingNode)
+  {
+    vtkMRMLNode* node = handler->CreateIncomingNode(this, device);
+    if (node)
     {
-      tdatanode->UpdateTransformNode(iter->second.deviceName.c_str(), iter->second.transform, iter->second.type);
+      this->RegisterIncomingMRMLNode(node, device);
     }
-    this->GetScene()->AddNode(tdatanode);
-    this->RegisterIncomingMRMLNode(tdatanode, device);
-    return tdatanode;
+    return node;
   }
-  return NULL;
+
+  // Device type is not supported
+  return nullptr;
 }
 
 //----------------------------------------------------------------------------
 igtlioCommandPointer vtkMRMLIGTLConnectorNode::vtkInternal::SendCommand(igtlioCommandPointer command)
 {
+  std::vector<std::unique_lock<std::recursive_mutex> > socketLocks = this->LockClientSockets(-1);
   this->IOConnector->SendCommand(command);
   return command;
 }
@@ -1112,6 +3307,7 @@ igtlioCommandPointer vtkMRMLIGTLConnectorNode::vtkInternal::SendCommand(igtlioCo
 //----------------------------------------------------------------------------
 int vtkMRMLIGTLConnectorNode::vtkInternal::SendCommandResponse(igtlioCommandPointer command)
 {
+  std::vector<std::unique_lock<std::recursive_mutex> > socketLocks = this->LockClientSockets(-1);
   return this->IOConnector->SendCommandResponse(command);
 }
 
@@ -1125,80 +3321,160 @@ void vtkMRMLIGTLConnectorNode::vtkInternal::ReceiveCommandResponse(igtlioCommand
 //----------------------------------------------------------------------------
 vtkMRMLIGTLQueryNode* vtkMRMLIGTLConnectorNode::vtkInternal::GetPendingQueryNodeForDevice(igtlioDevice* device)
 {
-  vtkMRMLIGTLQueryNode* queryNode = nullptr;
-  this->External->QueryQueueMutex.lock();
-  for (QueryListType::iterator igtlQueryIt = this->External->QueryWaitingQueue.begin();
-    igtlQueryIt != this->External->QueryWaitingQueue.end(); ++igtlQueryIt)
+  std::lock_guard<std::mutex> lock(this->External->QueryQueueMutex);
+  // Queries for the device name and queries for any device name of the type
+  QueryKeyType keys[2] = { QueryKeyType(device->GetDeviceType(), device->GetDeviceName()), QueryKeyType(device->GetDeviceType(), "") };
+  int numberOfKeys = device->GetDeviceName().empty() ? 1 : 2;
+  while (true)
+  {
+    unsigned long oldestSequence = 0;
+    vtkMRMLIGTLQueryNode* oldestQueryNode = nullptr;
+    for (int keyIndex = 0; keyIndex < numberOfKeys; ++keyIndex)
+    {
+      auto queriesIt = this->PendingQueriesByKey.find(keys[keyIndex]);
+      if (queriesIt == this->PendingQueriesByKey.end() || queriesIt->second.empty())
+      {
+        continue;
+      }
+      auto oldestIt = queriesIt->second.begin();
+      if (!oldestQueryNode || oldestIt->first < oldestSequence)
+      {
+        oldestSequence = oldestIt->first;
+        oldestQueryNode = oldestIt->second;
+      }
+    }
+    if (!oldestQueryNode)
+    {
+      return nullptr;
+    }
+    PendingQuery& query = this->PendingQueries[oldestSequence];
+    if (query.Node && query.Node->GetQueryStatus() == vtkMRMLIGTLQueryNode::STATUS_WAITING)
+    {
+      return query.Node;
+    }
+    // The query node has been deleted or the query is not pending anymore
+    this->RemovePendingQuery(oldestSequence);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::AddPendingQueryNode(vtkMRMLIGTLQueryNode* queryNode)
+{
   {
-    vtkMRMLIGTLQueryNode* currentQueryNode = *igtlQueryIt;
-    if (currentQueryNode && currentQueryNode->GetIGTLName() == device->GetDeviceType() &&
-      (!currentQueryNode->GetIGTLDeviceName() || !currentQueryNode->GetIGTLDeviceName()[0] || currentQueryNode->GetIGTLDeviceName() == device->GetDeviceName()))
+    std::lock_guard<std::mutex> lock(this->External->QueryQueueMutex);
+    // A node that is pushed again (or a new node at the address of a deleted node) replaces the previous entry
+    auto sequenceIt = this->PendingQuerySequences.find(queryNode);
+    if (sequenceIt != this->PendingQuerySequences.end())
     {
-      queryNode = currentQueryNode;
-      break;
+      this->RemovePendingQuery(sequenceIt->second);
+    }
+
+    unsigned long sequence = this->NextQuerySequence++;
+    PendingQuery& query = this->PendingQueries[sequence];
+    query.Node = queryNode;
+    query.Key = QueryKeyType(queryNode->GetIGTLName(), queryNode->GetIGTLDeviceName());
+    query.WaitingQueueIt = this->External->QueryWaitingQueue.insert(this->External->QueryWaitingQueue.end(), queryNode);
+    this->PendingQuerySequences[queryNode] = sequence;
+    this->PendingQueriesByKey[query.Key][sequence] = queryNode;
+    queryNode->AddObserver(vtkCommand::ModifiedEvent, this->PendingQueryNodeCallback);
+    queryNode->AddObserver(vtkCommand::DeleteEvent, this->PendingQueryNodeCallback);
+    if (queryNode->GetTimeOut() <= 0.0)
+    {
+      return;
+    }
+    this->QueryDeadlines.push(QueryDeadlineType(queryNode->GetTimeStamp() + queryNode->GetTimeOut(), sequence));
+  }
+  // Processing is rescheduled for the expiration of the query
+  this->RequestProcessing();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::RemovePendingQuery(unsigned long sequence)
+{
+  auto queryIt = this->PendingQueries.find(sequence);
+  if (queryIt == this->PendingQueries.end())
+  {
+    return;
+  }
+  auto queriesIt = this->PendingQueriesByKey.find(queryIt->second.Key);
+  if (queriesIt != this->PendingQueriesByKey.end())
+  {
+    vtkMRMLIGTLQueryNode* queryNode = queriesIt->second[sequence];
+    queriesIt->second.erase(sequence);
+    if (queriesIt->second.empty())
+    {
+      this->PendingQueriesByKey.erase(queriesIt);
+    }
+    auto sequenceIt = this->PendingQuerySequences.find(queryNode);
+    if (sequenceIt != this->PendingQuerySequences.end() && sequenceIt->second == sequence)
+    {
+      this->PendingQuerySequences.erase(sequenceIt);
     }
   }
-  this->External->QueryQueueMutex.unlock();
+  if (queryIt->second.Node)
+  {
+    queryIt->second.Node->RemoveObserver(this->PendingQueryNodeCallback);
+  }
+  this->External->QueryWaitingQueue.erase(queryIt->second.WaitingQueueIt);
+  this->PendingQueries.erase(queryIt);
+}
 
-  return queryNode;
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::vtkInternal::OnPendingQueryNodeModified(vtkObject* caller, unsigned long event, void* clientData, void* vtkNotUsed(callData))
+{
+  vtkInternal* self = reinterpret_cast<vtkInternal*>(clientData);
+  vtkMRMLIGTLQueryNode* queryNode = reinterpret_cast<vtkMRMLIGTLQueryNode*>(caller);
+  if (event == vtkCommand::ModifiedEvent && queryNode->GetQueryStatus() == vtkMRMLIGTLQueryNode::STATUS_WAITING)
+  {
+    return;
+  }
+  self->RemovePendingQueryNode(queryNode);
 }
 
 //----------------------------------------------------------------------------
 bool vtkMRMLIGTLConnectorNode::vtkInternal::RemovePendingQueryNode(vtkMRMLIGTLQueryNode* queryNode)
 {
-  this->External->QueryQueueMutex.lock();
-  QueryListType::iterator queryIt = std::find(this->External->QueryWaitingQueue.begin(), this->External->QueryWaitingQueue.end(), queryNode);
-  if (queryIt == this->External->QueryWaitingQueue.end())
+  std::lock_guard<std::mutex> lock(this->External->QueryQueueMutex);
+  auto sequenceIt = this->PendingQuerySequences.find(queryNode);
+  if (sequenceIt == this->PendingQuerySequences.end())
   {
     // Could not find query to remove
     return false;
   }
-  this->External->QueryWaitingQueue.erase(queryIt);
-  this->External->QueryQueueMutex.unlock();
+  this->RemovePendingQuery(sequenceIt->second);
   return true;
 }
 
 //----------------------------------------------------------------------------
 void vtkMRMLIGTLConnectorNode::vtkInternal::RemoveExpiredQueries()
 {
-  QueryListType expiredQueries;
-  this->External->QueryQueueMutex.lock();
-  expiredQueries.remove(nullptr); // Weak pointers could be set to nullptr if references are removed
-  for (QueryListType::iterator queryIt = this->External->QueryWaitingQueue.begin(); queryIt != this->External->QueryWaitingQueue.end(); ++queryIt)
+  std::vector<vtkSmartPointer<vtkMRMLIGTLQueryNode> > expiredQueries;
   {
-    vtkMRMLIGTLQueryNode* queryNode = *queryIt;
-    if (!queryNode)
-    {
-      continue;
-    }
-
-    if (queryNode->GetQueryStatus() != vtkMRMLIGTLQueryNode::STATUS_WAITING)
-    {
-      // Query is not pending
-      expiredQueries.push_back(queryNode);
-      continue;
-    }
-
-    double timeout = queryNode->GetTimeOut();
-    if (timeout <= 0.0)
-    {
-      // Query has no timeout
-      continue;
-    }
-
-    double timeElapsed = vtkTimerLog::GetUniversalTime() - queryNode->GetTimeStamp();
-    if (timeElapsed > timeout)
+    std::lock_guard<std::mutex> lock(this->External->QueryQueueMutex);
+    double currentTime = vtkTimerLog::GetUniversalTime();
+    while (!this->QueryDeadlines.empty() && this->QueryDeadlines.top().first < currentTime)
     {
-      // Query is expired
-      queryNode->SetQueryStatus(vtkMRMLIGTLQueryNode::STATUS_EXPIRED);
-      expiredQueries.push_back(queryNode);
+      unsigned long sequence = this->QueryDeadlines.top().second;
+      this->QueryDeadlines.pop();
+      auto queryIt = this->PendingQueries.find(sequence);
+      if (queryIt == this->PendingQueries.end())
+      {
+        // Query has already been answered or removed
+        continue;
+      }
+      vtkMRMLIGTLQueryNode* queryNode = queryIt->second.Node;
+      if (queryNode && queryNode->GetQueryStatus() == vtkMRMLIGTLQueryNode::STATUS_WAITING)
+      {
+        expiredQueries.push_back(queryNode);
+      }
+      this->RemovePendingQuery(sequence);
     }
   }
-  this->External->QueryQueueMutex.unlock();
 
-  for (QueryListType::iterator queryIt = expiredQueries.begin(); queryIt != expiredQueries.end(); ++queryIt)
+  // Status is changed without holding the lock, as observers may push new queries
+  for (std::vector<vtkSmartPointer<vtkMRMLIGTLQueryNode> >::iterator queryIt = expiredQueries.begin(); queryIt != expiredQueries.end(); ++queryIt)
   {
-    this->RemovePendingQueryNode(*queryIt);
+    (*queryIt)->SetQueryStatus(vtkMRMLIGTLQueryNode::STATUS_EXPIRED);
   }
 }
 
@@ -1230,19 +3506,7 @@ vtkMRMLIGTLConnectorNode::vtkMRMLIGTLConnectorNode()
 
   this->OutgoingMessageHeaderVersionMaximum = -1;
 
-  this->Internal->DeviceTypeToNodeTagMap.clear();
-  std::string volumeTags[] = { "Volume", "VectorVolume", "StreamingVolume" };
-  this->Internal->DeviceTypeToNodeTagMap["IMAGE"] = std::vector<std::string>(volumeTags, volumeTags + 3);
-  this->Internal->DeviceTypeToNodeTagMap["VIDEO"] = std::vector<std::string>(1, "StreamingVolume");
-  this->Internal->DeviceTypeToNodeTagMap["STATUS"] = std::vector<std::string>(1, "IGTLStatus");
-  this->Internal->DeviceTypeToNodeTagMap["TRANSFORM"] = std::vector<std::string>(1, "LinearTransform");
-  std::string modelTags[] = { "Model", "FiberBundle" };
-  this->Internal->DeviceTypeToNodeTagMap["POLYDATA"] = std::vector<std::string>(modelTags, modelTags + 2);
-  this->Internal->DeviceTypeToNodeTagMap["STRING"] = std::vector<std::string>(1, "Text");
-  this->Internal->DeviceTypeToNodeTagMap["POINT"] = std::vector<std::string>(1, "MarkupsFiducial");
-  this->Internal->DeviceTypeToNodeTagMap["IMGMETA"] = std::vector<std::string>(1, "ImageMetaList");
-  this->Internal->DeviceTypeToNodeTagMap["LBMETA"] = std::vector<std::string>(1, "LabelMetaList");
-  this->Internal->DeviceTypeToNodeTagMap["TDATA"] = std::vector<std::string>(1, "IGTLTrackingDataSplitter");
+  this->Internal->RegisterDefaultDeviceTypeHandlers();
 }
 
 //----------------------------------------------------------------------------
@@ -1270,54 +3534,58 @@ void vtkMRMLIGTLConnectorNode::ConnectEvents()
 //----------------------------------------------------------------------------
 std::vector<std::string> vtkMRMLIGTLConnectorNode::GetNodeTagFromDeviceType(const char* deviceType)
 {
-  vtkInternal::DeviceTypeToNodeTagMapType::iterator iter;
-  if (this->Internal->DeviceTypeToNodeTagMap.find(std::string(deviceType)) != this->Internal->DeviceTypeToNodeTagMap.end())
+  vtkInternal::DeviceTypeHandlerMapType::iterator handlerIt = this->Internal->DeviceTypeHandlers.find(std::string(deviceType));
+  if (handlerIt != this->Internal->DeviceTypeHandlers.end())
   {
-    return this->Internal->DeviceTypeToNodeTagMap.find(std::string(deviceType))->second;
+    return handlerIt->second.NodeTags;
   }
   return std::vector<std::string>(0);
 }
 
 //----------------------------------------------------------------------------
-std::vector<std::string> vtkMRMLIGTLConnectorNode::GetDeviceTypeFromMRMLNodeType(const char* nodeTag)
+void vtkMRMLIGTLConnectorNode::RegisterDeviceTypeHandler(const std::string& deviceType, const DeviceTypeHandler& handler)
 {
-#if defined(OpenIGTLink_ENABLE_VIDEOSTREAMING)
-  if (strcmp(nodeTag, "StreamingVolume") == 0)
+  this->Internal->SetDeviceTypeHandler(deviceType, handler);
+  // Node tags of the device type may have changed
+  this->Internal->RebuildIncomingNodeIndex();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::UnregisterDeviceTypeHandler(const std::string& deviceType)
+{
+  this->Internal->RemoveDeviceTypeHandler(deviceType);
+  this->Internal->RebuildIncomingNodeIndex();
+}
+
+//----------------------------------------------------------------------------
+const vtkMRMLIGTLConnectorNode::DeviceTypeHandler* vtkMRMLIGTLConnectorNode::GetDeviceTypeHandler(const std::string& deviceType)
+{
+  vtkInternal::DeviceTypeHandlerMapType::iterator handlerIt = this->Internal->DeviceTypeHandlers.find(deviceType);
+  if (handlerIt == this->Internal->DeviceTypeHandlers.end())
   {
-    std::vector<std::string> deviceTypes;
-    deviceTypes.push_back("VIDEO");
-    deviceTypes.push_back("IMAGE");
-    return deviceTypes;
+    return nullptr;
   }
-#endif
-  if (strcmp(nodeTag, "Volume") == 0 || strcmp(nodeTag, "VectorVolume") == 0)
+  return &(handlerIt->second);
+}
+
+//----------------------------------------------------------------------------
+std::vector<std::string> vtkMRMLIGTLConnectorNode::GetDeviceTypeFromMRMLNodeType(const char* nodeTag)
+{
+  std::vector<std::string> deviceTypes;
+  if (!nodeTag)
   {
-    std::vector<std::string> deviceTypes;
-    deviceTypes.push_back("IMAGE");
     return deviceTypes;
   }
-  if (strcmp(nodeTag, "IGTLStatus") == 0)
-  {
-    return std::vector<std::string>(1, "STATUS");
-  }
-  if (strcmp(nodeTag, "LinearTransform") == 0)
+  for (std::vector<std::string>::iterator deviceTypeIt = this->Internal->DeviceTypeRegistrationOrder.begin();
+    deviceTypeIt != this->Internal->DeviceTypeRegistrationOrder.end(); ++deviceTypeIt)
   {
-    return std::vector<std::string>(1, "TRANSFORM");
-  }
-  if (strcmp(nodeTag, "Model") == 0 || strcmp(nodeTag, "FiberBundle") == 0)
-  {
-    return std::vector<std::string>(1, "POLYDATA");
-  }
-  if (strcmp(nodeTag, "Text") == 0)
-  {
-    return std::vector<std::string>(1, "STRING");
-  }
-  if (strcmp(nodeTag, "MarkupsFiducial") == 0)
-  {
-    return std::vector<std::string>(1, "POINT");
+    const DeviceTypeHandler& handler = this->Internal->DeviceTypeHandlers[*deviceTypeIt];
+    if (handler.AssignOutgoing && std::find(handler.NodeTags.begin(), handler.NodeTags.end(), nodeTag) != handler.NodeTags.end())
+    {
+      deviceTypes.push_back(*deviceTypeIt);
+    }
   }
-
-  return std::vector<std::string>(0);
+  return deviceTypes;
 }
 
 //----------------------------------------------------------------------------
@@ -1330,13 +3598,20 @@ void vtkMRMLIGTLConnectorNode::ProcessMRMLEvents(vtkObject* caller, unsigned lon
     return;
   }
 
+  if (event == vtkCommand::ModifiedEvent)
+  {
+    // OriginalNodeName attribute of an incoming node may have been changed
+    this->Internal->UpdateIncomingNodeIndex(node);
+  }
+
   int n = this->GetNumberOfNodeReferences(this->GetOutgoingNodeReferenceRole());
   for (int i = 0; i < n; i++)
   {
     const char* id = this->GetNthNodeReferenceID(this->GetOutgoingNodeReferenceRole(), i);
     if (strcmp(node->GetID(), id) == 0)
     {
-      this->PushNode(node);
+      this->Internal->RecordOutgoingNodeModification(node, event, callData);
+      this->Internal->PushModifiedOutgoingNode(node);
     }
   }
 }
@@ -1393,15 +3668,34 @@ void vtkMRMLIGTLConnectorNode::ProcessIOConnectorEvents(vtkObject* caller, unsig
     {
       statusDevice->SetMetaDataElement("dummy", "dummy"); // existence of metadata makes the IO connector send a header v2 message
     }
-    connector->SendMessage(igtlioDeviceKeyType::CreateDeviceKey(statusDevice));
+    // The sending thread may be writing to the socket
+    this->Internal->SendOutgoingMessage(igtlioDeviceKeyType::CreateDeviceKey(statusDevice), igtlioDevice::MESSAGE_PREFIX_NOT_DEFINED);
     connector->RemoveDevice(statusDevice);
 
+    // Client IDs may be reused after reconnecting, so all nodes are sent again
+    for (vtkInternal::OutgoingContentStateMapType::iterator stateIt = this->Internal->OutgoingContentStates.begin();
+      stateIt != this->Internal->OutgoingContentStates.end(); ++stateIt)
+    {
+      stateIt->second.ClientIDs.clear();
+    }
     this->PushOnConnect();
   }
   else if (mrmlEvent == DisconnectedEvent)
   {
     vtkInfoMacro("Disconnected: " << connector->GetServerHostname() << ":" << connector->GetServerPort());
   }
+  else if (event == igtlioConnector::RemovedDeviceEvent)
+  {
+    igtlioDevice* removedDevice = static_cast<igtlioDevice*>(callData);
+    this->Internal->DeviceTypeHandlerCache.erase(removedDevice);
+    this->Internal->IncomingImageBufferPools.erase(removedDevice);
+#if defined(OpenIGTLink_ENABLE_VIDEOSTREAMING)
+    if (igtlioVideoDevice::SafeDownCast(removedDevice))
+    {
+      this->Internal->IncomingVideoFramePools.erase(removedDevice->GetDeviceName());
+    }
+#endif
+  }
   else if (event == igtlioConnector::NewDeviceEvent)
   {
     igtlioDevice* modifiedDevice = static_cast<igtlioDevice*>(callData);
@@ -1443,7 +3737,7 @@ void vtkMRMLIGTLConnectorNode::PushOnConnect()
 void vtkMRMLIGTLConnectorNode::ProcessIODeviceEvents(vtkObject* caller, unsigned long event, void* callData)
 {
   igtlioDevice* modifiedDevice = igtlioDevice::SafeDownCast(caller);
-  if (modifiedDevice == NULL)
+  if (modifiedDevice == NULL || this->Internal->IgnoreDeviceEvents)
   {
     return;
   }
@@ -1458,6 +3752,11 @@ void vtkMRMLIGTLConnectorNode::ProcessIODeviceEvents(vtkObject* caller, unsigned
     mrmlEvent = DeviceModifiedEvent;
     if (modifiedDevice->MessageDirectionIsIn())
     {
+      if (this->Internal->CoalesceIncomingDevice(modifiedDevice))
+      {
+        // Content is applied and the event is invoked in PeriodicProcess(), when all messages have been received
+        return;
+      }
       this->ProcessIncomingDeviceModifiedEvent(caller, event, modifiedDevice);
     }
   }
@@ -1495,7 +3794,7 @@ void vtkMRMLIGTLConnectorNode::ProcessIOCommandEvents(vtkObject* caller, unsigne
   igtlioCommand* command = static_cast<igtlioCommand*>(callData);
   if (command)
   {
-    vtkNew<vtkSlicerOpenIGTLinkCommand> slicerCommand;
+    vtkSmartPointer<vtkSlicerOpenIGTLinkCommand> slicerCommand = vtkSmartPointer<vtkSlicerOpenIGTLinkCommand>::New();
     slicerCommand->SetCommand(command);
     this->InvokeEvent(mrmlEvent, slicerCommand);
   }
@@ -1525,6 +3824,16 @@ void vtkMRMLIGTLConnectorNode::WriteXML(ostream& of, int nIndent)
   of << " serverPort=\"" << this->Internal->IOConnector->GetServerPort() << "\" ";
   of << " persistent=\"" << this->Internal->IOConnector->GetPersistent() << "\" ";
   of << " checkCRC=\"" << this->Internal->IOConnector->GetCheckCRC() << "\" ";
+  of << " useBackgroundDecoding=\"" << this->GetUseBackgroundDecoding() << "\" ";
+  of << " lazyVideoDecoding=\"" << this->GetLazyVideoDecoding() << "\" ";
+  of << " coalesceIncomingMessages=\"" << this->GetCoalesceIncomingMessages() << "\" ";
+  of << " processingTimeBudget=\"" << this->GetProcessingTimeBudget() << "\" ";
+  of << " incomingImageBufferPoolSize=\"" << this->GetIncomingImageBufferPoolSize() << "\" ";
+  of << " maximumVideoFrameChainLength=\"" << this->GetMaximumVideoFrameChainLength() << "\" ";
+  of << " maximumVideoFrameChainSize=\"" << this->GetMaximumVideoFrameChainSize() << "\" ";
+  of << " useAsynchronousSending=\"" << this->GetUseAsynchronousSending() << "\" ";
+  of << " outgoingQueueByteBudget=\"" << this->GetOutgoingQueueByteBudget() << "\" ";
+  of << " outgoingQueueDropPolicy=\"" << this->GetOutgoingQueueDropPolicy() << "\" ";
   of << " state=\"" << this->Internal->IOConnector->GetState() << "\"";
   of << " restrictDeviceName=\"" << this->Internal->IOConnector->GetRestrictDeviceName() << "\" ";
   if (this->OutgoingMessageHeaderVersionMaximum > 0)
@@ -1599,6 +3908,86 @@ void vtkMRMLIGTLConnectorNode::ReadXMLAttributes(const char** atts)
       ss >> checkCRC;
       this->SetCheckCRC(checkCRC);
     }
+    if (!strcmp(attName, "useBackgroundDecoding"))
+    {
+      std::stringstream ss;
+      ss << attValue;
+      bool useBackgroundDecoding = false;
+      ss >> useBackgroundDecoding;
+      this->SetUseBackgroundDecoding(useBackgroundDecoding);
+    }
+    if (!strcmp(attName, "lazyVideoDecoding"))
+    {
+      std::stringstream ss;
+      ss << attValue;
+      bool lazyVideoDecoding = true;
+      ss >> lazyVideoDecoding;
+      this->SetLazyVideoDecoding(lazyVideoDecoding);
+    }
+    if (!strcmp(attName, "coalesceIncomingMessages"))
+    {
+      std::stringstream ss;
+      ss << attValue;
+      bool coalesceIncomingMessages = false;
+      ss >> coalesceIncomingMessages;
+      this->SetCoalesceIncomingMessages(coalesceIncomingMessages);
+    }
+    if (!strcmp(attName, "processingTimeBudget"))
+    {
+      std::stringstream ss;
+      ss << attValue;
+      double processingTimeBudget = 0.0;
+      ss >> processingTimeBudget;
+      this->SetProcessingTimeBudget(processingTimeBudget);
+    }
+    if (!strcmp(attName, "incomingImageBufferPoolSize"))
+    {
+      std::stringstream ss;
+      ss << attValue;
+      int incomingImageBufferPoolSize = 3;
+      ss >> incomingImageBufferPoolSize;
+      this->SetIncomingImageBufferPoolSize(incomingImageBufferPoolSize);
+    }
+    if (!strcmp(attName, "maximumVideoFrameChainLength"))
+    {
+      std::stringstream ss;
+      ss << attValue;
+      int maximumVideoFrameChainLength = 0;
+      ss >> maximumVideoFrameChainLength;
+      this->SetMaximumVideoFrameChainLength(maximumVideoFrameChainLength);
+    }
+    if (!strcmp(attName, "maximumVideoFrameChainSize"))
+    {
+      std::stringstream ss;
+      ss << attValue;
+      vtkIdType maximumVideoFrameChainSize = 0;
+      ss >> maximumVideoFrameChainSize;
+      this->SetMaximumVideoFrameChainSize(maximumVideoFrameChainSize);
+    }
+    if (!strcmp(attName, "useAsynchronousSending"))
+    {
+      std::stringstream ss;
+      ss << attValue;
+      bool useAsynchronousSending = false;
+      ss >> useAsynchronousSending;
+      this->SetUseAsynchronousSending(useAsynchronousSending);
+    }
+    if (!strcmp(attName, "outgoingQueueByteBudget"))
+    {
+      std::stringstream ss;
+      ss << attValue;
+      vtkIdType outgoingQueueByteBudget = 0;
+      ss >> outgoingQueueByteBudget;
+      this->SetOutgoingQueueByteBudget(outgoingQueueByteBudget);
+    }
+    if (!strcmp(attName, "outgoingQueueDropPolicy"))
+    {
+      std::stringstream ss;
+      ss << attValue;
+      int outgoingQueueDropPolicy = OutgoingQueueDropOldest;
+      ss >> outgoingQueueDropPolicy;
+      this->SetOutgoingQueueDropPolicy(outgoingQueueDropPolicy);
+    }
     if (!strcmp(attName, "state"))
     {
       std::stringstream ss;
@@ -1674,6 +4063,17 @@ void vtkMRMLIGTLConnectorNode::Copy(vtkMRMLNode* anode)
   }
   this->Internal->IOConnector->SetPersistent(node->Internal->IOConnector->GetPersistent());
   this->SetCheckCRC(node->GetCheckCRC());
+  this->SetUseBackgroundDecoding(node->GetUseBackgroundDecoding());
+  this->SetLazyVideoDecoding(node->GetLazyVideoDecoding());
+  this->SetCoalesceIncomingMessages(node->GetCoalesceIncomingMessages());
+  this->SetProcessingTimeBudget(node->GetProcessingTimeBudget());
+  this->Internal->IncomingMessagePriorities = node->Internal->IncomingMessagePriorities;
+  this->SetIncomingImageBufferPoolSize(node->GetIncomingImageBufferPoolSize());
+  this->SetMaximumVideoFrameChainLength(node->GetMaximumVideoFrameChainLength());
+  this->SetMaximumVideoFrameChainSize(node->GetMaximumVideoFrameChainSize());
+  this->SetUseAsynchronousSending(node->GetUseAsynchronousSending());
+  this->SetOutgoingQueueByteBudget(node->GetOutgoingQueueByteBudget());
+  this->SetOutgoingQueueDropPolicy(node->GetOutgoingQueueDropPolicy());
 }
 
 
@@ -1710,6 +4110,19 @@ void vtkMRMLIGTLConnectorNode::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Restrict Device Name: " << this->Internal->IOConnector->GetRestrictDeviceName() << "\n";
   os << indent << "Push Outgoing Message Flag: " << this->Internal->IOConnector->GetPushOutgoingMessageFlag() << "\n";
   os << indent << "Check CRC: " << this->GetCheckCRC() << "\n";
+  os << indent << "Use background decoding: " << this->GetUseBackgroundDecoding() << "\n";
+  os << indent << "Lazy video decoding: " << this->GetLazyVideoDecoding() << "\n";
+  os << indent << "Coalesce incoming messages: " << this->GetCoalesceIncomingMessages() << "\n";
+  os << indent << "Number of dropped incoming messages: " << this->GetNumberOfDroppedIncomingMessages() << "\n";
+  os << indent << "Processing time budget: " << this->GetProcessingTimeBudget() << "\n";
+  os << indent << "Incoming image buffer pool size: " << this->GetIncomingImageBufferPoolSize() << "\n";
+  os << indent << "Maximum video frame chain length: " << this->GetMaximumVideoFrameChainLength() << "\n";
+  os << indent << "Maximum video frame chain size: " << this->GetMaximumVideoFrameChainSize() << "\n";
+  os << indent << "Use asynchronous sending: " << this->GetUseAsynchronousSending() << "\n";
+  os << indent << "Outgoing queue byte budget: " << this->GetOutgoingQueueByteBudget() << "\n";
+  os << indent << "Outgoing queue drop policy: " << this->GetOutgoingQueueDropPolicy() << "\n";
+  os << indent << "Outgoing queue depth: " << this->GetOutgoingQueueDepth() << "\n";
+  os << indent << "Number of dropped outgoing messages: " << this->GetNumberOfDroppedOutgoingMessages() << "\n";
   os << indent << "Number of outgoing nodes: " << this->GetNumberOfOutgoingMRMLNodes() << "\n";
   os << indent << "Number of incoming nodes: " << this->GetNumberOfIncomingMRMLNodes() << "\n";
 }
@@ -1739,6 +4152,8 @@ void vtkMRMLIGTLConnectorNode::OnNodeReferenceAdded(vtkMRMLNodeReference* refere
     nodeInfo.second = 0;
     nodeInfo.nanosecond = 0;
     this->Internal->IncomingMRMLNodeInfoMap[node->GetID()] = nodeInfo;
+    // OriginalNodeName attribute is already set if the node reference is restored from a saved scene
+    this->Internal->AddIncomingNodeToIndex(node);
   }
   else if (strcmp(reference->GetReferenceRole(), this->GetOutgoingNodeReferenceRole()) == 0)
   {
@@ -1817,6 +4232,12 @@ void vtkMRMLIGTLConnectorNode::OnNodeReferenceAdded(vtkMRMLNodeReference* refere
       {
         vtkSmartPointer<vtkIntArray> nodeEvents = vtkSmartPointer<vtkIntArray>::New();
         nodeEvents->InsertNextValue(nodeModifiedEvent);
+        if (node->IsA("vtkMRMLMarkupsNode"))
+        {
+          // Added and removed points are observed to update only the modified points of the outgoing content
+          nodeEvents->InsertNextValue(vtkMRMLMarkupsNode::PointAddedEvent);
+          nodeEvents->InsertNextValue(vtkMRMLMarkupsNode::PointRemovedEvent);
+        }
         this->SetAndObserveNthNodeReferenceID(this->GetOutgoingNodeReferenceRole(), i,
           node->GetID(), nodeEvents);
         break;
@@ -1844,6 +4265,8 @@ void vtkMRMLIGTLConnectorNode::OnNodeReferenceRemoved(vtkMRMLNodeReference* refe
     {
       this->Internal->IncomingMRMLNodeInfoMap.erase(iter);
     }
+    this->Internal->RebuildIncomingNodeIndex();
+    this->Internal->RemoveDeletedIncomingNodeClientIDs();
     vtkInternal::MessageDeviceMapType::iterator citer = this->Internal->IncomingMRMLIDToDeviceMap.find(nodeID);
     if (citer != this->Internal->IncomingMRMLIDToDeviceMap.end())
     {
@@ -1869,6 +4292,10 @@ void vtkMRMLIGTLConnectorNode::OnNodeReferenceRemoved(vtkMRMLNodeReference* refe
     {
       vtkErrorMacro("Node is not found in OutgoingMRMLIDToDeviceMap: " << nodeID);
     }
+    this->Internal->OutgoingRateLimitStates.erase(nodeID);
+    this->Internal->OutgoingPointCaches.erase(nodeID);
+    this->Internal->OutgoingTrackingDataCaches.erase(nodeID);
+    this->Internal->OutgoingContentStates.erase(nodeID);
   }
 }
 
@@ -1962,6 +4389,7 @@ bool vtkMRMLIGTLConnectorNode::RegisterIncomingMRMLNode(vtkMRMLNode* node, IGTLD
     this->Modified();
   }
   node->SetAttribute(OriginalNodeNameKey, node->GetName());
+  this->Internal->AddIncomingNodeToIndex(node);
   return true;
 
 }
@@ -2170,7 +4598,7 @@ vtkMRMLNode* vtkMRMLIGTLConnectorNode::GetIncomingMRMLNode(unsigned int i)
 }
 
 //---------------------------------------------------------------------------
-int vtkMRMLIGTLConnectorNode::PushNode(vtkMRMLNode* node)
+int vtkMRMLIGTLConnectorNode::PushNode(vtkMRMLNode* node, bool forcePush)
 {
   if (!node)
   {
@@ -2198,74 +4626,88 @@ int vtkMRMLIGTLConnectorNode::PushNode(vtkMRMLNode* node)
   igtlioDeviceKeyType key;
   key.name = device->GetDeviceName();
   key.type = device->GetDeviceType();
-  device->ClearMetaData();
-  if (this->OutgoingMessageHeaderVersionMaximum < 0 || this->OutgoingMessageHeaderVersionMaximum >= IGTL_HEADER_VERSION_2)
+  // Content is only assigned to the device and sent to clients that have not received it yet if it changed since the last push
+  const DeviceTypeHandler* handler = this->Internal->GetDeviceTypeHandler(device);
+  vtkTypeUInt64 fingerprint = 0;
+  if (handler && handler->OutgoingContentFingerprint)
   {
-    device->SetMetaDataElement(MRMLNodeNameKey, IANA_TYPE_US_ASCII, node->GetNodeTagName());
-    if (node->IsA("vtkMRMLTransformNode"))
-    {
-      const char* transformStatusAttribute = node->GetAttribute("TransformStatus");
-      if (transformStatusAttribute)
-      {
-        device->SetMetaDataElement("TransformStatus", transformStatusAttribute);
-      }
-      else
-      {
-        // If no transform status is specified, the transform node is assumed to be valid.
-        // Transform status should be set to "OK", rather than "UNKNOWN" to reflect this.
-        device->SetMetaDataElement("TransformStatus", "OK");
-      }
-    }
-    else
+    fingerprint = handler->OutgoingContentFingerprint(this, node);
+  }
+  vtkInternal::OutgoingContentState& contentState = this->Internal->OutgoingContentStates[node->GetID()];
+  if (forcePush || fingerprint == 0 || fingerprint != contentState.Fingerprint)
+  {
+    contentState.Fingerprint = fingerprint;
+    contentState.ClientIDs.clear();
+    device->ClearMetaData();
+    if (this->OutgoingMessageHeaderVersionMaximum < 0 || this->OutgoingMessageHeaderVersionMaximum >= IGTL_HEADER_VERSION_2)
     {
-      const char* statusAttribute = node->GetAttribute("Status");
-      if (statusAttribute)
+      device->SetMetaDataElement(MRMLNodeNameKey, IANA_TYPE_US_ASCII, node->GetNodeTagName());
+      if (node->IsA("vtkMRMLTransformNode"))
       {
-        device->SetMetaDataElement("Status", statusAttribute);
+        const char* transformStatusAttribute = node->GetAttribute("TransformStatus");
+        if (transformStatusAttribute)
+        {
+          device->SetMetaDataElement("TransformStatus", transformStatusAttribute);
+        }
+        else
+        {
+          // If no transform status is specified, the transform node is assumed to be valid.
+          // Transform status should be set to "OK", rather than "UNKNOWN" to reflect this.
+          device->SetMetaDataElement("TransformStatus", "OK");
+        }
       }
       else
       {
-        // If no status is specified, the node is assumed to be valid.
-        // Status should be set to "OK", rather than "UNKNOWN" to reflect this.
-        device->SetMetaDataElement("Status", "OK");
+        const char* statusAttribute = node->GetAttribute("Status");
+        if (statusAttribute)
+        {
+          device->SetMetaDataElement("Status", statusAttribute);
+        }
+        else
+        {
+          // If no status is specified, the node is assumed to be valid.
+          // Status should be set to "OK", rather than "UNKNOWN" to reflect this.
+          device->SetMetaDataElement("Status", "OK");
+        }
       }
     }
-  }
 
-  device->RemoveObservers(device->GetDeviceContentModifiedEvent());
-  this->AssignOutGoingNodeToDevice(node, device); // update the device content
-  device->AddObserver(device->GetDeviceContentModifiedEvent(), this, &vtkMRMLIGTLConnectorNode::ProcessIODeviceEvents);
-
-
-  int incomingClientID = -1;
-  vtkInternal::IncomingNodeClientIDMapType::iterator incomingClientIDIt = this->Internal->IncomingNodeClientIDMap.find(node->GetName());
-  if (incomingClientIDIt != this->Internal->IncomingNodeClientIDMap.end())
-  {
-    incomingClientID = incomingClientIDIt->second;
+    device->RemoveObservers(device->GetDeviceContentModifiedEvent());
+    this->AssignOutGoingNodeToDevice(node, device); // update the device content
+    device->AddObserver(device->GetDeviceContentModifiedEvent(), this, &vtkMRMLIGTLConnectorNode::ProcessIODeviceEvents);
   }
 
-  // Send the node to all connected clients
+  int incomingClientID = this->Internal->GetIncomingNodeClientID(node);
+
+  // Send the node to all connected clients that have not received the current content
   std::vector<int> clientIDs = this->Internal->IOConnector->GetClientIds();
+  std::vector<int> targetClientIDs;
   for (std::vector<int>::iterator clientIDIt = clientIDs.begin(); clientIDIt != clientIDs.end(); ++clientIDIt)
   {
-    int clientID = *clientIDIt;
-    if (clientID == incomingClientID)
-    {
-      // The message was originally received from this client.
-      // We don't need to send it back.
-      continue;
-    }
-
-    if ((strcmp(node->GetClassName(), "vtkMRMLIGTLQueryNode") != 0))
+    // The message was originally received from the incoming client, we don't need to send it back.
+    if (contentState.ClientIDs.insert(*clientIDIt).second && *clientIDIt != incomingClientID)
     {
-      this->Internal->IOConnector->SendMessage(key, igtlioDevice::MESSAGE_PREFIX_NOT_DEFINED, clientID);
-    }
-    else if (strcmp(node->GetClassName(), "vtkMRMLIGTLQueryNode") == 0)
-    {
-      this->Internal->IOConnector->SendMessage(key, device->MESSAGE_PREFIX_RTS, clientID);
+      targetClientIDs.push_back(*clientIDIt);
     }
   }
-
+  if (targetClientIDs.empty())
+  {
+    return 0;
+  }
+  if (this->Internal->UseAsynchronousSending)
+  {
+    // The message is sent by the sending thread, so a slow client does not block the caller
+    this->Internal->QueueOutgoingDevice(device, targetClientIDs, incomingClientID);
+    return 0;
+  }
+  if (targetClientIDs.size() == clientIDs.size())
+  {
+    // The message is packed once and the same buffer is sent to all clients
+    this->Internal->SendOutgoingMessage(key, igtlioDevice::MESSAGE_PREFIX_NOT_DEFINED);
+    return 0;
+  }
+  // Some clients are excluded, the message is still packed only once
+  this->Internal->SendOutgoingMessageToClients(device, igtlioDevice::MESSAGE_PREFIX_NOT_DEFINED, targetClientIDs);
   return 0;
 }
 
@@ -2311,13 +4753,11 @@ int vtkMRMLIGTLConnectorNode::PushQuery(vtkMRMLIGTLQueryNode* node)
     prefix = igtlioDevice::MESSAGE_PREFIX_STOP;
   }
 
-  this->Internal->IOConnector->SendMessage(key, prefix);
-  this->QueryQueueMutex.lock();
+  this->Internal->SendOutgoingMessage(key, prefix);
   node->SetTimeStamp(vtkTimerLog::GetUniversalTime());
   node->SetQueryStatus(vtkMRMLIGTLQueryNode::STATUS_WAITING);
   node->SetConnectorNodeID(this->GetID());
-  this->QueryWaitingQueue.push_back(node);
-  this->QueryQueueMutex.unlock();
+  this->Internal->AddPendingQueryNode(node);
   return 0;
 }
 
@@ -2341,10 +4781,15 @@ void vtkMRMLIGTLConnectorNode::CancelQuery(vtkMRMLIGTLQueryNode* node)
     vtkErrorMacro("vtkMRMLIGTLConnectorNode::CancelQuery failed: invalid input node");
     return;
   }
-  this->QueryQueueMutex.lock();
-  this->QueryWaitingQueue.remove(node);
+  this->Internal->RemovePendingQueryNode(node);
   node->SetConnectorNodeID("");
-  this->QueryQueueMutex.unlock();
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLIGTLConnectorNode::GetNumberOfPendingQueries()
+{
+  std::lock_guard<std::mutex> lock(this->QueryQueueMutex);
+  return static_cast<int>(this->Internal->PendingQueries.size());
 }
 
 //---------------------------------------------------------------------------
@@ -2508,29 +4953,128 @@ int vtkMRMLIGTLConnectorNode::Start()
 int vtkMRMLIGTLConnectorNode::Stop()
 {
   int status = this->Internal->IOConnector->Stop();
+  this->Internal->RemoveDisconnectedOutgoingQueues();
   this->Modified();
   return status;
 }
 
 //---------------------------------------------------------------------------
-void vtkMRMLIGTLConnectorNode::PeriodicProcess()
+void vtkMRMLIGTLConnectorNode::PeriodicProcess()
+{
+  SlicerRenderBlocker renderBlocker;
+
+  double deadline = 0.0;
+  if (this->Internal->ProcessingTimeBudget > 0.0)
+  {
+    deadline = vtkTimerLog::GetUniversalTime() + this->Internal->ProcessingTimeBudget;
+  }
+
+  // Messages that arrive from now on request processing again
+  this->Internal->ReceivedMessagesProcessingRequested = false;
+  this->Internal->IOConnector->PeriodicProcess();
+
+  if (this->Internal->UseAsynchronousSending)
+  {
+    this->Internal->RemoveDisconnectedOutgoingQueues();
+  }
+
+  // Only the latest message of each device is applied
+  this->Internal->ApplyCoalescedDevices(deadline);
+
+  if (this->Internal->UseBackgroundDecoding)
+  {
+    this->Internal->ApplyDecodedFrames(deadline);
+  }
+
+  while (!this->Internal->PendingNodeModifications.empty())
+  {
+    vtkInternal::NodeModification wasModifying = this->Internal->PendingNodeModifications.back();
+    wasModifying.Node->EndModify(wasModifying.Modifying);
+    this->Internal->SetIncomingNodeClientID(wasModifying.Node, -1);
+    this->Internal->PendingNodeModifications.pop_back();
+  }
+
+  // Trailing sends of rate limited outgoing nodes
+  this->Internal->PushPendingRateLimitedNodes();
+
+  this->Internal->RemoveExpiredQueries();
+}
+
+//---------------------------------------------------------------------------
+double vtkMRMLIGTLConnectorNode::GetTimeUntilNextProcessing()
 {
-  SlicerRenderBlocker renderBlocker;
+  // Without a processing request callback nothing notifies about received messages, so the connector is polled
+  const double pollingInterval = 0.005;
+  // Received messages, connection state changes, decoded frames, and new deadlines request processing,
+  // the fallback interval only limits the time that a missed request could delay the processing
+  const double idleFallbackInterval = 1.0;
 
-  this->Internal->IOConnector->PeriodicProcess();
+  if (this->Internal->UseBackgroundDecoding && this->Internal->DecodedFrames.GetSize() > 0)
+  {
+    return 0.0;
+  }
+  if (!this->Internal->CoalescedDevices.empty())
+  {
+    // Processing of received messages has been interrupted because of the processing time budget
+    return 0.0;
+  }
 
-  while (!this->Internal->PendingNodeModifications.empty())
+  double delay = pollingInterval;
   {
-    vtkInternal::NodeModification wasModifying = this->Internal->PendingNodeModifications.back();
-    wasModifying.Node->EndModify(wasModifying.Modifying);
-    if (wasModifying.Node->GetName())
+    std::lock_guard<std::mutex> lock(this->Internal->ProcessingRequestMutex);
+    if (this->Internal->ProcessingRequestCallback)
     {
-      this->Internal->IncomingNodeClientIDMap[wasModifying.Node->GetName()] = -1;
+      delay = idleFallbackInterval;
     }
-    this->Internal->PendingNodeModifications.pop_back();
   }
 
-  this->Internal->RemoveExpiredQueries();
+  double currentTime = vtkTimerLog::GetUniversalTime();
+  vtkMRMLScene* scene = this->GetScene();
+  for (vtkInternal::OutgoingRateLimitStateMapType::iterator stateIt = this->Internal->OutgoingRateLimitStates.begin();
+    scene && stateIt != this->Internal->OutgoingRateLimitStates.end(); ++stateIt)
+  {
+    if (!stateIt->second.PushPending)
+    {
+      continue;
+    }
+    double maximumSendRate = vtkMRMLIGTLConnectorNode::GetOutgoingNodeMaximumSendRate(scene->GetNodeByID(stateIt->first));
+    double pushDelay = 0.0;
+    if (maximumSendRate > 0.0)
+    {
+      pushDelay = std::max(0.0, stateIt->second.LastPushTime + 1.0 / maximumSendRate - currentTime);
+    }
+    delay = std::min(delay, pushDelay);
+  }
+
+  {
+    // Expiration of the earliest query. Deadlines of answered queries may remain in the queue,
+    // they only cause an early processing call.
+    std::lock_guard<std::mutex> lock(this->QueryQueueMutex);
+    if (!this->Internal->QueryDeadlines.empty())
+    {
+      delay = std::min(delay, std::max(0.0, this->Internal->QueryDeadlines.top().first - currentTime));
+    }
+  }
+  return delay;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::SetProcessingRequestCallback(ProcessingRequestCallbackType callback, void* clientData)
+{
+  if (!callback)
+  {
+    // The monitor thread is stopped first, as it may be waiting for the mutex to invoke the callback
+    this->Internal->StopReceiveMonitorThread();
+  }
+  {
+    std::lock_guard<std::mutex> lock(this->Internal->ProcessingRequestMutex);
+    this->Internal->ProcessingRequestCallback = callback;
+    this->Internal->ProcessingRequestClientData = clientData;
+  }
+  if (callback)
+  {
+    this->Internal->StartReceiveMonitorThread();
+  }
 }
 
 //---------------------------------------------------------------------------
@@ -2600,6 +5144,7 @@ IGTLDevicePointer vtkMRMLIGTLConnectorNode::CreateDeviceForOutgoingMRMLNode(vtkM
       device = this->Internal->IOConnector->GetDeviceFactory()->create(key.type, key.name);
       if (device)
       {
+        this->Internal->OutgoingContentStates.erase(dnode->GetID());
         this->Internal->OutgoingMRMLIDToDeviceMap[dnode->GetID()] = device;
         this->Internal->IOConnector->AddDevice(device);
       }
@@ -2679,6 +5224,351 @@ void vtkMRMLIGTLConnectorNode::SetServerPort(int port)
   this->Modified();
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::SetUseBackgroundDecoding(bool useBackgroundDecoding)
+{
+  if (this->Internal->UseBackgroundDecoding == useBackgroundDecoding)
+  {
+    return;
+  }
+  this->Internal->UseBackgroundDecoding = useBackgroundDecoding;
+  if (useBackgroundDecoding)
+  {
+    this->Internal->StartDecodeThread();
+  }
+  else
+  {
+    this->Internal->StopDecodeThread();
+    // Hand over the frames that are still queued to the volume nodes.
+    // The frames that have not been decoded yet are decoded on the main thread, so that the codecs
+    // of the decoding thread stay up-to-date for cut chains.
+    this->Internal->ApplyDecodedFrames();
+    vtkInternal::FrameDecodeTask task;
+    while (this->Internal->PendingFrameDecodes.Pop(task))
+    {
+      this->Internal->DecodeQueuedFrame(task);
+      this->Internal->ApplyQueuedFrame(task);
+    }
+  }
+  // The new decoder has not decoded the frames before the cut of the chain
+  this->Internal->KeepDecodersOfCutChains();
+  this->Modified();
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLIGTLConnectorNode::GetUseBackgroundDecoding()
+{
+  return this->Internal->UseBackgroundDecoding;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::SetLazyVideoDecoding(bool lazyVideoDecoding)
+{
+  if (this->Internal->LazyVideoDecoding == lazyVideoDecoding)
+  {
+    return;
+  }
+  this->Internal->LazyVideoDecoding = lazyVideoDecoding;
+  this->Modified();
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLIGTLConnectorNode::GetLazyVideoDecoding()
+{
+  return this->Internal->LazyVideoDecoding;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::SetCoalesceIncomingMessages(bool coalesce)
+{
+  if (this->Internal->CoalesceIncomingMessages == coalesce)
+  {
+    return;
+  }
+  this->Internal->CoalesceIncomingMessages = coalesce;
+  if (!coalesce)
+  {
+    this->Internal->ApplyCoalescedDevices();
+  }
+  this->Modified();
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLIGTLConnectorNode::GetCoalesceIncomingMessages()
+{
+  return this->Internal->CoalesceIncomingMessages;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::SetProcessingTimeBudget(double budget)
+{
+  budget = std::max(0.0, budget);
+  if (this->Internal->ProcessingTimeBudget == budget)
+  {
+    return;
+  }
+  this->Internal->ProcessingTimeBudget = budget;
+  if (budget <= 0.0 && !this->Internal->CoalesceIncomingMessages)
+  {
+    this->Internal->ApplyCoalescedDevices();
+  }
+  this->Modified();
+}
+
+//---------------------------------------------------------------------------
+double vtkMRMLIGTLConnectorNode::GetProcessingTimeBudget()
+{
+  return this->Internal->ProcessingTimeBudget;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::SetIncomingMessagePriority(const std::string& deviceType, int priority)
+{
+  if (this->GetIncomingMessagePriority(deviceType) == priority)
+  {
+    return;
+  }
+  this->Internal->IncomingMessagePriorities[deviceType] = priority;
+  this->Modified();
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLIGTLConnectorNode::GetIncomingMessagePriority(const std::string& deviceType)
+{
+  std::map<std::string, int>::iterator priorityIt = this->Internal->IncomingMessagePriorities.find(deviceType);
+  if (priorityIt == this->Internal->IncomingMessagePriorities.end())
+  {
+    return 0;
+  }
+  return priorityIt->second;
+}
+
+//---------------------------------------------------------------------------
+unsigned long vtkMRMLIGTLConnectorNode::GetNumberOfDroppedIncomingMessages()
+{
+  return this->Internal->NumberOfDroppedIncomingMessages;
+}
+
+//---------------------------------------------------------------------------
+unsigned long vtkMRMLIGTLConnectorNode::GetNumberOfDroppedIncomingMessages(const std::string& deviceType, const std::string& deviceName)
+{
+  vtkInternal::DroppedMessageCountMapType::iterator countIt =
+    this->Internal->DroppedIncomingMessageCounts.find(std::make_pair(deviceType, deviceName));
+  if (countIt == this->Internal->DroppedIncomingMessageCounts.end())
+  {
+    return 0;
+  }
+  return countIt->second;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::ResetNumberOfDroppedIncomingMessages()
+{
+  this->Internal->DroppedIncomingMessageCounts.clear();
+  this->Internal->NumberOfDroppedIncomingMessages = 0;
+}
+
+//---------------------------------------------------------------------------
+unsigned long vtkMRMLIGTLConnectorNode::GetNumberOfPackedOutgoingMessages()
+{
+  return this->Internal->NumberOfPackedOutgoingMessages;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::SetOutgoingNodeMaximumSendRate(vtkMRMLNode* node, double maximumSendRate)
+{
+  if (!node)
+  {
+    return;
+  }
+  if (maximumSendRate <= 0.0)
+  {
+    node->RemoveAttribute(OutgoingNodeMaximumSendRateKey);
+    return;
+  }
+  std::stringstream ss;
+  ss << maximumSendRate;
+  node->SetAttribute(OutgoingNodeMaximumSendRateKey, ss.str().c_str());
+}
+
+//---------------------------------------------------------------------------
+double vtkMRMLIGTLConnectorNode::GetOutgoingNodeMaximumSendRate(vtkMRMLNode* node)
+{
+  if (!node)
+  {
+    return 0.0;
+  }
+  const char* maximumSendRate = node->GetAttribute(OutgoingNodeMaximumSendRateKey);
+  if (!maximumSendRate)
+  {
+    return 0.0;
+  }
+  return atof(maximumSendRate);
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::SetUseAsynchronousSending(bool useAsynchronousSending)
+{
+  if (this->Internal->UseAsynchronousSending == useAsynchronousSending)
+  {
+    return;
+  }
+  this->Internal->UseAsynchronousSending = useAsynchronousSending;
+  if (useAsynchronousSending)
+  {
+    this->Internal->StartSenderThreads();
+  }
+  else
+  {
+    this->Internal->StopSenderThreads();
+    // Messages that are still queued are sent in order
+    this->Internal->FlushOutgoingQueues();
+  }
+  this->Modified();
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLIGTLConnectorNode::GetUseAsynchronousSending()
+{
+  return this->Internal->UseAsynchronousSending;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::SetOutgoingQueueByteBudget(vtkIdType budget)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->Internal->OutgoingQueueMutex);
+    if (this->Internal->OutgoingQueueByteBudget == budget)
+    {
+      return;
+    }
+    this->Internal->OutgoingQueueByteBudget = budget;
+  }
+  this->Modified();
+}
+
+//---------------------------------------------------------------------------
+vtkIdType vtkMRMLIGTLConnectorNode::GetOutgoingQueueByteBudget()
+{
+  return this->Internal->OutgoingQueueByteBudget;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::SetOutgoingQueueDropPolicy(int policy)
+{
+  if (policy < 0 || policy >= OutgoingQueueDropPolicy_Last)
+  {
+    vtkErrorMacro("SetOutgoingQueueDropPolicy: invalid policy " << policy);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(this->Internal->OutgoingQueueMutex);
+    if (this->Internal->OutgoingQueueDropPolicy == policy)
+    {
+      return;
+    }
+    this->Internal->OutgoingQueueDropPolicy = policy;
+  }
+  this->Modified();
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLIGTLConnectorNode::GetOutgoingQueueDropPolicy()
+{
+  return this->Internal->OutgoingQueueDropPolicy;
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLIGTLConnectorNode::GetOutgoingQueueDepth()
+{
+  std::lock_guard<std::mutex> lock(this->Internal->OutgoingQueueMutex);
+  int depth = 0;
+  for (vtkInternal::OutgoingQueueMapType::iterator queueIt = this->Internal->OutgoingQueues.begin(); queueIt != this->Internal->OutgoingQueues.end(); ++queueIt)
+  {
+    depth += static_cast<int>(queueIt->second->Messages.size());
+  }
+  return depth;
+}
+
+//---------------------------------------------------------------------------
+vtkIdType vtkMRMLIGTLConnectorNode::GetOutgoingQueueSize()
+{
+  std::lock_guard<std::mutex> lock(this->Internal->OutgoingQueueMutex);
+  vtkIdType size = 0;
+  for (vtkInternal::OutgoingQueueMapType::iterator queueIt = this->Internal->OutgoingQueues.begin(); queueIt != this->Internal->OutgoingQueues.end(); ++queueIt)
+  {
+    size += queueIt->second->Size;
+  }
+  return size;
+}
+
+//---------------------------------------------------------------------------
+unsigned long vtkMRMLIGTLConnectorNode::GetNumberOfDroppedOutgoingMessages()
+{
+  std::lock_guard<std::mutex> lock(this->Internal->OutgoingQueueMutex);
+  return this->Internal->NumberOfDroppedOutgoingMessages;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::ResetNumberOfDroppedOutgoingMessages()
+{
+  std::lock_guard<std::mutex> lock(this->Internal->OutgoingQueueMutex);
+  this->Internal->NumberOfDroppedOutgoingMessages = 0;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::SetIncomingImageBufferPoolSize(int size)
+{
+  if (this->Internal->IncomingImageBufferPoolSize == size)
+  {
+    return;
+  }
+  this->Internal->IncomingImageBufferPoolSize = size;
+  // Buffers that are in use remain referenced by the volume nodes
+  this->Internal->IncomingImageBufferPools.clear();
+  this->Modified();
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLIGTLConnectorNode::GetIncomingImageBufferPoolSize()
+{
+  return this->Internal->IncomingImageBufferPoolSize;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::SetMaximumVideoFrameChainLength(int length)
+{
+  if (this->Internal->MaximumVideoFrameChainLength == length)
+  {
+    return;
+  }
+  this->Internal->MaximumVideoFrameChainLength = length;
+  this->Modified();
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLIGTLConnectorNode::GetMaximumVideoFrameChainLength()
+{
+  return this->Internal->MaximumVideoFrameChainLength;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLIGTLConnectorNode::SetMaximumVideoFrameChainSize(vtkIdType size)
+{
+  if (this->Internal->MaximumVideoFrameChainSize == size)
+  {
+    return;
+  }
+  this->Internal->MaximumVideoFrameChainSize = size;
+  this->Modified();
+}
+
+//---------------------------------------------------------------------------
+vtkIdType vtkMRMLIGTLConnectorNode::GetMaximumVideoFrameChainSize()
+{
+  return this->Internal->MaximumVideoFrameChainSize;
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLIGTLConnectorNode::SetCheckCRC(bool check)
 {
@@ -38,7 +38,9 @@
 #include <igtlioStringDevice.h>
 
 // std includes
+#include <functional>
 #include <list>
+#include <mutex>
 
 class vtkMRMLIGTLQueryNode;
 class vtkSlicerOpenIGTLinkCommand;
@@ -83,6 +85,14 @@ public:
     Type_Last // this line must be last
   };
 
+  enum
+  {
+    OutgoingQueueDropOldest, // remove the oldest queued messages of the client to make room for the new message
+    OutgoingQueueDropNewest, // do not queue the new message
+    OutgoingQueueBlock,      // wait until the sending thread of the client makes room for the new message
+    OutgoingQueueDropPolicy_Last // this line must be last
+  };
+
   static vtkMRMLIGTLConnectorNode* New();
   vtkTypeMacro(vtkMRMLIGTLConnectorNode, vtkMRMLNode);
 
@@ -133,9 +143,16 @@ public:
   int Stop();
 
   /// Call periodically to perform processing in the main thread.
-  /// Suggested timeout 5ms.
+  /// Suggested timeout 5ms, or the time returned by GetTimeUntilNextProcessing().
   void PeriodicProcess();
 
+  /// Time in seconds until PeriodicProcess() should be called next.
+  /// Returns 0 if decoded video frames or received messages are waiting to be applied. Otherwise returns the polling
+  /// interval (5ms) if no processing request callback is set, and a long fallback interval (1s) if the callback
+  /// notifies about received messages. Never longer than the time until the next deferred push of a rate limited
+  /// outgoing node or the expiration of a pending query.
+  double GetTimeUntilNextProcessing();
+
   void ConnectEvents();
   // Description:
   // Set and start observing MRML node for outgoing data.
@@ -218,23 +235,113 @@ public:
 
   void SetRestrictDeviceName(int restrictDeviceName);
 
+  // Controls if received video frames are decoded in a background thread.
+  // If enabled then PeriodicProcess() only applies the already decoded frames to the
+  // streaming volume nodes, so decoding does not block the main thread.
+  // If the decoding queue is full then the frame is applied on the main thread instead.
+  // When this is changed while the frame chain is cut (see MaximumVideoFrameChainLength), the frames are decoded
+  // by the previous decoder (on the main thread) until the next key frame.
+  // Receiving and unpacking of messages is performed by the OpenIGTLinkIO connector.
+  bool GetUseBackgroundDecoding();
+  void SetUseBackgroundDecoding(bool useBackgroundDecoding);
+
+  // Controls if images of streaming volumes that are not displayed are created in the background decoding thread.
+  // If enabled (default) then frames of volumes that are not shown in a slice view or by volume rendering
+  // are only decoded to keep the decoder up-to-date, and the volume node decodes the image only if it is requested.
+  bool GetLazyVideoDecoding();
+  void SetLazyVideoDecoding(bool lazyVideoDecoding);
+
+  // Controls if only the latest received message of each device is applied to MRML.
+  // If enabled then messages are applied in PeriodicProcess() after all buffered messages are received,
+  // and messages that are replaced by a newer message of the same device are dropped.
+  // This limits the time needed to catch up after the main thread was blocked.
+  // Video messages are never dropped, as all frames are needed for decoding.
+  bool GetCoalesceIncomingMessages();
+  void SetCoalesceIncomingMessages(bool coalesce);
+
+  // Maximum time in seconds that PeriodicProcess() spends on processing received messages (default: 0, no limit).
+  // If set then the latest message of each device is applied in the order of the message type priority until
+  // the time is used up, and the remaining devices are applied in the next PeriodicProcess() call.
+  // As with coalescing, a message that is replaced by a newer message of the same device before being applied is dropped.
+  // Video messages are applied when received, only the application of decoded frames (see UseBackgroundDecoding) is deferred.
+  double GetProcessingTimeBudget();
+  void SetProcessingTimeBudget(double budget);
+
+  // Priority of received messages of a device type when the processing time is limited.
+  // Messages with higher priority are applied first. Default: 1 for TRANSFORM, POSITION, TDATA and QTDATA,
+  // -1 for IMAGE, POLYDATA and VIDEO, 0 for other types.
+  int GetIncomingMessagePriority(const std::string& deviceType);
+  void SetIncomingMessagePriority(const std::string& deviceType, int priority);
+
+  // Number of incoming messages that have been dropped because of coalescing.
+  unsigned long GetNumberOfDroppedIncomingMessages();
+  unsigned long GetNumberOfDroppedIncomingMessages(const std::string& deviceType, const std::string& deviceName);
+  void ResetNumberOfDroppedIncomingMessages();
+
+  // Number of image buffers that are recycled for each incoming IMAGE device (default: 3).
+  // Received images are written into a buffer that is not used by the volume node, and the buffer is
+  // then swapped into the volume node, so no image data is allocated or copied once all buffers exist.
+  // 0 disables the pool: received images are written into the image data that is shown in the volume node.
+  int GetIncomingImageBufferPoolSize();
+  void SetIncomingImageBufferPoolSize(int size);
+
+  // Limits of the chain of video frames that are kept in memory for each incoming VIDEO device.
+  // Each frame that is not a key frame references the previous frame, so that it can be decoded.
+  // When the chain since the last key frame exceeds the maximum number of frames or total bitstream size (in bytes),
+  // the current frame is decoded immediately and the references to the previous frames are released.
+  // With background decoding, the frames from the cut until the next key frame are decoded in the decoding thread,
+  // even if lazy video decoding is enabled, as the volume node cannot decode them.
+  // 0 means no limit (default).
+  int GetMaximumVideoFrameChainLength();
+  void SetMaximumVideoFrameChainLength(int length);
+  vtkIdType GetMaximumVideoFrameChainSize();
+  void SetMaximumVideoFrameChainSize(vtkIdType size);
+
   // Description:
   // A function to explicitly push node to OpenIGTLink. The function is called either by
   // external nodes or MRML event hander in the connector node.
-  int PushNode(vtkMRMLNode* node);
+  // If the content of the node has not changed since the last push (see DeviceTypeHandler::OutgoingContentFingerprint)
+  // then the node is only sent to clients that have not received it yet, unless forcePush is set.
+  int PushNode(vtkMRMLNode* node, bool forcePush = false);
+
+  // Number of outgoing messages that have been packed (serialized).
+  // A pushed node is packed once and sent to all clients, unless it has to be skipped for the client it was received from.
+  unsigned long GetNumberOfPackedOutgoingMessages();
+
+  // Controls if pushed nodes are sent by background sending threads.
+  // If enabled then PushNode() packs the message and adds it to an outgoing queue for each client.
+  // Each client has its own sending thread, so that a slow or congested client does not block
+  // the caller (typically the GUI thread) or the other clients.
+  bool GetUseAsynchronousSending();
+  void SetUseAsynchronousSending(bool useAsynchronousSending);
+
+  // Maximum total size of the queued messages of each client in bytes (default: 64MB). 0 means no limit.
+  vtkIdType GetOutgoingQueueByteBudget();
+  void SetOutgoingQueueByteBudget(vtkIdType budget);
+
+  // What to do when a message does not fit into the byte budget of a client queue (default: OutgoingQueueDropOldest).
+  int GetOutgoingQueueDropPolicy();
+  void SetOutgoingQueueDropPolicy(int policy);
+
+  // Number of messages and bytes waiting in the outgoing queues of all clients
+  int GetOutgoingQueueDepth();
+  vtkIdType GetOutgoingQueueSize();
+
+  // Number of outgoing messages that have been dropped because of the byte budget
+  unsigned long GetNumberOfDroppedOutgoingMessages();
+  void ResetNumberOfDroppedOutgoingMessages();
+
+  // Maximum rate (in Hz) at which modifications of an outgoing node are sent, stored in the
+  // "OpenIGTLinkIF.out.maximumSendRate" attribute of the node. Modifications between sends are coalesced
+  // and the latest state is sent when the interval elapsed (in PeriodicProcess()), so the final value is always sent.
+  // 0 (default) means that each modification is sent immediately.
+  static void SetOutgoingNodeMaximumSendRate(vtkMRMLNode* node, double maximumSendRate);
+  static double GetOutgoingNodeMaximumSendRate(vtkMRMLNode* node);
 
   // Description:
   // Calls PushNode() for all nodes with the "OpenIGTLinkIF.pushOnConnect" attribute set to "true"
   void PushOnConnect();
 
-  typedef std::list< vtkWeakPointer<vtkMRMLIGTLQueryNode> > QueryListType;
-  // Query queueing mechanism is needed to send all queries from the connector thread.
-  // Queries can be pushed to the end of the QueryQueue by calling RequestInvoke from any thread,
-  // and they will be Invoked in the main thread.
-  // Use a weak pointer to make sure we don't try to access the query node after it is deleted from the scene.
-  QueryListType QueryWaitingQueue;
-  std::mutex    QueryQueueMutex;
-
   //----------------------------------------------------------------
   // For controling remote devices
   //----------------------------------------------------------------
@@ -246,6 +353,16 @@ public:
   // Removes query from the query list.
   void CancelQuery(vtkMRMLIGTLQueryNode* node);
 
+  // Number of queries that are waiting for a response.
+  int GetNumberOfPendingQueries();
+
+  // Deprecated: use GetNumberOfPendingQueries() instead. These members will be removed in a future version.
+  // The pending queries are indexed inside the connector now. QueryWaitingQueue still lists them in push order
+  // for existing code that reads it while holding QueryQueueMutex, but it must not be modified.
+  typedef std::list< vtkWeakPointer<vtkMRMLIGTLQueryNode> > QueryListType;
+  QueryListType QueryWaitingQueue;
+  std::mutex    QueryQueueMutex;
+
   //----------------------------------------------------------------
   // Sending commands
   //----------------------------------------------------------------
@@ -289,17 +406,58 @@ public:
   // Get OpenIGTLink's time stamp information. Returns 0, if it fails to obtain time stamp.
   int GetIGTLTimeStamp(vtkMRMLNode* node, int& second, int& nanosecond);
 
+  /// Get the device types that can send the node type, in the order the device type handlers were registered.
   std::vector<std::string> GetDeviceTypeFromMRMLNodeType(const char* NodeTag);
 
   std::vector<std::string> GetNodeTagFromDeviceType(const char* deviceType);
 
 #ifndef __VTK_WRAP__
   //BTX
+  /// Functions that transfer content between devices of a message type and MRML nodes.
+  /// Handlers of the standard message types are registered when the connector is created.
+  /// Other modules can register handlers to support custom message types or to replace
+  /// the default processing of a standard message type.
+  struct DeviceTypeHandler
+  {
+    /// Tags of the MRML node types that store the content of the device type.
+    std::vector<std::string> NodeTags;
+    /// Update the MRML node from the received device content.
+    std::function<void(vtkMRMLIGTLConnectorNode* connector, igtlioDevice* device, vtkMRMLNode* node)> ApplyIncoming;
+    /// Update the outgoing device content from the MRML node.
+    /// Returns the MRML node event that triggers sending the node (0 if the node is not sent when modified).
+    std::function<unsigned int(vtkMRMLIGTLConnectorNode* connector, vtkMRMLNode* node, igtlioDevice* device)> AssignOutgoing;
+    /// Optional. Create the MRML node for a new incoming device and add it to the scene.
+    /// If not set, then no node is created for incoming devices of this type.
+    std::function<vtkMRMLNode*(vtkMRMLIGTLConnectorNode* connector, igtlioDevice* device)> CreateIncomingNode;
+    /// Optional. Compute a fingerprint of the outgoing content of the MRML node (for example from modified times or a hash).
+    /// If the fingerprint is the same as at the previous push, the node is not sent again to the same clients.
+    /// Returns 0 if the fingerprint is not known. If not set, then the node is sent at each push.
+    std::function<vtkTypeUInt64(vtkMRMLIGTLConnectorNode* connector, vtkMRMLNode* node)> OutgoingContentFingerprint;
+  };
+
+  /// Register handler for a device type (such as "TRANSFORM").
+  /// Replaces the previously registered handler of the same device type.
+  /// If a node can be sent as multiple device types, then the type that was registered first is preferred.
+  void RegisterDeviceTypeHandler(const std::string& deviceType, const DeviceTypeHandler& handler);
+  void UnregisterDeviceTypeHandler(const std::string& deviceType);
+  /// Returns nullptr if no handler is registered for the device type.
+  const DeviceTypeHandler* GetDeviceTypeHandler(const std::string& deviceType);
+
   virtual void OnNodeReferenceAdded(vtkMRMLNodeReference* reference) override;
 
   virtual void OnNodeReferenceRemoved(vtkMRMLNodeReference* reference) override;
 
   virtual void OnNodeReferenceModified(vtkMRMLNodeReference* reference) override;
+
+  /// Function that is called when data is ready to be processed by PeriodicProcess().
+  /// It may be called from any thread, therefore it must only request processing in the main thread.
+  typedef void (*ProcessingRequestCallbackType)(void* clientData);
+  /// Set the function that is called when data is ready to be processed. Set nullptr to remove the callback.
+  /// The callback is invoked when messages are received, the connection state changes, video frames are decoded,
+  /// or a new deadline (deferred push, query timeout) is added. The OpenIGTLinkIO connector does not notify about
+  /// received messages, so while the callback is set a monitor thread polls its receive buffers and state
+  /// (every 1-5ms while connected, 100ms otherwise). This moves the polling off the main thread, it does not remove it.
+  void SetProcessingRequestCallback(ProcessingRequestCallbackType callback, void* clientData);
   //ETX
 #endif // __VTK_WRAP__
 
@@ -30,16 +30,24 @@ Version:   $Revision: 1.2 $
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkCommand.h>
+#include <vtkSmartPointer.h>
 
 // STD includes
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <cstring>
 #include <map>
 
 //------------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLIGTLTrackingDataBundleNode);
 
+namespace
+{
+// Transform nodes of the bundle are referenced, so that the bundle is notified when they are removed from the scene
+const char* TRANSFORM_NODE_REFERENCE_ROLE = "trackingDataTransformNodeRef";
+}
+
 //---------------------------------------------------------------------------
 class vtkMRMLIGTLTrackingDataBundleNode::vtkInternal
 {
@@ -73,35 +81,6 @@ vtkMRMLIGTLTrackingDataBundleNode::vtkInternal::~vtkInternal()
 //----------------------------------------------------------------------------
 void vtkMRMLIGTLTrackingDataBundleNode::vtkInternal::UpdateTransformNode(const char* name, igtl::Matrix4x4& matrix, int type)
 {
-  TrackingDataInfoMap::iterator iter = this->External->TrackingDataList.find(std::string(name));
-
-  vtkMRMLLinearTransformNode* node;
-
-  // If the tracking node does not exist in the scene
-  if (iter == this->External->TrackingDataList.end())
-  {
-    node = vtkMRMLLinearTransformNode::New();
-    node->SetName(name);
-    node->SetDescription("Received by OpenIGTLink");
-
-    if (this->External->GetScene())
-    {
-      this->External->GetScene()->AddNode(node);
-      node->Delete();
-    }
-    TrackingDataInfo info;
-    info.type = type;
-    info.node = node;
-    this->External->TrackingDataList[std::string(name)] = info;
-
-    // TODO: register to MRML observer
-
-  }
-  else
-  {
-    node = iter->second.node;
-  }
-
   vtkNew<vtkMatrix4x4> mat;
   double* vtkmat = &mat->Element[0][0];
   float* igtlmat = &matrix[0][0];
@@ -109,8 +88,7 @@ void vtkMRMLIGTLTrackingDataBundleNode::vtkInternal::UpdateTransformNode(const c
   {
     vtkmat[i] = igtlmat[i];
   }
-  node->SetMatrixTransformToParent(mat.GetPointer());
-  this->External->InvokeEvent(vtkCommand::ModifiedEvent);
+  this->External->UpdateTransformNode(name, mat.GetPointer(), type);
 }
 
 //----------------------------------------------------------------------------
@@ -167,6 +145,27 @@ void vtkMRMLIGTLTrackingDataBundleNode::ProcessMRMLEvents(vtkObject* caller, uns
 }
 
 
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLTrackingDataBundleNode::OnNodeReferenceRemoved(vtkMRMLNodeReference* reference)
+{
+  Superclass::OnNodeReferenceRemoved(reference);
+  const char* nodeID = reference->GetReferencedNodeID();
+  if (!nodeID || !reference->GetReferenceRole() || strcmp(reference->GetReferenceRole(), TRANSFORM_NODE_REFERENCE_ROLE) != 0)
+  {
+    return;
+  }
+  for (TrackingDataInfoMap::iterator iter = this->TrackingDataList.begin(); iter != this->TrackingDataList.end(); ++iter)
+  {
+    if (iter->second.nodeID == nodeID)
+    {
+      // A new transform node is created if tracking data is received for this name again
+      this->TrackingDataList.erase(iter);
+      this->Modified();
+      break;
+    }
+  }
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLIGTLTrackingDataBundleNode::PrintSelf(ostream& os, vtkIndent indent)
 {
@@ -184,17 +183,14 @@ void vtkMRMLIGTLTrackingDataBundleNode::UpdateTransformNode(const char* name, vt
   // If the tracking node does not exist in the scene
   if (iter == this->TrackingDataList.end())
   {
-    node = vtkMRMLLinearTransformNode::New();
-    node->SetName(name);
-    node->SetDescription("Received by OpenIGTLink");
-    if (this->GetScene())
-    {
-      this->GetScene()->AddNode(node);
-    }
+    vtkSmartPointer<vtkMRMLLinearTransformNode> newNode = vtkSmartPointer<vtkMRMLLinearTransformNode>::New();
+    newNode->SetName(name);
+    newNode->SetDescription("Received by OpenIGTLink");
     TrackingDataInfo info;
     info.type = type;
-    info.node = node;
+    info.node = newNode;
     this->TrackingDataList[std::string(name)] = info;
+    node = newNode;
 
     // TODO: register to MRML observer
 
@@ -204,9 +200,17 @@ void vtkMRMLIGTLTrackingDataBundleNode::UpdateTransformNode(const char* name, vt
     node = iter->second.node;
   }
 
+  // Nodes that were created before the bundle was added to the scene are added now
+  if (this->GetScene() && !node->GetScene())
+  {
+    this->GetScene()->AddNode(node);
+    this->TrackingDataList[std::string(name)].nodeID = node->GetID();
+    this->AddNodeReferenceID(TRANSFORM_NODE_REFERENCE_ROLE, node->GetID());
+  }
+
   node->SetMatrixTransformToParent(matrix);
-  node->Delete();
-  this->InvokeEvent(vtkCommand::ModifiedEvent);
+  // Observers are notified once in EndModify() if the bundle is being modified
+  this->Modified();
 }
 
 //----------------------------------------------------------------------------
@@ -215,6 +219,31 @@ int vtkMRMLIGTLTrackingDataBundleNode::GetNumberOfTransformNodes()
   return this->TrackingDataList.size();
 }
 
+//----------------------------------------------------------------------------
+vtkMRMLLinearTransformNode* vtkMRMLIGTLTrackingDataBundleNode::GetTransformNodeByName(const char* name)
+{
+  if (!name)
+  {
+    return NULL;
+  }
+  TrackingDataInfoMap::iterator iter = this->TrackingDataList.find(std::string(name));
+  if (iter == this->TrackingDataList.end())
+  {
+    return NULL;
+  }
+  return iter->second.node;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLIGTLTrackingDataBundleNode::GetTransformNodes(std::vector<vtkMRMLLinearTransformNode*>& transformNodes)
+{
+  transformNodes.clear();
+  for (TrackingDataInfoMap::iterator iter = this->TrackingDataList.begin(); iter != this->TrackingDataList.end(); ++iter)
+  {
+    transformNodes.push_back(iter->second.node);
+  }
+}
+
 //----------------------------------------------------------------------------
 vtkMRMLLinearTransformNode* vtkMRMLIGTLTrackingDataBundleNode::GetTransformNode(unsigned int id)
 {
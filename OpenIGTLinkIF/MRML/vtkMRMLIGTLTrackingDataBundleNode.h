@@ -25,6 +25,7 @@
 
 // VTK includes
 #include <vtkObject.h>
+#include <vtkSmartPointer.h>
 
 // STD includes
 #include <string>
@@ -98,9 +99,16 @@ public:
   // method to propagate events generated in mrml
   virtual void ProcessMRMLEvents(vtkObject* caller, unsigned long event, void* callData) override;
 
+  // Description:
+  // Transform nodes that are removed from the scene are removed from the bundle,
+  // so that they are not added to the scene again when the next tracking data is received.
+  virtual void OnNodeReferenceRemoved(vtkMRMLNodeReference* reference) override;
+
   // Description:
   // Update Transform nodes. If new data is specified, create a new Transform node.
   // default type is 1 (igtl::TrackingDataMessage::TYPE_TRACKER)
+  // The bundle node is modified, so that updating multiple transforms between StartModify()
+  // and EndModify() calls results in a single ModifiedEvent.
   virtual void UpdateTransformNode(const char* name, vtkMatrix4x4* matrix, int type = 1);
 
   // Description:
@@ -111,6 +119,16 @@ public:
   // Get the N-th linear transform node (id == N)
   virtual vtkMRMLLinearTransformNode* GetTransformNode(unsigned int id);
 
+  // Description:
+  // Get the linear transform node of the named tracking data element. Returns NULL if not found.
+  virtual vtkMRMLLinearTransformNode* GetTransformNodeByName(const char* name);
+
+#ifndef __VTK_WRAP__
+  // Description:
+  // Get all linear transform nodes in the bundle (in the same order as GetTransformNode())
+  void GetTransformNodes(std::vector<vtkMRMLLinearTransformNode*>& transformNodes);
+#endif
+
 
 protected:
   //----------------------------------------------------------------
@@ -136,7 +154,9 @@ private:
   typedef struct
   {
     int                         type;
-    vtkMRMLLinearTransformNode* node;
+    vtkSmartPointer<vtkMRMLLinearTransformNode> node;
+    // ID of the node in the scene, empty if the node has not been added to the scene yet
+    std::string                 nodeID;
   } TrackingDataInfo;
   typedef std::map<std::string, TrackingDataInfo> TrackingDataInfoMap;
 
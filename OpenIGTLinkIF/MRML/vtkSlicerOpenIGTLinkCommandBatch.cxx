@@ -0,0 +1,282 @@
+/*==============================================================================
+
+Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+See COPYRIGHT.txt
+or http://www.slicer.org/copyright/copyright.txt for details.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+==============================================================================*/
+
+// OpenIGTLinkIF includes
+#include "vtkSlicerOpenIGTLinkCommand.h"
+#include "vtkSlicerOpenIGTLinkCommandBatch.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+
+// STD includes
+#include <algorithm>
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkSlicerOpenIGTLinkCommandBatch);
+
+//---------------------------------------------------------------------------
+vtkSlicerOpenIGTLinkCommandBatch::vtkSlicerOpenIGTLinkCommandBatch()
+  : Callback(vtkSmartPointer<vtkCallbackCommand>::New())
+  , Sent(false)
+{
+  this->Callback->SetCallback(vtkSlicerOpenIGTLinkCommandBatch::CommandCallback);
+  this->Callback->SetClientData(this);
+}
+
+//---------------------------------------------------------------------------
+vtkSlicerOpenIGTLinkCommandBatch::~vtkSlicerOpenIGTLinkCommandBatch()
+{
+  this->StopObservingCommands();
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerOpenIGTLinkCommandBatch::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Number of commands: " << this->GetNumberOfCommands() << "\n";
+  os << indent << "Sent: " << this->Sent << "\n";
+  os << indent << "Number of completed commands: " << this->GetNumberOfCompletedCommands() << "\n";
+  os << indent << "Number of successful commands: " << this->GetNumberOfSuccessfulCommands() << "\n";
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerOpenIGTLinkCommandBatch::AddCommand(igtlioCommand* command)
+{
+  if (!command)
+  {
+    vtkErrorMacro("AddCommand failed: invalid command");
+    return false;
+  }
+  if (this->IsInProgress())
+  {
+    vtkErrorMacro("AddCommand failed: the batch is in progress");
+    return false;
+  }
+  if (std::find(this->Commands.begin(), this->Commands.end(), command) != this->Commands.end())
+  {
+    vtkErrorMacro("AddCommand failed: the command is already in the batch");
+    return false;
+  }
+  if (command->IsInProgress())
+  {
+    vtkErrorMacro("AddCommand failed: the command is already in progress");
+    return false;
+  }
+  this->Commands.push_back(command);
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerOpenIGTLinkCommandBatch::AddCommand(vtkSlicerOpenIGTLinkCommand* command)
+{
+  if (!command)
+  {
+    vtkErrorMacro("AddCommand failed: invalid command");
+    return false;
+  }
+  return this->AddCommand(command->GetCommand());
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerOpenIGTLinkCommandBatch::RemoveAllCommands()
+{
+  this->StopObservingCommands();
+  this->Commands.clear();
+  this->CommandsByID.clear();
+  this->CompletedCommands.clear();
+  this->Sent = false;
+}
+
+//---------------------------------------------------------------------------
+int vtkSlicerOpenIGTLinkCommandBatch::GetNumberOfCommands()
+{
+  return static_cast<int>(this->Commands.size());
+}
+
+//---------------------------------------------------------------------------
+igtlioCommand* vtkSlicerOpenIGTLinkCommandBatch::GetNthCommand(int index)
+{
+  if (index < 0 || index >= this->GetNumberOfCommands())
+  {
+    vtkErrorMacro("GetNthCommand failed: index " << index << " is out of range");
+    return nullptr;
+  }
+  return this->Commands[index];
+}
+
+//---------------------------------------------------------------------------
+igtlioCommand* vtkSlicerOpenIGTLinkCommandBatch::GetCommandByID(int commandId)
+{
+  std::map<int, igtlioCommand*>::iterator commandIt = this->CommandsByID.find(commandId);
+  if (commandIt == this->CommandsByID.end())
+  {
+    return nullptr;
+  }
+  return commandIt->second;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerOpenIGTLinkCommandBatch::Send(vtkMRMLIGTLConnectorNode* connectorNode)
+{
+  if (!connectorNode)
+  {
+    vtkErrorMacro("Send failed: invalid connector node");
+    return false;
+  }
+  if (this->IsInProgress())
+  {
+    vtkErrorMacro("Send failed: the batch is already in progress");
+    return false;
+  }
+  if (this->Commands.empty())
+  {
+    vtkErrorMacro("Send failed: the batch has no commands");
+    return false;
+  }
+  for (std::vector<vtkSmartPointer<igtlioCommand> >::iterator commandIt = this->Commands.begin(); commandIt != this->Commands.end(); ++commandIt)
+  {
+    if ((*commandIt)->IsInProgress())
+    {
+      // The command has been sent since it was added, its response would complete it twice
+      vtkErrorMacro("Send failed: command " << (*commandIt)->GetName() << " is already in progress");
+      return false;
+    }
+  }
+
+  this->StopObservingCommands();
+  this->CommandsByID.clear();
+  this->CompletedCommands.clear();
+  this->ConnectorNode = connectorNode;
+  this->Sent = true;
+
+  for (std::vector<vtkSmartPointer<igtlioCommand> >::iterator commandIt = this->Commands.begin(); commandIt != this->Commands.end(); ++commandIt)
+  {
+    igtlioCommand* command = *commandIt;
+    command->AddObserver(igtlioCommand::CommandCompletedEvent, this->Callback);
+    command->AddObserver(igtlioCommand::CommandExpiredEvent, this->Callback);
+    command->AddObserver(igtlioCommand::CommandCancelledEvent, this->Callback);
+    // Responses are matched to the commands by ID, so there is no need to wait for the previous response
+    command->SetBlocking(false);
+    connectorNode->SendCommand(command);
+    this->CommandsByID[command->GetCommandId()] = command;
+    if (!command->IsInProgress())
+    {
+      // Sending failed, no response will be received
+      if (!command->IsCompleted())
+      {
+        command->SetStatus(igtlioCommandStatus::CommandFailed);
+      }
+      this->SetCommandCompleted(command);
+    }
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerOpenIGTLinkCommandBatch::Cancel()
+{
+  if (!this->IsInProgress())
+  {
+    return;
+  }
+  // Cancelling may complete the batch, so iterate over a copy
+  std::vector<vtkSmartPointer<igtlioCommand> > commands = this->Commands;
+  for (std::vector<vtkSmartPointer<igtlioCommand> >::iterator commandIt = commands.begin(); commandIt != commands.end(); ++commandIt)
+  {
+    igtlioCommand* command = *commandIt;
+    if (this->CompletedCommands.count(command))
+    {
+      continue;
+    }
+    if (this->ConnectorNode)
+    {
+      this->ConnectorNode->CancelCommand(command);
+    }
+    if (!this->CompletedCommands.count(command))
+    {
+      command->SetStatus(igtlioCommandStatus::CommandCancelled);
+      this->SetCommandCompleted(command);
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerOpenIGTLinkCommandBatch::IsInProgress()
+{
+  return this->Sent && this->CompletedCommands.size() < this->Commands.size();
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerOpenIGTLinkCommandBatch::IsCompleted()
+{
+  return this->Sent && this->CompletedCommands.size() == this->Commands.size();
+}
+
+//---------------------------------------------------------------------------
+int vtkSlicerOpenIGTLinkCommandBatch::GetNumberOfCompletedCommands()
+{
+  return static_cast<int>(this->CompletedCommands.size());
+}
+
+//---------------------------------------------------------------------------
+int vtkSlicerOpenIGTLinkCommandBatch::GetNumberOfSuccessfulCommands()
+{
+  int numberOfSuccessfulCommands = 0;
+  for (std::set<igtlioCommand*>::iterator commandIt = this->CompletedCommands.begin(); commandIt != this->CompletedCommands.end(); ++commandIt)
+  {
+    if ((*commandIt)->GetSuccessful())
+    {
+      ++numberOfSuccessfulCommands;
+    }
+  }
+  return numberOfSuccessfulCommands;
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerOpenIGTLinkCommandBatch::StopObservingCommands()
+{
+  for (std::vector<vtkSmartPointer<igtlioCommand> >::iterator commandIt = this->Commands.begin(); commandIt != this->Commands.end(); ++commandIt)
+  {
+    (*commandIt)->RemoveObserver(this->Callback);
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerOpenIGTLinkCommandBatch::SetCommandCompleted(igtlioCommand* command)
+{
+  if (!this->IsInProgress() || !this->CompletedCommands.insert(command).second)
+  {
+    // The batch is not in progress or the command has already been completed
+    return;
+  }
+  if (this->IsCompleted())
+  {
+    this->StopObservingCommands();
+    this->InvokeEvent(BatchCompletedEvent, this);
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkSlicerOpenIGTLinkCommandBatch::CommandCallback(vtkObject* caller, unsigned long vtkNotUsed(eid), void* clientdata, void* vtkNotUsed(calldata))
+{
+  vtkSlicerOpenIGTLinkCommandBatch* self = static_cast<vtkSlicerOpenIGTLinkCommandBatch*>(clientdata);
+  igtlioCommand* command = igtlioCommand::SafeDownCast(caller);
+  if (!command || !command->IsCompleted())
+  {
+    return;
+  }
+  self->SetCommandCompleted(command);
+}
@@ -0,0 +1,116 @@
+/*==============================================================================
+
+Copyright (c) Laboratory for Percutaneous Surgery (PerkLab)
+Queen's University, Kingston, ON, Canada. All Rights Reserved.
+
+See COPYRIGHT.txt
+or http://www.slicer.org/copyright/copyright.txt for details.
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkSlicerOpenIGTLinkCommandBatch_h
+#define __vtkSlicerOpenIGTLinkCommandBatch_h
+
+// OpenIGTLinkIF MRML includes
+#include "vtkMRMLIGTLConnectorNode.h"
+#include "vtkSlicerOpenIGTLinkIFModuleMRMLExport.h"
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+
+// STD includes
+#include <map>
+#include <set>
+#include <vector>
+
+class vtkSlicerOpenIGTLinkCommand;
+
+/// \brief Sends multiple commands without waiting for the response of each command.
+///
+/// All commands are sent back-to-back, and the responses are matched to the commands by the command ID
+/// (by the OpenIGTLinkIO connector), so the batch takes one round trip instead of one round trip per command.
+/// The events of each command (such as CommandCompletedEvent) are invoked as usual when its response is
+/// received or it expires. BatchCompletedEvent is invoked when all commands of the batch are completed.
+/// Responses are processed in vtkMRMLIGTLConnectorNode::PeriodicProcess(), as for single commands.
+///
+/// Example usage from Python:
+///     batch = slicer.vtkSlicerOpenIGTLinkCommandBatch()
+///     for name in parameterNames:
+///       cmd = slicer.vtkSlicerOpenIGTLinkCommand()
+///       cmd.SetName('GetUsParameter')
+///       cmd.SetCommandContent('<Command><Parameter Name="' + name + '" /></Command>')
+///       cmd.AddObserver(cmd.CommandCompletedEvent, onCommandCompleted)
+///       batch.AddCommand(cmd)
+///     batch.AddObserver(slicer.vtkSlicerOpenIGTLinkCommandBatch.BatchCompletedEvent, onBatchCompleted)
+///     batch.Send(connectorNode)
+class VTK_SLICER_OPENIGTLINKIF_MODULE_MRML_EXPORT vtkSlicerOpenIGTLinkCommandBatch : public vtkObject
+{
+public:
+  static vtkSlicerOpenIGTLinkCommandBatch* New();
+  vtkTypeMacro(vtkSlicerOpenIGTLinkCommandBatch, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  enum
+  {
+    BatchCompletedEvent = 118960,
+  };
+
+  /// Add a command to the batch. Commands cannot be added while the batch is in progress.
+  /// Returns false if the command is already in the batch or it is in progress.
+  /// Commands of the batch are always sent non-blocking.
+  bool AddCommand(igtlioCommand* command);
+  bool AddCommand(vtkSlicerOpenIGTLinkCommand* command);
+  /// Remove all commands from the batch. Commands that are in progress are not cancelled.
+  void RemoveAllCommands();
+
+  int GetNumberOfCommands();
+  igtlioCommand* GetNthCommand(int index);
+  /// Returns the command that has been sent with the command ID, or nullptr if not found
+  igtlioCommand* GetCommandByID(int commandId);
+
+  /// Send all commands of the batch to the connector without waiting for responses.
+  /// Returns false if the batch or any of its commands is already in progress, or the batch has no commands.
+  /// Commands that cannot be sent are completed with CommandFailed status.
+  bool Send(vtkMRMLIGTLConnectorNode* connectorNode);
+  /// Cancel the commands of the batch that have not been completed yet.
+  void Cancel();
+
+  /// Returns true if the batch has been sent and some of its commands have not been completed yet
+  bool IsInProgress();
+  /// Returns true if the batch has been sent and all of its commands have been completed
+  bool IsCompleted();
+  int GetNumberOfCompletedCommands();
+  /// Number of completed commands that received a successful response
+  int GetNumberOfSuccessfulCommands();
+
+protected:
+  vtkSlicerOpenIGTLinkCommandBatch();
+  virtual ~vtkSlicerOpenIGTLinkCommandBatch();
+
+  static void CommandCallback(vtkObject* caller, unsigned long eid, void* clientdata, void* calldata);
+  void StopObservingCommands();
+  /// Record that the command is completed, and invoke BatchCompletedEvent when all commands are completed
+  void SetCommandCompleted(igtlioCommand* command);
+
+  vtkSmartPointer<vtkCallbackCommand> Callback;
+  std::vector<vtkSmartPointer<igtlioCommand> > Commands;
+  /// Index of the sent commands by command ID
+  std::map<int, igtlioCommand*> CommandsByID;
+  std::set<igtlioCommand*> CompletedCommands;
+  vtkWeakPointer<vtkMRMLIGTLConnectorNode> ConnectorNode;
+  bool Sent;
+
+private:
+  vtkSlicerOpenIGTLinkCommandBatch(const vtkSlicerOpenIGTLinkCommandBatch&); // Not implemented
+  void operator=(const vtkSlicerOpenIGTLinkCommandBatch&);               // Not implemented
+};
+
+#endif //__vtkSlicerOpenIGTLinkCommandBatch_h
@@ -0,0 +1,128 @@
+#include "vtkSlicerConfigure.h"
+
+// IF module includes
+#include "vtkIGTLVP9VolumeCodec.h"
+
+// vtkAddon includes
+#include <vtkStreamingVolumeFrame.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkSmartPointer.h>
+#include <vtkUnsignedCharArray.h>
+#include "vtkMRMLCoreTestingMacros.h"
+
+// STD includes
+#include <cstring>
+
+//---------------------------------------------------------------------------
+// Encode and decode a sequence of grayscale frames. Encoding is lossless by default,
+// therefore the decoded frames must be identical to the input frames.
+int TestGrayscaleRoundTrip()
+{
+  const int width = 65;
+  const int height = 47;
+  const int numberOfFrames = 5;
+
+  vtkSmartPointer<vtkIGTLVP9VolumeCodec> encoder = vtkSmartPointer<vtkIGTLVP9VolumeCodec>::New();
+  vtkSmartPointer<vtkIGTLVP9VolumeCodec> decoder = vtkSmartPointer<vtkIGTLVP9VolumeCodec>::New();
+  vtkSmartPointer<vtkImageData> inputImage = vtkSmartPointer<vtkImageData>::New();
+  inputImage->SetDimensions(width, height, 1);
+  inputImage->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  vtkSmartPointer<vtkImageData> decodedImage = vtkSmartPointer<vtkImageData>::New();
+
+  for (int frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex)
+  {
+    unsigned char* inputPointer = static_cast<unsigned char*>(inputImage->GetScalarPointer());
+    for (int y = 0; y < height; ++y)
+    {
+      for (int x = 0; x < width; ++x)
+      {
+        inputPointer[y * width + x] = static_cast<unsigned char>(x * 3 + y * 2 + frameIndex * 10);
+      }
+    }
+    inputImage->Modified();
+
+    vtkSmartPointer<vtkStreamingVolumeFrame> frame = vtkSmartPointer<vtkStreamingVolumeFrame>::New();
+    CHECK_BOOL(encoder->EncodeImageData(inputImage, frame), true);
+    CHECK_INT(frame->GetNumberOfComponents(), 1);
+    CHECK_BOOL(decoder->DecodeFrame(frame, decodedImage), true);
+
+    int decodedDimensions[3] = { 0, 0, 0 };
+    decodedImage->GetDimensions(decodedDimensions);
+    CHECK_INT(decodedDimensions[0], width);
+    CHECK_INT(decodedDimensions[1], height);
+    CHECK_INT(decodedImage->GetNumberOfScalarComponents(), 1);
+    CHECK_INT(memcmp(decodedImage->GetScalarPointer(), inputImage->GetScalarPointer(), width * height), 0);
+  }
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int TestRGBDecode()
+{
+  const int width = 32;
+  const int height = 24;
+
+  vtkSmartPointer<vtkIGTLVP9VolumeCodec> codec = vtkSmartPointer<vtkIGTLVP9VolumeCodec>::New();
+  vtkSmartPointer<vtkImageData> inputImage = vtkSmartPointer<vtkImageData>::New();
+  inputImage->SetDimensions(width, height, 1);
+  inputImage->AllocateScalars(VTK_UNSIGNED_CHAR, 3);
+  memset(inputImage->GetScalarPointer(), 100, width * height * 3);
+
+  vtkSmartPointer<vtkStreamingVolumeFrame> frame = vtkSmartPointer<vtkStreamingVolumeFrame>::New();
+  CHECK_BOOL(codec->EncodeImageData(inputImage, frame), true);
+  CHECK_INT(frame->GetNumberOfComponents(), 3);
+  vtkSmartPointer<vtkImageData> decodedImage = vtkSmartPointer<vtkImageData>::New();
+  CHECK_BOOL(codec->DecodeFrame(frame, decodedImage), true);
+  CHECK_INT(decodedImage->GetNumberOfScalarComponents(), 3);
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+// Bitstream arrays and decoded images are reused once they are no longer referenced
+int TestBufferReuse()
+{
+  const int width = 64;
+  const int height = 48;
+
+  vtkSmartPointer<vtkIGTLVP9VolumeCodec> encoder = vtkSmartPointer<vtkIGTLVP9VolumeCodec>::New();
+  vtkSmartPointer<vtkIGTLVP9VolumeCodec> decoder = vtkSmartPointer<vtkIGTLVP9VolumeCodec>::New();
+  vtkSmartPointer<vtkImageData> inputImage = vtkSmartPointer<vtkImageData>::New();
+  inputImage->SetDimensions(width, height, 1);
+  inputImage->AllocateScalars(VTK_UNSIGNED_CHAR, 3);
+  vtkSmartPointer<vtkImageData> decodedImage = vtkSmartPointer<vtkImageData>::New();
+
+  const int numberOfFrames = 4;
+  vtkUnsignedCharArray* frameDataArrays[numberOfFrames] = { nullptr };
+  void* decodedPointers[numberOfFrames] = { nullptr };
+  for (int frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex)
+  {
+    memset(inputImage->GetScalarPointer(), 50 + frameIndex * 20, width * height * 3);
+    inputImage->Modified();
+    // Key frames do not reference the previous frame, so only the last encoded frame stays in use
+    vtkSmartPointer<vtkStreamingVolumeFrame> frame = vtkSmartPointer<vtkStreamingVolumeFrame>::New();
+    CHECK_BOOL(encoder->EncodeImageData(inputImage, frame, true), true);
+    CHECK_BOOL(decoder->DecodeFrame(frame, decodedImage), true);
+    frameDataArrays[frameIndex] = frame->GetFrameData();
+    decodedPointers[frameIndex] = decodedImage->GetScalarPointer();
+  }
+
+  // Two arrays alternate: one for the last encoded frame, one for the frame that is being encoded
+  CHECK_POINTER(frameDataArrays[2], frameDataArrays[0]);
+  CHECK_POINTER(frameDataArrays[3], frameDataArrays[1]);
+  for (int frameIndex = 1; frameIndex < numberOfFrames; ++frameIndex)
+  {
+    CHECK_POINTER(decodedPointers[frameIndex], decodedPointers[0]);
+  }
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int vtkIGTLVP9VolumeCodecTest(int argc, char* argv [])
+{
+  CHECK_EXIT_SUCCESS(TestGrayscaleRoundTrip());
+  CHECK_EXIT_SUCCESS(TestRGBDecode());
+  CHECK_EXIT_SUCCESS(TestBufferReuse());
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,176 @@
+#include "vtkSlicerConfigure.h"
+
+// IF module includes
+#include "vtkIGTLVideoColorConversion.h"
+
+// VTK includes
+#include <vtkMinimalStandardRandomSequence.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+#include "vtkMRMLCoreTestingMacros.h"
+
+// STD includes
+#include <vector>
+
+//---------------------------------------------------------------------------
+// RGB to I420 conversion of GenericEncoder::ConvertRGBToYUV in OpenIGTLink, which was used for encoding
+// before the conversion was implemented in vtkIGTLVideoColorConversion. Only valid for even image sizes.
+void ConvertRGBToI420OpenIGTLink(const unsigned char* rgb, unsigned char* destination, unsigned int width, unsigned int height)
+{
+  size_t imageSize = static_cast<size_t>(width) * height;
+  size_t uPosition = imageSize;
+  size_t vPosition = uPosition + uPosition / 4;
+  size_t i = 0;
+  for (unsigned int line = 0; line < height; ++line)
+  {
+    if (!(line % 2))
+    {
+      for (unsigned int x = 0; x < width; x += 2)
+      {
+        unsigned char r = rgb[3 * i];
+        unsigned char g = rgb[3 * i + 1];
+        unsigned char b = rgb[3 * i + 2];
+        destination[i++] = ((66 * r + 129 * g + 25 * b) >> 8) + 16;
+        destination[uPosition++] = ((-38 * r + -74 * g + 112 * b) >> 8) + 128;
+        destination[vPosition++] = ((112 * r + -94 * g + -18 * b) >> 8) + 128;
+        r = rgb[3 * i];
+        g = rgb[3 * i + 1];
+        b = rgb[3 * i + 2];
+        destination[i++] = ((66 * r + 129 * g + 25 * b) >> 8) + 16;
+      }
+    }
+    else
+    {
+      for (unsigned int x = 0; x < width; ++x)
+      {
+        unsigned char r = rgb[3 * i];
+        unsigned char g = rgb[3 * i + 1];
+        unsigned char b = rgb[3 * i + 2];
+        destination[i++] = ((66 * r + 129 * g + 25 * b) >> 8) + 16;
+      }
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+// Checks that all instruction sets convert a random image to I420 exactly as OpenIGTLink does
+int TestOpenIGTLinkCompatibility(unsigned int width, unsigned int height)
+{
+  size_t lumaSize = static_cast<size_t>(width) * height;
+  size_t chromaSize = lumaSize / 4;
+
+  vtkSmartPointer<vtkMinimalStandardRandomSequence> random = vtkSmartPointer<vtkMinimalStandardRandomSequence>::New();
+  random->SetSeed(2);
+  std::vector<unsigned char> inputRGB(3 * lumaSize);
+  for (size_t i = 0; i < inputRGB.size(); ++i)
+  {
+    inputRGB[i] = static_cast<unsigned char>(random->GetRangeValue(0, 256));
+    random->Next();
+  }
+
+  std::vector<unsigned char> expectedYUV(lumaSize + 2 * chromaSize);
+  ConvertRGBToI420OpenIGTLink(inputRGB.data(), expectedYUV.data(), width, height);
+
+  std::vector<unsigned char> outputYUV(expectedYUV.size());
+  for (int instructionSet = vtkIGTLVideoColorConversion::InstructionSetScalar; instructionSet < vtkIGTLVideoColorConversion::InstructionSet_Last; ++instructionSet)
+  {
+    if (!vtkIGTLVideoColorConversion::IsInstructionSetAvailable(instructionSet))
+    {
+      continue;
+    }
+    vtkIGTLVideoColorConversion::ConvertRGBToI420(inputRGB.data(), width, height,
+      &outputYUV[0], width, &outputYUV[lumaSize], &outputYUV[lumaSize + chromaSize], width / 2, instructionSet);
+    if (outputYUV != expectedYUV)
+    {
+      std::cerr << width << "x" << height << " " << vtkIGTLVideoColorConversion::GetInstructionSetAsString(instructionSet)
+        << ": RGB to I420 conversion differs from OpenIGTLink" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+// Converts a random image in both directions with each available instruction set,
+// checks that the result is identical to the scalar implementation, and prints the conversion rates.
+int TestColorConversion(unsigned int width, unsigned int height, int numberOfRepetitions)
+{
+  unsigned int chromaWidth = (width + 1) / 2;
+  unsigned int chromaHeight = (height + 1) / 2;
+  size_t lumaSize = static_cast<size_t>(width) * height;
+  size_t chromaSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+
+  vtkSmartPointer<vtkMinimalStandardRandomSequence> random = vtkSmartPointer<vtkMinimalStandardRandomSequence>::New();
+  random->SetSeed(1);
+  std::vector<unsigned char> inputRGB(3 * lumaSize);
+  for (size_t i = 0; i < inputRGB.size(); ++i)
+  {
+    inputRGB[i] = static_cast<unsigned char>(random->GetRangeValue(0, 256));
+    random->Next();
+  }
+  // Random YUV values also cover colors outside of the RGB range, which must be clamped
+  std::vector<unsigned char> inputYUV(lumaSize + 2 * chromaSize);
+  for (size_t i = 0; i < inputYUV.size(); ++i)
+  {
+    inputYUV[i] = static_cast<unsigned char>(random->GetRangeValue(0, 256));
+    random->Next();
+  }
+
+  std::vector<unsigned char> expectedYUV(inputYUV.size());
+  std::vector<unsigned char> expectedRGB(inputRGB.size());
+  vtkIGTLVideoColorConversion::ConvertRGBToI420(inputRGB.data(), width, height,
+    &expectedYUV[0], width, &expectedYUV[lumaSize], &expectedYUV[lumaSize + chromaSize], chromaWidth,
+    vtkIGTLVideoColorConversion::InstructionSetScalar);
+  vtkIGTLVideoColorConversion::ConvertI420ToRGB(&inputYUV[0], width, &inputYUV[lumaSize], &inputYUV[lumaSize + chromaSize], chromaWidth,
+    width, height, expectedRGB.data(), vtkIGTLVideoColorConversion::InstructionSetScalar);
+
+  std::vector<unsigned char> outputYUV(inputYUV.size());
+  std::vector<unsigned char> outputRGB(inputRGB.size());
+  for (int instructionSet = vtkIGTLVideoColorConversion::InstructionSetScalar; instructionSet < vtkIGTLVideoColorConversion::InstructionSet_Last; ++instructionSet)
+  {
+    if (!vtkIGTLVideoColorConversion::IsInstructionSetAvailable(instructionSet))
+    {
+      std::cout << width << "x" << height << " " << vtkIGTLVideoColorConversion::GetInstructionSetAsString(instructionSet)
+        << ": not available" << std::endl;
+      continue;
+    }
+
+    double startTime = vtkTimerLog::GetUniversalTime();
+    for (int i = 0; i < numberOfRepetitions; ++i)
+    {
+      vtkIGTLVideoColorConversion::ConvertRGBToI420(inputRGB.data(), width, height,
+        &outputYUV[0], width, &outputYUV[lumaSize], &outputYUV[lumaSize + chromaSize], chromaWidth, instructionSet);
+    }
+    double rgbToYUVTime = vtkTimerLog::GetUniversalTime() - startTime;
+
+    startTime = vtkTimerLog::GetUniversalTime();
+    for (int i = 0; i < numberOfRepetitions; ++i)
+    {
+      vtkIGTLVideoColorConversion::ConvertI420ToRGB(&inputYUV[0], width, &inputYUV[lumaSize], &inputYUV[lumaSize + chromaSize], chromaWidth,
+        width, height, outputRGB.data(), instructionSet);
+    }
+    double yuvToRGBTime = vtkTimerLog::GetUniversalTime() - startTime;
+
+    double megaPixels = numberOfRepetitions * lumaSize / 1.0e6;
+    std::cout << width << "x" << height << " " << vtkIGTLVideoColorConversion::GetInstructionSetAsString(instructionSet)
+      << ": RGB to I420 " << megaPixels / rgbToYUVTime << " MPixel/s"
+      << ", I420 to RGB " << megaPixels / yuvToRGBTime << " MPixel/s" << std::endl;
+
+    CHECK_BOOL(outputYUV == expectedYUV, true);
+    CHECK_BOOL(outputRGB == expectedRGB, true);
+  }
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int vtkIGTLVideoColorConversionBenchmark(int argc, char* argv [])
+{
+  CHECK_EXIT_SUCCESS(TestOpenIGTLinkCompatibility(1920, 1080));
+  // Size that is not a multiple of the vector widths
+  CHECK_EXIT_SUCCESS(TestOpenIGTLinkCompatibility(50, 6));
+  CHECK_EXIT_SUCCESS(TestColorConversion(1920, 1080, 20));
+  // Odd size, processed partially by the scalar implementation
+  CHECK_EXIT_SUCCESS(TestColorConversion(1917, 1079, 20));
+  CHECK_EXIT_SUCCESS(TestColorConversion(1, 1, 1));
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,137 @@
+#include "vtkSlicerConfigure.h"
+
+// IF module includes
+#include "vtkIGTLVideoFramePool.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkSmartPointer.h>
+#include <vtkStreamingVolumeFrame.h>
+#include <vtkUnsignedCharArray.h>
+#include "vtkMRMLCoreTestingMacros.h"
+
+// STD includes
+#include <set>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Simulates how the connector receives a video stream: each P-frame references the previous frame,
+// and the volume node keeps the last frame.
+class VideoStreamSimulator
+{
+public:
+  VideoStreamSimulator()
+    : Bitstream(KeyFrameSize)
+  {
+    this->FramePool = vtkSmartPointer<vtkIGTLVideoFramePool>::New();
+  }
+
+  bool ReceiveFrame(int frameIndex)
+  {
+    bool keyFrame = (frameIndex % GOPLength == 0);
+    vtkIdType size = keyFrame ? KeyFrameSize : 2000 + (frameIndex * 37) % 3000;
+    this->Bitstream[0] = static_cast<unsigned char>(frameIndex);
+
+    vtkStreamingVolumeFrame* frame = this->FramePool->GetFrame(this->Bitstream.data(), size);
+    frame->SetFrameType(keyFrame ? vtkStreamingVolumeFrame::IFrame : vtkStreamingVolumeFrame::PFrame);
+    if (!keyFrame && this->PreviousFrame)
+    {
+      frame->SetPreviousFrame(this->PreviousFrame);
+    }
+    this->PreviousFrame = frame;
+    this->DisplayedFrame = frame;
+
+    vtkUnsignedCharArray* frameData = frame->GetFrameData();
+    return frameData->GetSize() == size && frameData->GetValue(0) == this->Bitstream[0];
+  }
+
+  enum
+  {
+    GOPLength = 30,
+    KeyFrameSize = 20000
+  };
+
+  vtkSmartPointer<vtkIGTLVideoFramePool> FramePool;
+  vtkSmartPointer<vtkStreamingVolumeFrame> PreviousFrame;
+  vtkSmartPointer<vtkStreamingVolumeFrame> DisplayedFrame;
+  std::vector<unsigned char> Bitstream;
+};
+
+//---------------------------------------------------------------------------
+// Simulates how the decoding thread uses the pool: the volume node keeps the last decoded image,
+// and one more image is waiting to be applied to the node.
+int TestImageRecycling()
+{
+  vtkSmartPointer<vtkIGTLVideoFramePool> imagePool = vtkSmartPointer<vtkIGTLVideoFramePool>::New();
+  vtkSmartPointer<vtkImageData> displayedImage;
+  vtkSmartPointer<vtkImageData> queuedImage;
+  std::set<void*> scalarPointers;
+  int numberOfAllocationsAfterWarmUp = 0;
+  for (int frameIndex = 0; frameIndex < 100; ++frameIndex)
+  {
+    if (frameIndex == 10)
+    {
+      numberOfAllocationsAfterWarmUp = imagePool->GetNumberOfAllocations();
+    }
+    vtkImageData* image = imagePool->GetImage();
+    CHECK_BOOL(image != displayedImage.GetPointer() && image != queuedImage.GetPointer(), true);
+    // Same as the codec: scalars are only allocated if the image does not match the frame
+    int dimensions[3] = { 0, 0, 0 };
+    image->GetDimensions(dimensions);
+    if (dimensions[0] != 64 || dimensions[1] != 48 || !image->GetScalarPointer())
+    {
+      image->SetDimensions(64, 48, 1);
+      image->AllocateScalars(VTK_UNSIGNED_CHAR, 3);
+    }
+    scalarPointers.insert(image->GetScalarPointer());
+    displayedImage = queuedImage;
+    queuedImage = image;
+  }
+  std::cout << "Images in pool: " << imagePool->GetNumberOfImages() << std::endl;
+  CHECK_INT(imagePool->GetNumberOfImages(), 3);
+  CHECK_INT(imagePool->GetNumberOfAllocations(), numberOfAllocationsAfterWarmUp);
+  CHECK_INT(static_cast<int>(scalarPointers.size()), imagePool->GetNumberOfImages());
+
+  // Images that are still in use remain valid after the pool is deleted
+  imagePool = nullptr;
+  CHECK_NOT_NULL(displayedImage->GetScalarPointer());
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int vtkIGTLVideoFramePoolTest(int argc, char* argv [])
+{
+  VideoStreamSimulator simulator;
+
+  // Warm up: the pool grows to the number of frames in use since the last key frame
+  int frameIndex = 0;
+  for (; frameIndex < 3 * VideoStreamSimulator::GOPLength; ++frameIndex)
+  {
+    CHECK_BOOL(simulator.ReceiveFrame(frameIndex), true);
+  }
+  int numberOfFramesAfterWarmUp = simulator.FramePool->GetNumberOfFrames();
+  int numberOfAllocationsAfterWarmUp = simulator.FramePool->GetNumberOfAllocations();
+  std::cout << "Frames in pool after warm up: " << numberOfFramesAfterWarmUp << std::endl;
+
+  // Steady state: no allocations
+  bool allFramesValid = true;
+  for (; frameIndex < 13 * VideoStreamSimulator::GOPLength; ++frameIndex)
+  {
+    allFramesValid = simulator.ReceiveFrame(frameIndex) && allFramesValid;
+  }
+
+  std::cout << "Allocations in steady state: " << simulator.FramePool->GetNumberOfAllocations() - numberOfAllocationsAfterWarmUp << std::endl;
+  CHECK_BOOL(allFramesValid, true);
+  CHECK_INT(simulator.FramePool->GetNumberOfAllocations(), numberOfAllocationsAfterWarmUp);
+  CHECK_INT(simulator.FramePool->GetNumberOfFrames(), numberOfFramesAfterWarmUp);
+  CHECK_BOOL(numberOfFramesAfterWarmUp <= VideoStreamSimulator::GOPLength + 1, true);
+
+  // Frames that are still in use remain valid after the pool is deleted
+  vtkSmartPointer<vtkStreamingVolumeFrame> lastFrame = simulator.DisplayedFrame;
+  unsigned char lastFrameFirstValue = lastFrame->GetFrameData()->GetValue(0);
+  simulator.FramePool = nullptr;
+  CHECK_INT(lastFrame->GetFrameData()->GetValue(0), lastFrameFirstValue);
+
+  CHECK_EXIT_SUCCESS(TestImageRecycling());
+  return EXIT_SUCCESS;
+}
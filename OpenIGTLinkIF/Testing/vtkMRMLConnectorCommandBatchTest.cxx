@@ -0,0 +1,129 @@
+#include "vtkSlicerConfigure.h"
+
+//OpenIGTLink includes
+#include "igtlOSUtil.h"
+
+// IF module includes
+#include "vtkMRMLIGTLConnectorNode.h"
+#include "vtkSlicerOpenIGTLinkCommand.h"
+#include "vtkSlicerOpenIGTLinkCommandBatch.h"
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+#include <vtksys/SystemTools.hxx>
+#include "vtkMRMLCoreTestingMacros.h"
+
+// STD includes
+#include <sstream>
+#include <vector>
+
+namespace
+{
+//---------------------------------------------------------------------------
+/// Responds to each received command with a successful response
+void RespondToCommand(vtkObject* caller, unsigned long vtkNotUsed(eid), void* vtkNotUsed(clientData), void* callData)
+{
+  vtkMRMLIGTLConnectorNode* connectorNode = vtkMRMLIGTLConnectorNode::SafeDownCast(caller);
+  igtlioCommand* command = static_cast<igtlioCommand*>(callData);
+  command->SetResponseContent("<Command>\n <Result success=\"true\" />\n</Command>");
+  connectorNode->SendCommandResponse(command);
+}
+
+//---------------------------------------------------------------------------
+void CountEvent(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid), void* clientData, void* vtkNotUsed(callData))
+{
+  int* count = static_cast<int*>(clientData);
+  ++(*count);
+}
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLConnectorCommandBatchTest(int argc, char* argv [])
+{
+  const int port = 18954;
+  const int numberOfCommands = 40;
+  const double timeout = 5;
+
+  vtkSmartPointer<vtkMRMLIGTLConnectorNode> serverConnectorNode = vtkSmartPointer<vtkMRMLIGTLConnectorNode>::New();
+  vtkNew<vtkCallbackCommand> respondCallback;
+  respondCallback->SetCallback(RespondToCommand);
+  serverConnectorNode->AddObserver(vtkMRMLIGTLConnectorNode::CommandReceivedEvent, respondCallback.GetPointer());
+  serverConnectorNode->SetTypeServer(port);
+  serverConnectorNode->Start();
+  igtl::Sleep(20);
+
+  vtkSmartPointer<vtkMRMLIGTLConnectorNode> clientConnectorNode = vtkSmartPointer<vtkMRMLIGTLConnectorNode>::New();
+  clientConnectorNode->SetTypeClient("localhost", port);
+  clientConnectorNode->Start();
+
+  double startTime = vtkTimerLog::GetUniversalTime();
+  while (clientConnectorNode->GetState() != vtkMRMLIGTLConnectorNode::StateConnected
+    && vtkTimerLog::GetUniversalTime() - startTime < timeout)
+  {
+    serverConnectorNode->PeriodicProcess();
+    clientConnectorNode->PeriodicProcess();
+    vtksys::SystemTools::Delay(5);
+  }
+  CHECK_INT(clientConnectorNode->GetState(), vtkMRMLIGTLConnectorNode::StateConnected);
+
+  // Per-command events must still be invoked for commands of a batch
+  int numberOfCompletedCommandEvents = 0;
+  vtkNew<vtkCallbackCommand> commandCompletedCallback;
+  commandCompletedCallback->SetCallback(CountEvent);
+  commandCompletedCallback->SetClientData(&numberOfCompletedCommandEvents);
+  int numberOfBatchCompletedEvents = 0;
+  vtkNew<vtkCallbackCommand> batchCompletedCallback;
+  batchCompletedCallback->SetCallback(CountEvent);
+  batchCompletedCallback->SetClientData(&numberOfBatchCompletedEvents);
+
+  vtkNew<vtkSlicerOpenIGTLinkCommandBatch> batch;
+  batch->AddObserver(vtkSlicerOpenIGTLinkCommandBatch::BatchCompletedEvent, batchCompletedCallback.GetPointer());
+  std::vector<vtkSmartPointer<vtkSlicerOpenIGTLinkCommand> > commands;
+  for (int commandIndex = 0; commandIndex < numberOfCommands; ++commandIndex)
+  {
+    vtkSmartPointer<vtkSlicerOpenIGTLinkCommand> command = vtkSmartPointer<vtkSlicerOpenIGTLinkCommand>::New();
+    std::stringstream content;
+    content << "<Command>\n <Parameter Name=\"Parameter" << commandIndex << "\" />\n</Command>";
+    command->SetName("Get");
+    command->SetCommandContent(content.str());
+    command->SetTimeoutSec(timeout);
+    command->AddObserver(vtkSlicerOpenIGTLinkCommand::CommandCompletedEvent, commandCompletedCallback.GetPointer());
+    CHECK_BOOL(batch->AddCommand(command), true);
+    commands.push_back(command);
+  }
+  // A command can only be added once
+  CHECK_BOOL(batch->AddCommand(commands[0]), false);
+  CHECK_INT(batch->GetNumberOfCommands(), numberOfCommands);
+  CHECK_BOOL(batch->IsInProgress(), false);
+
+  // All commands are sent without waiting for responses
+  startTime = vtkTimerLog::GetUniversalTime();
+  CHECK_BOOL(batch->Send(clientConnectorNode), true);
+  CHECK_BOOL(batch->IsInProgress(), true);
+  CHECK_BOOL(batch->Send(clientConnectorNode), false);
+  // Commands that are in progress cannot be added to another batch
+  vtkNew<vtkSlicerOpenIGTLinkCommandBatch> otherBatch;
+  CHECK_BOOL(otherBatch->AddCommand(commands[0]), false);
+  CHECK_NOT_NULL(batch->GetCommandByID(batch->GetNthCommand(numberOfCommands - 1)->GetCommandId()));
+
+  while (!batch->IsCompleted() && vtkTimerLog::GetUniversalTime() - startTime < timeout)
+  {
+    serverConnectorNode->PeriodicProcess();
+    clientConnectorNode->PeriodicProcess();
+    vtksys::SystemTools::Delay(1);
+  }
+  std::cout << "Completed " << batch->GetNumberOfCompletedCommands() << " commands in "
+    << vtkTimerLog::GetUniversalTime() - startTime << " s" << std::endl;
+
+  CHECK_BOOL(batch->IsCompleted(), true);
+  CHECK_INT(batch->GetNumberOfSuccessfulCommands(), numberOfCommands);
+  CHECK_INT(numberOfCompletedCommandEvents, numberOfCommands);
+  CHECK_INT(numberOfBatchCompletedEvents, 1);
+
+  clientConnectorNode->Stop();
+  serverConnectorNode->Stop();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,142 @@
+#include "vtkSlicerConfigure.h"
+
+//OpenIGTLink includes
+#include "igtlOSUtil.h"
+
+// OpenIGTLinkIO includes
+#include <igtlioDevice.h>
+
+// IF module includes
+#include "vtkMRMLIGTLConnectorNode.h"
+
+// MRML includes
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <algorithm>
+
+class ImageIngestObserver : public vtkObject
+{
+public:
+  static ImageIngestObserver* New()
+  {
+    VTK_STANDARD_NEW_BODY(ImageIngestObserver);
+  };
+  vtkTypeMacro(ImageIngestObserver, vtkObject);
+  void onDeviceModifiedEventFunc(vtkObject* caller, unsigned long eid, void* calldata)
+  {
+    igtlioDevice* device = static_cast<igtlioDevice*>(calldata);
+    if (device && device->GetDeviceType() == "IMAGE" && device->MessageDirectionIsIn())
+    {
+      NumberOfReceivedImages++;
+    }
+  };
+  int NumberOfReceivedImages;
+
+protected:
+  ImageIngestObserver()
+  {
+    NumberOfReceivedImages = 0;
+  };
+};
+
+//---------------------------------------------------------------------------
+// Sends images from a server to a client connector and returns the received data rate in MB/s,
+// or a negative value on failure.
+double MeasureImageIngestRate(int incomingImageBufferPoolSize, int port, int numberOfImages)
+{
+  vtkSmartPointer<vtkMRMLScene> scene = vtkSmartPointer<vtkMRMLScene>::New();
+
+  vtkSmartPointer<vtkMRMLIGTLConnectorNode> serverConnectorNode = vtkSmartPointer<vtkMRMLIGTLConnectorNode>::New();
+  scene->AddNode(serverConnectorNode);
+  serverConnectorNode->SetTypeServer(port);
+  serverConnectorNode->Start();
+  igtl::Sleep(20);
+
+  vtkSmartPointer<vtkMRMLIGTLConnectorNode> clientConnectorNode = vtkSmartPointer<vtkMRMLIGTLConnectorNode>::New();
+  scene->AddNode(clientConnectorNode);
+  clientConnectorNode->SetIncomingImageBufferPoolSize(incomingImageBufferPoolSize);
+  vtkSmartPointer<ImageIngestObserver> observer = vtkSmartPointer<ImageIngestObserver>::New();
+  clientConnectorNode->AddObserver(vtkMRMLIGTLConnectorNode::DeviceModifiedEvent, observer, &ImageIngestObserver::onDeviceModifiedEventFunc);
+  clientConnectorNode->SetTypeClient("localhost", port);
+  clientConnectorNode->Start();
+
+  const double timeout = 5;
+  double startTime = vtkTimerLog::GetUniversalTime();
+  while (clientConnectorNode->GetState() != vtkMRMLIGTLConnectorNode::StateConnected)
+  {
+    if (vtkTimerLog::GetUniversalTime() - startTime > timeout)
+    {
+      std::cerr << "FAILURE to connect to server" << std::endl;
+      clientConnectorNode->Stop();
+      serverConnectorNode->Stop();
+      return -1.0;
+    }
+    serverConnectorNode->PeriodicProcess();
+    clientConnectorNode->PeriodicProcess();
+    vtksys::SystemTools::Delay(5);
+  }
+
+  // 16-bit ultrasound image
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(512, 512, 1);
+  image->AllocateScalars(VTK_UNSIGNED_SHORT, 1);
+  unsigned short* pixels = static_cast<unsigned short*>(image->GetScalarPointer());
+  std::fill(pixels, pixels + 512 * 512, 0);
+  vtkSmartPointer<vtkMRMLScalarVolumeNode> volumeNode = vtkSmartPointer<vtkMRMLScalarVolumeNode>::New();
+  volumeNode->SetName("Image");
+  volumeNode->SetAndObserveImageData(image);
+  scene->AddNode(volumeNode);
+  serverConnectorNode->CreateDeviceForOutgoingMRMLNode(volumeNode);
+
+  const double imageSizeMB = 512.0 * 512.0 * sizeof(unsigned short) / (1024.0 * 1024.0);
+  startTime = vtkTimerLog::GetUniversalTime();
+  for (int i = 0; i < numberOfImages; ++i)
+  {
+    pixels[0] = static_cast<unsigned short>(i);
+    image->Modified();
+    serverConnectorNode->PushNode(volumeNode);
+    double sendTime = vtkTimerLog::GetUniversalTime();
+    while (observer->NumberOfReceivedImages <= i)
+    {
+      if (vtkTimerLog::GetUniversalTime() - sendTime > timeout)
+      {
+        std::cerr << "Image " << i << " was not received" << std::endl;
+        clientConnectorNode->Stop();
+        serverConnectorNode->Stop();
+        return -1.0;
+      }
+      clientConnectorNode->PeriodicProcess();
+    }
+  }
+  double elapsedTime = vtkTimerLog::GetUniversalTime() - startTime;
+
+  clientConnectorNode->Stop();
+  serverConnectorNode->Stop();
+  return numberOfImages * imageSizeMB / elapsedTime;
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLConnectorImageIngestBenchmark(int argc, char* argv [])
+{
+  const int numberOfImages = 300;
+
+  // Pool size 0 writes received images into the image data of the device (previous behavior)
+  double rateWithoutPool = MeasureImageIngestRate(0, 18958, numberOfImages);
+  double rateWithPool = MeasureImageIngestRate(3, 18947, numberOfImages);
+  if (rateWithoutPool < 0 || rateWithPool < 0)
+  {
+    return EXIT_FAILURE;
+  }
+  std::cout << "Image ingest without buffer pool: " << rateWithoutPool << " MB/s" << std::endl;
+  std::cout << "Image ingest with buffer pool:    " << rateWithPool << " MB/s" << std::endl;
+  return EXIT_SUCCESS;
+}
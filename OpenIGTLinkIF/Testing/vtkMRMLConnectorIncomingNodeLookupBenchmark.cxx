@@ -0,0 +1,138 @@
+#include "vtkSlicerConfigure.h"
+
+// OpenIGTLinkIO includes
+#include <igtlioDevice.h>
+#include <igtlioDeviceFactory.h>
+
+// IF module includes
+#include "vtkMRMLIGTLConnectorNode.h"
+
+// MRML includes
+#include <vtkMRMLLinearTransformNode.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+#include "vtkMRMLCoreTestingMacros.h"
+
+// STD includes
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+// Exposes the device to node lookup that is used for each incoming message
+class vtkMRMLIGTLConnectorLookupTestNode : public vtkMRMLIGTLConnectorNode
+{
+public:
+  static vtkMRMLIGTLConnectorLookupTestNode* New()
+  {
+    VTK_STANDARD_NEW_BODY(vtkMRMLIGTLConnectorLookupTestNode);
+  };
+  vtkTypeMacro(vtkMRMLIGTLConnectorLookupTestNode, vtkMRMLIGTLConnectorNode);
+  vtkMRMLNode* CreateNodeInstance() override
+  {
+    return vtkMRMLIGTLConnectorLookupTestNode::New();
+  };
+  vtkMRMLNode* LookupNodeForDevice(igtlioDevice* device)
+  {
+    return this->GetMRMLNodeForDevice(device);
+  };
+};
+
+//---------------------------------------------------------------------------
+// Returns the average time of a device to node lookup in microseconds, or a negative value on failure
+double MeasureLookupTime(int numberOfIncomingNodes, int numberOfLookups)
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkSmartPointer<vtkMRMLIGTLConnectorLookupTestNode> connectorNode = vtkSmartPointer<vtkMRMLIGTLConnectorLookupTestNode>::New();
+  scene->AddNode(connectorNode);
+
+  vtkNew<igtlioDeviceFactory> deviceFactory;
+  std::vector<igtlioDevicePointer> devices;
+  std::vector<vtkMRMLNode*> nodes;
+  for (int i = 0; i < numberOfIncomingNodes; ++i)
+  {
+    std::stringstream deviceName;
+    deviceName << "Tracker" << i;
+    vtkNew<vtkMRMLLinearTransformNode> transformNode;
+    transformNode->SetName(deviceName.str().c_str());
+    scene->AddNode(transformNode);
+    igtlioDevicePointer device = deviceFactory->create("TRANSFORM", deviceName.str());
+    if (!connectorNode->RegisterIncomingMRMLNode(transformNode, device))
+    {
+      std::cerr << "Failed to register incoming node " << deviceName.str() << std::endl;
+      return -1.0;
+    }
+    devices.push_back(device);
+    nodes.push_back(transformNode);
+  }
+
+  // Lookups are spread over all devices to avoid measuring a best case
+  double startTime = vtkTimerLog::GetUniversalTime();
+  for (int i = 0; i < numberOfLookups; ++i)
+  {
+    int deviceIndex = (i * 7919) % numberOfIncomingNodes;
+    if (connectorNode->LookupNodeForDevice(devices[deviceIndex]) != nodes[deviceIndex])
+    {
+      std::cerr << "Incorrect node found for device " << devices[deviceIndex]->GetDeviceName() << std::endl;
+      return -1.0;
+    }
+  }
+  double elapsedTime = vtkTimerLog::GetUniversalTime() - startTime;
+  return elapsedTime * 1e6 / numberOfLookups;
+}
+
+//---------------------------------------------------------------------------
+// Checks that nodes are still found after they are renamed or their OriginalNodeName attribute is changed
+int TestIndexUpdate()
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkSmartPointer<vtkMRMLIGTLConnectorLookupTestNode> connectorNode = vtkSmartPointer<vtkMRMLIGTLConnectorLookupTestNode>::New();
+  scene->AddNode(connectorNode);
+
+  vtkNew<igtlioDeviceFactory> deviceFactory;
+  vtkNew<vtkMRMLLinearTransformNode> transformNode;
+  transformNode->SetName("Tracker");
+  scene->AddNode(transformNode);
+  igtlioDevicePointer device = deviceFactory->create("TRANSFORM", "Tracker");
+  CHECK_BOOL(connectorNode->RegisterIncomingMRMLNode(transformNode, device), true);
+  CHECK_POINTER(connectorNode->LookupNodeForDevice(device), transformNode.GetPointer());
+
+  // Node name is not used for the lookup
+  transformNode->SetName("RenamedTracker");
+  CHECK_POINTER(connectorNode->LookupNodeForDevice(device), transformNode.GetPointer());
+
+  // Node is found by the new attribute value, and no longer by the previous one
+  igtlioDevicePointer otherDevice = deviceFactory->create("TRANSFORM", "OtherTracker");
+  CHECK_NULL(connectorNode->LookupNodeForDevice(otherDevice));
+  transformNode->SetAttribute("OriginalNodeName", "OtherTracker");
+  CHECK_POINTER(connectorNode->LookupNodeForDevice(otherDevice), transformNode.GetPointer());
+  CHECK_NULL(connectorNode->LookupNodeForDevice(device));
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLConnectorIncomingNodeLookupBenchmark(int argc, char* argv [])
+{
+  CHECK_EXIT_SUCCESS(TestIndexUpdate());
+
+  // Lookup times are only reported, as timing depends on the machine and its load
+  const int numberOfLookups = 100000;
+  const int numberOfIncomingNodes[] = { 10, 100, 1000 };
+  double lookupTimeUs[3] = { 0.0, 0.0, 0.0 };
+  for (int i = 0; i < 3; ++i)
+  {
+    lookupTimeUs[i] = MeasureLookupTime(numberOfIncomingNodes[i], numberOfLookups);
+    if (lookupTimeUs[i] < 0)
+    {
+      return EXIT_FAILURE;
+    }
+    std::cout << numberOfIncomingNodes[i] << " incoming nodes: " << lookupTimeUs[i] << " us/lookup" << std::endl;
+  }
+  std::cout << "Lookup slowdown from " << numberOfIncomingNodes[0] << " to " << numberOfIncomingNodes[2]
+            << " incoming nodes: " << lookupTimeUs[2] / std::max(lookupTimeUs[0], 1e-3) << "x" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,88 @@
+#include "vtkSlicerConfigure.h"
+
+// IF module includes
+#include "vtkMRMLIGTLConnectorNode.h"
+#include "vtkMRMLIGTLQueryNode.h"
+
+// MRML includes
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+#include <vtksys/SystemTools.hxx>
+#include "vtkMRMLCoreTestingMacros.h"
+
+// STD includes
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+//---------------------------------------------------------------------------
+int vtkMRMLConnectorPendingQueryTest(int argc, char* argv [])
+{
+  const int numberOfQueries = 2000;
+
+  vtkSmartPointer<vtkMRMLScene> scene = vtkSmartPointer<vtkMRMLScene>::New();
+  vtkSmartPointer<vtkMRMLIGTLConnectorNode> connectorNode = vtkSmartPointer<vtkMRMLIGTLConnectorNode>::New();
+  scene->AddNode(connectorNode);
+
+  // Every second query has a timeout
+  std::vector<vtkSmartPointer<vtkMRMLIGTLQueryNode> > queryNodes;
+  double startTime = vtkTimerLog::GetUniversalTime();
+  for (int queryIndex = 0; queryIndex < numberOfQueries; ++queryIndex)
+  {
+    vtkSmartPointer<vtkMRMLIGTLQueryNode> queryNode = vtkSmartPointer<vtkMRMLIGTLQueryNode>::New();
+    std::stringstream deviceName;
+    deviceName << "Device" << queryIndex;
+    queryNode->SetIGTLName("TRANSFORM");
+    queryNode->SetIGTLDeviceName(deviceName.str().c_str());
+    queryNode->SetQueryType(vtkMRMLIGTLQueryNode::TYPE_GET);
+    queryNode->SetTimeOut(queryIndex % 2 == 0 ? 0.05 : 0.0);
+    CHECK_INT(connectorNode->PushQuery(queryNode), 0);
+    queryNodes.push_back(queryNode);
+  }
+  std::cout << "Pushed " << numberOfQueries << " queries in " << vtkTimerLog::GetUniversalTime() - startTime << " s" << std::endl;
+  CHECK_INT(connectorNode->GetNumberOfPendingQueries(), numberOfQueries);
+
+  // Queries with timeout expire, the others are still waiting
+  vtksys::SystemTools::Delay(100);
+  startTime = vtkTimerLog::GetUniversalTime();
+  connectorNode->PeriodicProcess();
+  std::cout << "Processed expired queries in " << vtkTimerLog::GetUniversalTime() - startTime << " s" << std::endl;
+  CHECK_INT(connectorNode->GetNumberOfPendingQueries(), numberOfQueries / 2);
+  for (int queryIndex = 0; queryIndex < numberOfQueries; ++queryIndex)
+  {
+    CHECK_INT(queryNodes[queryIndex]->GetQueryStatus(),
+      queryIndex % 2 == 0 ? vtkMRMLIGTLQueryNode::STATUS_EXPIRED : vtkMRMLIGTLQueryNode::STATUS_WAITING);
+  }
+
+  // Pushing a pending query again does not add a new entry
+  CHECK_INT(connectorNode->PushQuery(queryNodes[1]), 0);
+  CHECK_INT(connectorNode->GetNumberOfPendingQueries(), numberOfQueries / 2);
+
+  // Cancelling a query that is not pending must not leave the queue locked
+  connectorNode->CancelQuery(queryNodes[1]);
+  CHECK_INT(connectorNode->GetNumberOfPendingQueries(), numberOfQueries / 2 - 1);
+  connectorNode->CancelQuery(queryNodes[1]);
+  connectorNode->CancelQuery(queryNodes[0]);
+  CHECK_INT(connectorNode->GetNumberOfPendingQueries(), numberOfQueries / 2 - 1);
+
+  // Queries without timeout are removed when their status is changed outside of the connector,
+  // or when the query node is deleted
+  queryNodes[3]->SetQueryStatus(vtkMRMLIGTLQueryNode::STATUS_SUCCESS);
+  CHECK_INT(connectorNode->GetNumberOfPendingQueries(), numberOfQueries / 2 - 2);
+  queryNodes[5] = nullptr;
+  CHECK_INT(connectorNode->GetNumberOfPendingQueries(), numberOfQueries / 2 - 3);
+  // Other modifications of a waiting query node do not remove the query
+  queryNodes[7]->Modified();
+  CHECK_INT(connectorNode->GetNumberOfPendingQueries(), numberOfQueries / 2 - 3);
+
+  // The deprecated public queue still lists the pending queries
+  {
+    std::lock_guard<std::mutex> lock(connectorNode->QueryQueueMutex);
+    CHECK_INT(static_cast<int>(connectorNode->QueryWaitingQueue.size()), numberOfQueries / 2 - 3);
+  }
+
+  return EXIT_SUCCESS;
+}
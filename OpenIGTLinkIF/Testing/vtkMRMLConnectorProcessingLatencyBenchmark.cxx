@@ -0,0 +1,179 @@
+#include "vtkSlicerConfigure.h"
+
+//OpenIGTLink includes
+#include <igtlClientSocket.h>
+#include <igtlOSUtil.h>
+#include <igtlTransformMessage.h>
+
+// IF module includes
+#include "vtkMRMLIGTLConnectorNode.h"
+
+// MRML includes
+#include <vtkMRMLLinearTransformNode.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkMatrix4x4.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+#include <vtksys/SystemTools.hxx>
+#include "vtkMRMLCoreTestingMacros.h"
+
+// STD includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+const int NumberOfMessages = 100;
+/// Not a multiple of the polling interval, so that messages arrive at different times within the interval
+const int SendIntervalMs = 23;
+
+//---------------------------------------------------------------------------
+/// Wakes up the processing loop when the connector requests processing
+struct ProcessingRequest
+{
+  std::mutex Mutex;
+  std::condition_variable WakeUp;
+  bool Requested = false;
+
+  static void Callback(void* clientData)
+  {
+    ProcessingRequest* self = static_cast<ProcessingRequest*>(clientData);
+    {
+      std::lock_guard<std::mutex> lock(self->Mutex);
+      self->Requested = true;
+    }
+    self->WakeUp.notify_one();
+  }
+
+  void Wait(double timeout)
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    this->WakeUp.wait_for(lock, std::chrono::duration<double>(timeout), [this] { return this->Requested; });
+    this->Requested = false;
+  }
+};
+
+//---------------------------------------------------------------------------
+/// Sends transforms from a separate thread, so that messages arrive independently of the processing loop.
+/// The translation of each transform is the index of the message.
+void SendTransforms(int port, std::vector<double>* sendTimes, std::atomic<bool>* sendFailed)
+{
+  igtl::ClientSocket::Pointer socket = igtl::ClientSocket::New();
+  if (socket->ConnectToServer("localhost", port) != 0)
+  {
+    *sendFailed = true;
+    return;
+  }
+  // Wait until the connector accepted the connection
+  igtl::Sleep(500);
+  igtl::TransformMessage::Pointer message = igtl::TransformMessage::New();
+  message->SetDeviceName("Needle");
+  for (int messageIndex = 1; messageIndex <= NumberOfMessages; ++messageIndex)
+  {
+    igtl::Matrix4x4 matrix;
+    igtl::IdentityMatrix(matrix);
+    matrix[0][3] = static_cast<float>(messageIndex);
+    message->SetMatrix(matrix);
+    message->Pack();
+    (*sendTimes)[messageIndex] = vtkTimerLog::GetUniversalTime();
+    if (!socket->Send(message->GetPackPointer(), message->GetPackSize()))
+    {
+      *sendFailed = true;
+      break;
+    }
+    igtl::Sleep(SendIntervalMs);
+  }
+  igtl::Sleep(500);
+  socket->CloseSocket();
+}
+
+//---------------------------------------------------------------------------
+/// Measure the time from sending a message to the modification of the MRML node,
+/// processing the connector at a fixed interval or when the connector requests it.
+int TestProcessingLatency(int port, bool eventDriven)
+{
+  const double fixedPollingInterval = 0.005;
+  const double timeout = 10;
+
+  vtkSmartPointer<vtkMRMLScene> scene = vtkSmartPointer<vtkMRMLScene>::New();
+  vtkSmartPointer<vtkMRMLIGTLConnectorNode> connectorNode = vtkSmartPointer<vtkMRMLIGTLConnectorNode>::New();
+  scene->AddNode(connectorNode);
+  connectorNode->SetTypeServer(port);
+  ProcessingRequest processingRequest;
+  if (eventDriven)
+  {
+    connectorNode->SetProcessingRequestCallback(&ProcessingRequest::Callback, &processingRequest);
+  }
+  connectorNode->Start();
+  igtl::Sleep(20);
+
+  std::vector<double> sendTimes(NumberOfMessages + 1, 0.0);
+  std::atomic<bool> sendFailed(false);
+  std::thread senderThread(SendTransforms, port, &sendTimes, &sendFailed);
+
+  std::vector<double> latencies;
+  int lastReceivedIndex = 0;
+  int numberOfProcessingCalls = 0;
+  vtkSmartPointer<vtkMatrix4x4> receivedMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  double startTime = vtkTimerLog::GetUniversalTime();
+  while (lastReceivedIndex < NumberOfMessages && !sendFailed && vtkTimerLog::GetUniversalTime() - startTime < timeout)
+  {
+    connectorNode->PeriodicProcess();
+    numberOfProcessingCalls++;
+    vtkMRMLLinearTransformNode* receivedNode = vtkMRMLLinearTransformNode::SafeDownCast(scene->GetFirstNodeByName("Needle"));
+    if (receivedNode)
+    {
+      receivedNode->GetMatrixTransformToParent(receivedMatrix);
+      int receivedIndex = static_cast<int>(receivedMatrix->GetElement(0, 3) + 0.5);
+      if (receivedIndex != lastReceivedIndex && receivedIndex > 0 && receivedIndex <= NumberOfMessages)
+      {
+        latencies.push_back(vtkTimerLog::GetUniversalTime() - sendTimes[receivedIndex]);
+        lastReceivedIndex = receivedIndex;
+      }
+    }
+    if (eventDriven)
+    {
+      processingRequest.Wait(connectorNode->GetTimeUntilNextProcessing());
+    }
+    else
+    {
+      std::this_thread::sleep_for(std::chrono::duration<double>(fixedPollingInterval));
+    }
+  }
+
+  senderThread.join();
+  connectorNode->SetProcessingRequestCallback(nullptr, nullptr);
+  connectorNode->Stop();
+
+  CHECK_BOOL(sendFailed, false);
+  CHECK_INT(lastReceivedIndex, NumberOfMessages);
+  CHECK_BOOL(latencies.empty(), false);
+
+  double latencySum = 0.0;
+  for (std::vector<double>::iterator latencyIt = latencies.begin(); latencyIt != latencies.end(); ++latencyIt)
+  {
+    latencySum += *latencyIt;
+  }
+  std::cout << (eventDriven ? "Event-driven processing" : "Fixed 5ms processing") << ": "
+    << latencies.size() << " messages, send to MRML modified latency mean "
+    << 1000.0 * latencySum / latencies.size() << " ms, max "
+    << 1000.0 * (*std::max_element(latencies.begin(), latencies.end())) << " ms, "
+    << numberOfProcessingCalls << " processing calls" << std::endl;
+  return EXIT_SUCCESS;
+}
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLConnectorProcessingLatencyBenchmark(int argc, char* argv [])
+{
+  CHECK_EXIT_SUCCESS(TestProcessingLatency(18951, false));
+  CHECK_EXIT_SUCCESS(TestProcessingLatency(18952, true));
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,135 @@
+#include "vtkSlicerConfigure.h"
+
+//OpenIGTLink includes
+#include "igtlOSUtil.h"
+
+// OpenIGTLinkIO includes
+#include <igtlioDevice.h>
+
+// IF module includes
+#include "vtkMRMLIGTLConnectorNode.h"
+
+// MRML includes
+#include <vtkMRMLLinearTransformNode.h>
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+#include <vtksys/SystemTools.hxx>
+#include "vtkMRMLCoreTestingMacros.h"
+
+// STD includes
+#include <string>
+#include <vector>
+
+namespace
+{
+//---------------------------------------------------------------------------
+/// Records the type of each applied IMAGE and TRANSFORM device
+void RecordAppliedDeviceType(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid), void* clientData, void* callData)
+{
+  std::vector<std::string>* appliedDeviceTypes = static_cast<std::vector<std::string>*>(clientData);
+  igtlioDevice* device = static_cast<igtlioDevice*>(callData);
+  if (device && (device->GetDeviceType() == "IMAGE" || device->GetDeviceType() == "TRANSFORM"))
+  {
+    appliedDeviceTypes->push_back(device->GetDeviceType());
+  }
+}
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLConnectorProcessingTimeBudgetTest(int argc, char* argv [])
+{
+  const int port = 18953;
+  const double timeout = 5;
+
+  vtkSmartPointer<vtkMRMLScene> scene = vtkSmartPointer<vtkMRMLScene>::New();
+  vtkSmartPointer<vtkMRMLIGTLConnectorNode> serverConnectorNode = vtkSmartPointer<vtkMRMLIGTLConnectorNode>::New();
+  scene->AddNode(serverConnectorNode);
+  serverConnectorNode->SetTypeServer(port);
+  serverConnectorNode->Start();
+  igtl::Sleep(20);
+
+  vtkSmartPointer<vtkMRMLScene> clientScene = vtkSmartPointer<vtkMRMLScene>::New();
+  vtkSmartPointer<vtkMRMLIGTLConnectorNode> clientConnectorNode = vtkSmartPointer<vtkMRMLIGTLConnectorNode>::New();
+  clientScene->AddNode(clientConnectorNode);
+  clientConnectorNode->SetTypeClient("localhost", port);
+  CHECK_INT(clientConnectorNode->GetIncomingMessagePriority("TRANSFORM"), 1);
+  CHECK_INT(clientConnectorNode->GetIncomingMessagePriority("IMAGE"), -1);
+  CHECK_INT(clientConnectorNode->GetIncomingMessagePriority("STRING"), 0);
+  // Very short budget: only one device is applied in each call
+  clientConnectorNode->SetProcessingTimeBudget(1e-6);
+  std::vector<std::string> appliedDeviceTypes;
+  vtkNew<vtkCallbackCommand> deviceModifiedCallback;
+  deviceModifiedCallback->SetCallback(RecordAppliedDeviceType);
+  deviceModifiedCallback->SetClientData(&appliedDeviceTypes);
+  clientConnectorNode->AddObserver(vtkMRMLIGTLConnectorNode::DeviceModifiedEvent, deviceModifiedCallback.GetPointer());
+  clientConnectorNode->Start();
+
+  double startTime = vtkTimerLog::GetUniversalTime();
+  while (clientConnectorNode->GetState() != vtkMRMLIGTLConnectorNode::StateConnected
+    && vtkTimerLog::GetUniversalTime() - startTime < timeout)
+  {
+    serverConnectorNode->PeriodicProcess();
+    clientConnectorNode->PeriodicProcess();
+    vtksys::SystemTools::Delay(5);
+  }
+  vtksys::SystemTools::Delay(500);
+  serverConnectorNode->PeriodicProcess();
+  clientConnectorNode->PeriodicProcess();
+  CHECK_INT(clientConnectorNode->GetState(), vtkMRMLIGTLConnectorNode::StateConnected);
+
+  // Send an image, then a transform
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(256, 256, 1);
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  vtkSmartPointer<vtkMRMLScalarVolumeNode> volumeNode = vtkSmartPointer<vtkMRMLScalarVolumeNode>::New();
+  volumeNode->SetName("Image");
+  volumeNode->SetAndObserveImageData(image);
+  scene->AddNode(volumeNode);
+  serverConnectorNode->RegisterOutgoingMRMLNode(volumeNode);
+  serverConnectorNode->PushNode(volumeNode);
+
+  vtkSmartPointer<vtkMRMLLinearTransformNode> transformNode = vtkSmartPointer<vtkMRMLLinearTransformNode>::New();
+  transformNode->SetName("Needle");
+  scene->AddNode(transformNode);
+  serverConnectorNode->RegisterOutgoingMRMLNode(transformNode);
+  vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  matrix->SetElement(0, 3, 12.0);
+  transformNode->SetMatrixTransformToParent(matrix);
+  serverConnectorNode->PushNode(transformNode);
+
+  // Both messages are received before processing, the transform is applied first
+  vtksys::SystemTools::Delay(500);
+  appliedDeviceTypes.clear();
+  clientConnectorNode->PeriodicProcess();
+  CHECK_INT(static_cast<int>(appliedDeviceTypes.size()), 1);
+  CHECK_STD_STRING(appliedDeviceTypes[0], "TRANSFORM");
+  // The image is applied in the next call, which is requested immediately
+  CHECK_DOUBLE(clientConnectorNode->GetTimeUntilNextProcessing(), 0.0);
+  clientConnectorNode->PeriodicProcess();
+  CHECK_INT(static_cast<int>(appliedDeviceTypes.size()), 2);
+  CHECK_STD_STRING(appliedDeviceTypes[1], "IMAGE");
+
+  vtkMRMLLinearTransformNode* receivedTransformNode = vtkMRMLLinearTransformNode::SafeDownCast(clientScene->GetFirstNodeByName("Needle"));
+  CHECK_NOT_NULL(receivedTransformNode);
+  vtkSmartPointer<vtkMatrix4x4> receivedMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  receivedTransformNode->GetMatrixTransformToParent(receivedMatrix);
+  CHECK_DOUBLE(receivedMatrix->GetElement(0, 3), 12.0);
+  vtkMRMLScalarVolumeNode* receivedVolumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(clientScene->GetFirstNodeByName("Image"));
+  CHECK_NOT_NULL(receivedVolumeNode);
+  CHECK_NOT_NULL(receivedVolumeNode->GetImageData());
+  int receivedDimensions[3] = { 0, 0, 0 };
+  receivedVolumeNode->GetImageData()->GetDimensions(receivedDimensions);
+  CHECK_INT(receivedDimensions[0], 256);
+
+  clientConnectorNode->Stop();
+  serverConnectorNode->Stop();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,200 @@
+#include "vtkSlicerConfigure.h"
+
+//OpenIGTLink includes
+#include "igtlOSUtil.h"
+
+// OpenIGTLinkIO includes
+#include <igtlioDevice.h>
+
+// IF module includes
+#include "vtkMRMLIGTLConnectorNode.h"
+
+// MRML includes
+#include <vtkMRMLLinearTransformNode.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkMatrix4x4.h>
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+#include <vtksys/SystemTools.hxx>
+#include "vtkMRMLCoreTestingMacros.h"
+
+// STD includes
+#include <vector>
+
+class TransformReceivedObserver : public vtkObject
+{
+public:
+  static TransformReceivedObserver* New()
+  {
+    VTK_STANDARD_NEW_BODY(TransformReceivedObserver);
+  };
+  vtkTypeMacro(TransformReceivedObserver, vtkObject);
+  void onDeviceModifiedEventFunc(vtkObject* caller, unsigned long eid, void* calldata)
+  {
+    igtlioDevice* device = static_cast<igtlioDevice*>(calldata);
+    if (device && device->GetDeviceType() == "TRANSFORM" && device->MessageDirectionIsIn())
+    {
+      NumberOfReceivedTransforms++;
+    }
+  };
+  int NumberOfReceivedTransforms;
+
+protected:
+  TransformReceivedObserver()
+  {
+    NumberOfReceivedTransforms = 0;
+  };
+};
+
+//---------------------------------------------------------------------------
+int vtkMRMLConnectorPushFanOutTest(int argc, char* argv [])
+{
+  const int port = 18948;
+  const int numberOfClients = 4;
+  const int numberOfPushes = 5;
+  const double timeout = 5;
+
+  vtkSmartPointer<vtkMRMLScene> scene = vtkSmartPointer<vtkMRMLScene>::New();
+  vtkSmartPointer<vtkMRMLIGTLConnectorNode> serverConnectorNode = vtkSmartPointer<vtkMRMLIGTLConnectorNode>::New();
+  scene->AddNode(serverConnectorNode);
+  serverConnectorNode->SetTypeServer(port);
+  serverConnectorNode->Start();
+  igtl::Sleep(20);
+
+  // Each client has its own scene, so that nodes received by a client are not sent by the server
+  std::vector<vtkSmartPointer<vtkMRMLScene> > clientScenes;
+  std::vector<vtkSmartPointer<vtkMRMLIGTLConnectorNode> > clientConnectorNodes;
+  std::vector<vtkSmartPointer<TransformReceivedObserver> > observers;
+  for (int i = 0; i < numberOfClients; ++i)
+  {
+    vtkSmartPointer<vtkMRMLScene> clientScene = vtkSmartPointer<vtkMRMLScene>::New();
+    vtkSmartPointer<vtkMRMLIGTLConnectorNode> clientConnectorNode = vtkSmartPointer<vtkMRMLIGTLConnectorNode>::New();
+    clientScene->AddNode(clientConnectorNode);
+    vtkSmartPointer<TransformReceivedObserver> observer = vtkSmartPointer<TransformReceivedObserver>::New();
+    clientConnectorNode->AddObserver(vtkMRMLIGTLConnectorNode::DeviceModifiedEvent, observer, &TransformReceivedObserver::onDeviceModifiedEventFunc);
+    clientConnectorNode->SetTypeClient("localhost", port);
+    clientConnectorNode->Start();
+    clientScenes.push_back(clientScene);
+    clientConnectorNodes.push_back(clientConnectorNode);
+    observers.push_back(observer);
+  }
+
+  // Wait until all clients are connected
+  double startTime = vtkTimerLog::GetUniversalTime();
+  bool allConnected = false;
+  while (!allConnected && vtkTimerLog::GetUniversalTime() - startTime < timeout)
+  {
+    serverConnectorNode->PeriodicProcess();
+    allConnected = true;
+    for (int i = 0; i < numberOfClients; ++i)
+    {
+      clientConnectorNodes[i]->PeriodicProcess();
+      allConnected = allConnected && (clientConnectorNodes[i]->GetState() == vtkMRMLIGTLConnectorNode::StateConnected);
+    }
+    vtksys::SystemTools::Delay(5);
+  }
+  // Let the server register the client sockets
+  vtksys::SystemTools::Delay(500);
+  serverConnectorNode->PeriodicProcess();
+  CHECK_BOOL(allConnected, true);
+
+  vtkSmartPointer<vtkMRMLLinearTransformNode> transformNode = vtkSmartPointer<vtkMRMLLinearTransformNode>::New();
+  transformNode->SetName("Stylus");
+  scene->AddNode(transformNode);
+  serverConnectorNode->CreateDeviceForOutgoingMRMLNode(transformNode);
+
+  // Each push packs the message once, regardless of the number of clients
+  unsigned long numberOfPackedMessagesBefore = serverConnectorNode->GetNumberOfPackedOutgoingMessages();
+  vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  for (int pushIndex = 0; pushIndex < numberOfPushes; ++pushIndex)
+  {
+    matrix->SetElement(0, 3, pushIndex);
+    transformNode->SetMatrixTransformToParent(matrix);
+    serverConnectorNode->PushNode(transformNode);
+  }
+  unsigned long numberOfPackedMessages = serverConnectorNode->GetNumberOfPackedOutgoingMessages() - numberOfPackedMessagesBefore;
+  std::cout << "Packed messages for " << numberOfPushes << " pushes to " << numberOfClients << " clients: " << numberOfPackedMessages << std::endl;
+
+  // All clients receive all messages
+  bool allReceived = false;
+  startTime = vtkTimerLog::GetUniversalTime();
+  while (!allReceived && vtkTimerLog::GetUniversalTime() - startTime < timeout)
+  {
+    allReceived = true;
+    for (int i = 0; i < numberOfClients; ++i)
+    {
+      clientConnectorNodes[i]->PeriodicProcess();
+      allReceived = allReceived && (observers[i]->NumberOfReceivedTransforms >= numberOfPushes);
+    }
+    vtksys::SystemTools::Delay(5);
+  }
+  CHECK_INT(numberOfPackedMessages, numberOfPushes);
+  CHECK_BOOL(allReceived, true);
+
+  // A node that has been received from a client is not sent back to that client,
+  // but the message is still packed only once for the other clients
+  vtkSmartPointer<vtkMRMLLinearTransformNode> needleNode = vtkSmartPointer<vtkMRMLLinearTransformNode>::New();
+  needleNode->SetName("Needle");
+  clientScenes[0]->AddNode(needleNode);
+  clientConnectorNodes[0]->CreateDeviceForOutgoingMRMLNode(needleNode);
+  clientConnectorNodes[0]->PushNode(needleNode);
+  vtkMRMLNode* receivedNeedleNode = nullptr;
+  startTime = vtkTimerLog::GetUniversalTime();
+  while (!receivedNeedleNode && vtkTimerLog::GetUniversalTime() - startTime < timeout)
+  {
+    serverConnectorNode->PeriodicProcess();
+    receivedNeedleNode = scene->GetFirstNode("Needle", "vtkMRMLLinearTransformNode");
+    vtksys::SystemTools::Delay(5);
+  }
+  CHECK_NOT_NULL(receivedNeedleNode);
+  serverConnectorNode->CreateDeviceForOutgoingMRMLNode(receivedNeedleNode);
+  // Process the messages that may have been sent when the outgoing node was added
+  for (int i = 0; i < 20; ++i)
+  {
+    for (int clientIndex = 0; clientIndex < numberOfClients; ++clientIndex)
+    {
+      clientConnectorNodes[clientIndex]->PeriodicProcess();
+    }
+    vtksys::SystemTools::Delay(5);
+  }
+
+  std::vector<int> numberOfReceivedTransformsBefore;
+  for (int i = 0; i < numberOfClients; ++i)
+  {
+    numberOfReceivedTransformsBefore.push_back(observers[i]->NumberOfReceivedTransforms);
+  }
+  numberOfPackedMessagesBefore = serverConnectorNode->GetNumberOfPackedOutgoingMessages();
+  serverConnectorNode->PushNode(receivedNeedleNode, true);
+  CHECK_INT(serverConnectorNode->GetNumberOfPackedOutgoingMessages() - numberOfPackedMessagesBefore, 1);
+
+  allReceived = false;
+  startTime = vtkTimerLog::GetUniversalTime();
+  while (!allReceived && vtkTimerLog::GetUniversalTime() - startTime < timeout)
+  {
+    allReceived = true;
+    for (int i = 1; i < numberOfClients; ++i)
+    {
+      clientConnectorNodes[i]->PeriodicProcess();
+      allReceived = allReceived && (observers[i]->NumberOfReceivedTransforms > numberOfReceivedTransformsBefore[i]);
+    }
+    vtksys::SystemTools::Delay(5);
+  }
+  CHECK_BOOL(allReceived, true);
+  // Give the excluded client time to receive a message that it should not get
+  for (int i = 0; i < 20; ++i)
+  {
+    clientConnectorNodes[0]->PeriodicProcess();
+    vtksys::SystemTools::Delay(5);
+  }
+  CHECK_INT(observers[0]->NumberOfReceivedTransforms, numberOfReceivedTransformsBefore[0]);
+
+  for (int i = 0; i < numberOfClients; ++i)
+  {
+    clientConnectorNodes[i]->Stop();
+  }
+  serverConnectorNode->Stop();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+#include "vtkSlicerConfigure.h"
+
+//OpenIGTLink includes
+#include "igtlOSUtil.h"
+
+// OpenIGTLinkIO includes
+#include <igtlioDevice.h>
+
+// IF module includes
+#include "vtkMRMLIGTLConnectorNode.h"
+
+// MRML includes
+#include <vtkMRMLLinearTransformNode.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkMatrix4x4.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+#include <vtksys/SystemTools.hxx>
+#include "vtkMRMLCoreTestingMacros.h"
+
+//---------------------------------------------------------------------------
+int vtkMRMLConnectorRateLimitedPushTest(int argc, char* argv [])
+{
+  const int port = 18949;
+  const double timeout = 5;
+
+  vtkSmartPointer<vtkMRMLScene> scene = vtkSmartPointer<vtkMRMLScene>::New();
+  vtkSmartPointer<vtkMRMLIGTLConnectorNode> serverConnectorNode = vtkSmartPointer<vtkMRMLIGTLConnectorNode>::New();
+  scene->AddNode(serverConnectorNode);
+  serverConnectorNode->SetTypeServer(port);
+  serverConnectorNode->Start();
+  igtl::Sleep(20);
+
+  // The client uses a separate scene, so that the received node is not the sent node
+  vtkSmartPointer<vtkMRMLScene> clientScene = vtkSmartPointer<vtkMRMLScene>::New();
+  vtkSmartPointer<vtkMRMLIGTLConnectorNode> clientConnectorNode = vtkSmartPointer<vtkMRMLIGTLConnectorNode>::New();
+  clientScene->AddNode(clientConnectorNode);
+  clientConnectorNode->SetTypeClient("localhost", port);
+  clientConnectorNode->Start();
+
+  double startTime = vtkTimerLog::GetUniversalTime();
+  while (clientConnectorNode->GetState() != vtkMRMLIGTLConnectorNode::StateConnected
+    && vtkTimerLog::GetUniversalTime() - startTime < timeout)
+  {
+    serverConnectorNode->PeriodicProcess();
+    clientConnectorNode->PeriodicProcess();
+    vtksys::SystemTools::Delay(5);
+  }
+  vtksys::SystemTools::Delay(500);
+  CHECK_INT(clientConnectorNode->GetState(), vtkMRMLIGTLConnectorNode::StateConnected);
+
+  vtkSmartPointer<vtkMRMLLinearTransformNode> transformNode = vtkSmartPointer<vtkMRMLLinearTransformNode>::New();
+  transformNode->SetName("Needle");
+  scene->AddNode(transformNode);
+  vtkMRMLIGTLConnectorNode::SetOutgoingNodeMaximumSendRate(transformNode, 10.0);
+  CHECK_DOUBLE(vtkMRMLIGTLConnectorNode::GetOutgoingNodeMaximumSendRate(transformNode), 10.0);
+  serverConnectorNode->RegisterOutgoingMRMLNode(transformNode);
+
+  // Many modifications within one send interval result in a single message
+  unsigned long numberOfPackedMessagesBefore = serverConnectorNode->GetNumberOfPackedOutgoingMessages();
+  vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  const int numberOfModifications = 100;
+  for (int i = 1; i <= numberOfModifications; ++i)
+  {
+    matrix->SetElement(0, 3, i);
+    transformNode->SetMatrixTransformToParent(matrix);
+  }
+  CHECK_INT(serverConnectorNode->GetNumberOfPackedOutgoingMessages() - numberOfPackedMessagesBefore, 1);
+
+  // The latest state is sent after the interval elapsed
+  startTime = vtkTimerLog::GetUniversalTime();
+  double receivedValue = 0.0;
+  while (receivedValue != numberOfModifications && vtkTimerLog::GetUniversalTime() - startTime < timeout)
+  {
+    serverConnectorNode->PeriodicProcess();
+    clientConnectorNode->PeriodicProcess();
+    vtkMRMLLinearTransformNode* receivedNode = nullptr;
+    if (clientConnectorNode->GetNumberOfIncomingMRMLNodes() > 0)
+    {
+      receivedNode = vtkMRMLLinearTransformNode::SafeDownCast(clientConnectorNode->GetIncomingMRMLNode(0));
+    }
+    if (receivedNode)
+    {
+      vtkSmartPointer<vtkMatrix4x4> receivedMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+      receivedNode->GetMatrixTransformToParent(receivedMatrix);
+      receivedValue = receivedMatrix->GetElement(0, 3);
+    }
+    vtksys::SystemTools::Delay(5);
+  }
+  unsigned long numberOfPackedMessages = serverConnectorNode->GetNumberOfPackedOutgoingMessages() - numberOfPackedMessagesBefore;
+  std::cout << "Packed messages for " << numberOfModifications << " modifications: " << numberOfPackedMessages << std::endl;
+
+  clientConnectorNode->Stop();
+  serverConnectorNode->Stop();
+
+  CHECK_DOUBLE(receivedValue, numberOfModifications);
+  CHECK_INT(numberOfPackedMessages, 2);
+  return EXIT_SUCCESS;
+}
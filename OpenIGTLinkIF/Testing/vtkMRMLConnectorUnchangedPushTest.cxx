@@ -0,0 +1,89 @@
+#include "vtkSlicerConfigure.h"
+
+//OpenIGTLink includes
+#include "igtlOSUtil.h"
+
+// IF module includes
+#include "vtkMRMLIGTLConnectorNode.h"
+#include "vtkMRMLTextNode.h"
+
+// MRML includes
+#include <vtkMRMLLinearTransformNode.h>
+#include <vtkMRMLScene.h>
+
+// VTK includes
+#include <vtkMatrix4x4.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+#include <vtksys/SystemTools.hxx>
+#include "vtkMRMLCoreTestingMacros.h"
+
+//---------------------------------------------------------------------------
+int vtkMRMLConnectorUnchangedPushTest(int argc, char* argv [])
+{
+  const int port = 18950;
+  const double timeout = 5;
+
+  vtkSmartPointer<vtkMRMLScene> scene = vtkSmartPointer<vtkMRMLScene>::New();
+  vtkSmartPointer<vtkMRMLIGTLConnectorNode> serverConnectorNode = vtkSmartPointer<vtkMRMLIGTLConnectorNode>::New();
+  scene->AddNode(serverConnectorNode);
+  serverConnectorNode->SetTypeServer(port);
+  serverConnectorNode->Start();
+  igtl::Sleep(20);
+
+  vtkSmartPointer<vtkMRMLScene> clientScene = vtkSmartPointer<vtkMRMLScene>::New();
+  vtkSmartPointer<vtkMRMLIGTLConnectorNode> clientConnectorNode = vtkSmartPointer<vtkMRMLIGTLConnectorNode>::New();
+  clientScene->AddNode(clientConnectorNode);
+  clientConnectorNode->SetTypeClient("localhost", port);
+  clientConnectorNode->Start();
+
+  double startTime = vtkTimerLog::GetUniversalTime();
+  while (clientConnectorNode->GetState() != vtkMRMLIGTLConnectorNode::StateConnected
+    && vtkTimerLog::GetUniversalTime() - startTime < timeout)
+  {
+    serverConnectorNode->PeriodicProcess();
+    clientConnectorNode->PeriodicProcess();
+    vtksys::SystemTools::Delay(5);
+  }
+  vtksys::SystemTools::Delay(500);
+  serverConnectorNode->PeriodicProcess();
+  CHECK_INT(clientConnectorNode->GetState(), vtkMRMLIGTLConnectorNode::StateConnected);
+
+  // Transform: fingerprint is based on modified time
+  vtkSmartPointer<vtkMRMLLinearTransformNode> transformNode = vtkSmartPointer<vtkMRMLLinearTransformNode>::New();
+  transformNode->SetName("Stylus");
+  scene->AddNode(transformNode);
+  serverConnectorNode->CreateDeviceForOutgoingMRMLNode(transformNode);
+
+  unsigned long numberOfPackedMessagesBefore = serverConnectorNode->GetNumberOfPackedOutgoingMessages();
+  serverConnectorNode->PushNode(transformNode);
+  serverConnectorNode->PushNode(transformNode);
+  CHECK_INT(serverConnectorNode->GetNumberOfPackedOutgoingMessages() - numberOfPackedMessagesBefore, 1);
+  serverConnectorNode->PushNode(transformNode, true);
+  CHECK_INT(serverConnectorNode->GetNumberOfPackedOutgoingMessages() - numberOfPackedMessagesBefore, 2);
+  vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  matrix->SetElement(0, 3, 10.0);
+  transformNode->SetMatrixTransformToParent(matrix);
+  serverConnectorNode->PushNode(transformNode);
+  CHECK_INT(serverConnectorNode->GetNumberOfPackedOutgoingMessages() - numberOfPackedMessagesBefore, 3);
+
+  // Text: fingerprint is based on the content, so modifications that do not change the text are not sent
+  vtkSmartPointer<vtkMRMLTextNode> textNode = vtkSmartPointer<vtkMRMLTextNode>::New();
+  textNode->SetName("Message");
+  textNode->SetText("Hello");
+  scene->AddNode(textNode);
+  serverConnectorNode->CreateDeviceForOutgoingMRMLNode(textNode);
+
+  numberOfPackedMessagesBefore = serverConnectorNode->GetNumberOfPackedOutgoingMessages();
+  serverConnectorNode->PushNode(textNode);
+  textNode->Modified();
+  serverConnectorNode->PushNode(textNode);
+  CHECK_INT(serverConnectorNode->GetNumberOfPackedOutgoingMessages() - numberOfPackedMessagesBefore, 1);
+  textNode->SetText("World");
+  serverConnectorNode->PushNode(textNode);
+  CHECK_INT(serverConnectorNode->GetNumberOfPackedOutgoingMessages() - numberOfPackedMessagesBefore, 2);
+
+  clientConnectorNode->Stop();
+  serverConnectorNode->Stop();
+  return EXIT_SUCCESS;
+}
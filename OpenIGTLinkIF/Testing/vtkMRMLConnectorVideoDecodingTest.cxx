@@ -0,0 +1,268 @@
+#include "vtkSlicerConfigure.h"
+
+// OpenIGTLink includes
+#include "igtlOSUtil.h"
+
+// OpenIGTLinkIO includes
+#include <igtlioDevice.h>
+
+// IF module includes
+#include "vtkIGTLVP9VolumeCodec.h"
+#include "vtkMRMLIGTLConnectorNode.h"
+
+// vtkAddon includes
+#include <vtkStreamingVolumeCodecFactory.h>
+
+// MRML includes
+#include <vtkMRMLScene.h>
+#include <vtkMRMLStreamingVolumeNode.h>
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+#include <vtksys/SystemTools.hxx>
+#include "vtkMRMLCoreTestingMacros.h"
+
+// STD includes
+#include <algorithm>
+#include <cstdlib>
+#include <set>
+
+class VideoDecodingObserver : public vtkObject
+{
+public:
+  static VideoDecodingObserver* New()
+  {
+    VTK_STANDARD_NEW_BODY(VideoDecodingObserver);
+  };
+  vtkTypeMacro(VideoDecodingObserver, vtkObject);
+  void onDeviceModifiedEventFunc(vtkObject* caller, unsigned long eid, void* calldata)
+  {
+    igtlioDevice* device = static_cast<igtlioDevice*>(calldata);
+    if (device && device->GetDeviceType() == "VIDEO" && device->MessageDirectionIsIn())
+    {
+      NumberOfReceivedFrames++;
+    }
+  };
+  int NumberOfReceivedFrames;
+
+protected:
+  VideoDecodingObserver()
+  {
+    NumberOfReceivedFrames = 0;
+  };
+};
+
+//---------------------------------------------------------------------------
+// Streams a uniform gray image from a server to a client connector.
+// The server and the client use separate scenes, so that the received volume is not confused with the sent one.
+class VideoStream
+{
+public:
+  VideoStream()
+  {
+    this->ServerScene = vtkSmartPointer<vtkMRMLScene>::New();
+    this->ClientScene = vtkSmartPointer<vtkMRMLScene>::New();
+    this->ServerConnectorNode = vtkSmartPointer<vtkMRMLIGTLConnectorNode>::New();
+    this->ServerScene->AddNode(this->ServerConnectorNode);
+    this->ClientConnectorNode = vtkSmartPointer<vtkMRMLIGTLConnectorNode>::New();
+    this->ClientScene->AddNode(this->ClientConnectorNode);
+    this->Observer = vtkSmartPointer<VideoDecodingObserver>::New();
+    this->ClientConnectorNode->AddObserver(vtkMRMLIGTLConnectorNode::DeviceModifiedEvent, this->Observer, &VideoDecodingObserver::onDeviceModifiedEventFunc);
+
+    this->Image = vtkSmartPointer<vtkImageData>::New();
+    this->Image->SetDimensions(64, 48, 1);
+    this->Image->AllocateScalars(VTK_UNSIGNED_CHAR, 3);
+    this->VolumeNode = vtkSmartPointer<vtkMRMLStreamingVolumeNode>::New();
+    this->VolumeNode->SetName("Video");
+    this->VolumeNode->SetAndObserveImageData(this->Image);
+    this->ServerScene->AddNode(this->VolumeNode);
+  }
+
+  ~VideoStream()
+  {
+    this->ClientConnectorNode->Stop();
+    this->ServerConnectorNode->Stop();
+  }
+
+  bool Connect(int port)
+  {
+    this->ServerConnectorNode->SetTypeServer(port);
+    this->ServerConnectorNode->Start();
+    igtl::Sleep(20);
+    this->ClientConnectorNode->SetTypeClient("localhost", port);
+    this->ClientConnectorNode->Start();
+    double startTime = vtkTimerLog::GetUniversalTime();
+    while (this->ClientConnectorNode->GetState() != vtkMRMLIGTLConnectorNode::StateConnected)
+    {
+      if (vtkTimerLog::GetUniversalTime() - startTime > Timeout)
+      {
+        std::cerr << "FAILURE to connect to server" << std::endl;
+        return false;
+      }
+      this->ServerConnectorNode->PeriodicProcess();
+      this->ClientConnectorNode->PeriodicProcess();
+      vtksys::SystemTools::Delay(5);
+    }
+    return this->ServerConnectorNode->CreateDeviceForOutgoingMRMLNode(this->VolumeNode) != nullptr;
+  }
+
+  /// Send a frame with all voxels set to the value and wait until the client receives it
+  bool SendFrame(unsigned char value)
+  {
+    unsigned char* voxels = static_cast<unsigned char*>(this->Image->GetScalarPointer());
+    std::fill(voxels, voxels + 64 * 48 * 3, value);
+    this->Image->Modified();
+    int numberOfReceivedFrames = this->Observer->NumberOfReceivedFrames;
+    this->ServerConnectorNode->PushNode(this->VolumeNode);
+    double startTime = vtkTimerLog::GetUniversalTime();
+    while (this->Observer->NumberOfReceivedFrames <= numberOfReceivedFrames)
+    {
+      if (vtkTimerLog::GetUniversalTime() - startTime > Timeout)
+      {
+        std::cerr << "Frame " << int(value) << " was not received" << std::endl;
+        return false;
+      }
+      this->ClientConnectorNode->PeriodicProcess();
+      vtksys::SystemTools::Delay(1);
+    }
+    return true;
+  }
+
+  /// Process the client until the received volume has the value.
+  /// The image data is requested from the volume node, so frames that are not decoded yet are decoded by the node.
+  bool WaitForImageValue(unsigned char value)
+  {
+    double startTime = vtkTimerLog::GetUniversalTime();
+    while (vtkTimerLog::GetUniversalTime() - startTime < Timeout)
+    {
+      this->ClientConnectorNode->PeriodicProcess();
+      vtkMRMLStreamingVolumeNode* receivedVolumeNode = this->GetReceivedVolumeNode();
+      if (receivedVolumeNode && IsImageValue(receivedVolumeNode->GetImageData(), value))
+      {
+        return true;
+      }
+      vtksys::SystemTools::Delay(1);
+    }
+    std::cerr << "Received volume does not have the value " << int(value) << std::endl;
+    return false;
+  }
+
+  vtkMRMLStreamingVolumeNode* GetReceivedVolumeNode()
+  {
+    return vtkMRMLStreamingVolumeNode::SafeDownCast(this->ClientScene->GetFirstNode("Video", "vtkMRMLStreamingVolumeNode"));
+  }
+
+  /// Returns true if the image is uniform gray with the value (small differences are allowed for lossy encoding)
+  static bool IsImageValue(vtkImageData* image, unsigned char value)
+  {
+    if (!image || !image->GetScalarPointer() || image->GetNumberOfPoints() != 64 * 48)
+    {
+      return false;
+    }
+    int numberOfComponents = image->GetNumberOfScalarComponents();
+    unsigned char* voxels = static_cast<unsigned char*>(image->GetScalarPointer());
+    for (int i = 0; i < 64 * 48 * numberOfComponents; ++i)
+    {
+      if (std::abs(int(voxels[i]) - int(value)) > 3)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static const double Timeout;
+
+  vtkSmartPointer<vtkMRMLScene> ServerScene;
+  vtkSmartPointer<vtkMRMLScene> ClientScene;
+  vtkSmartPointer<vtkMRMLIGTLConnectorNode> ServerConnectorNode;
+  vtkSmartPointer<vtkMRMLIGTLConnectorNode> ClientConnectorNode;
+  vtkSmartPointer<VideoDecodingObserver> Observer;
+  vtkSmartPointer<vtkImageData> Image;
+  vtkSmartPointer<vtkMRMLStreamingVolumeNode> VolumeNode;
+};
+
+const double VideoStream::Timeout = 5.0;
+
+//---------------------------------------------------------------------------
+// Images that are decoded in the background decoding thread are recycled once the volume node has released them
+int TestDecodedImageRecycling()
+{
+  VideoStream stream;
+  stream.ClientConnectorNode->SetUseBackgroundDecoding(true);
+  stream.ClientConnectorNode->SetLazyVideoDecoding(false);
+  CHECK_BOOL(stream.Connect(18956), true);
+
+  std::set<vtkImageData*> decodedImages;
+  const int numberOfFrames = 30;
+  for (int frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex)
+  {
+    unsigned char value = static_cast<unsigned char>(16 + frameIndex * 7);
+    CHECK_BOOL(stream.SendFrame(value), true);
+    CHECK_BOOL(stream.WaitForImageValue(value), true);
+    vtkMRMLStreamingVolumeNode* receivedVolumeNode = stream.GetReceivedVolumeNode();
+    decodedImages.insert(receivedVolumeNode->GetImageData());
+  }
+  std::cout << "Distinct decoded images for " << numberOfFrames << " frames: " << decodedImages.size() << std::endl;
+  CHECK_BOOL(decodedImages.size() <= 4, true);
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+// Frames after a cut of the frame chain cannot be decoded by the volume node, so they must be decoded
+// in the background decoding thread even if the volume is not displayed
+int TestLazyDecodingAfterChainLimit()
+{
+  VideoStream stream;
+  stream.ClientConnectorNode->SetUseBackgroundDecoding(true);
+  stream.ClientConnectorNode->SetLazyVideoDecoding(true);
+  stream.ClientConnectorNode->SetMaximumVideoFrameChainLength(3);
+  CHECK_BOOL(stream.Connect(18957), true);
+
+  const int numberOfFrames = 20;
+  for (int frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex)
+  {
+    unsigned char value = static_cast<unsigned char>(200 - frameIndex * 9);
+    CHECK_BOOL(stream.SendFrame(value), true);
+    CHECK_BOOL(stream.WaitForImageValue(value), true);
+  }
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+// When decoding moves between the decoding thread and the volume node after a cut of the frame chain,
+// the following frames are decoded by the decoder that has decoded the frames before the cut,
+// so the video continues without waiting for the next key frame
+int TestDecodingModeSwitchAfterChainLimit()
+{
+  VideoStream stream;
+  stream.ClientConnectorNode->SetUseBackgroundDecoding(true);
+  stream.ClientConnectorNode->SetMaximumVideoFrameChainLength(3);
+  CHECK_BOOL(stream.Connect(18959), true);
+
+  const int numberOfFrames = 24;
+  for (int frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex)
+  {
+    if (frameIndex > 0 && frameIndex % 6 == 0)
+    {
+      stream.ClientConnectorNode->SetUseBackgroundDecoding(!stream.ClientConnectorNode->GetUseBackgroundDecoding());
+    }
+    unsigned char value = static_cast<unsigned char>(30 + frameIndex * 8);
+    CHECK_BOOL(stream.SendFrame(value), true);
+    CHECK_BOOL(stream.WaitForImageValue(value), true);
+  }
+  return EXIT_SUCCESS;
+}
+
+//---------------------------------------------------------------------------
+int vtkMRMLConnectorVideoDecodingTest(int argc, char* argv [])
+{
+  vtkStreamingVolumeCodecFactory::GetInstance()->RegisterStreamingCodec(vtkSmartPointer<vtkIGTLVP9VolumeCodec>::New());
+  CHECK_EXIT_SUCCESS(TestDecodedImageRecycling());
+  CHECK_EXIT_SUCCESS(TestLazyDecodingAfterChainLimit());
+  CHECK_EXIT_SUCCESS(TestDecodingModeSwitchAfterChainLimit());
+  return EXIT_SUCCESS;
+}
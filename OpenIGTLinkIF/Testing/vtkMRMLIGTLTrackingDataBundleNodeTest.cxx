@@ -0,0 +1,99 @@
+#include "vtkSlicerConfigure.h"
+
+// IF module includes
+#include "vtkMRMLIGTLTrackingDataBundleNode.h"
+
+// MRML includes
+#include <vtkMRMLLinearTransformNode.h>
+#include <vtkMRMLScene.h>
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkCommand.h>
+#include <vtkMatrix4x4.h>
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+
+class BundleModifiedObserver : public vtkObject
+{
+public:
+  static BundleModifiedObserver* New()
+  {
+    VTK_STANDARD_NEW_BODY(BundleModifiedObserver);
+  };
+  vtkTypeMacro(BundleModifiedObserver, vtkObject);
+  void onModifiedEventFunc(vtkObject* caller, unsigned long eid, void* calldata)
+  {
+    NumberOfModifiedEvents++;
+  };
+  int NumberOfModifiedEvents;
+
+protected:
+  BundleModifiedObserver()
+  {
+    NumberOfModifiedEvents = 0;
+  };
+};
+
+//---------------------------------------------------------------------------
+int vtkMRMLIGTLTrackingDataBundleNodeTest(int argc, char* argv [])
+{
+  vtkSmartPointer<vtkMRMLScene> scene = vtkSmartPointer<vtkMRMLScene>::New();
+  vtkSmartPointer<vtkMRMLIGTLTrackingDataBundleNode> bundleNode = vtkSmartPointer<vtkMRMLIGTLTrackingDataBundleNode>::New();
+  scene->AddNode(bundleNode);
+
+  vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  matrix->SetElement(0, 3, 10.0);
+  bundleNode->UpdateTransformNode("Stylus", matrix);
+  vtkMRMLLinearTransformNode* stylusNode = bundleNode->GetTransformNodeByName("Stylus");
+  CHECK_NOT_NULL(stylusNode);
+  CHECK_POINTER(stylusNode->GetScene(), scene.GetPointer());
+  CHECK_INT(bundleNode->GetNumberOfTransformNodes(), 1);
+  CHECK_NULL(bundleNode->GetTransformNodeByName("Reference"));
+
+  // Repeated updates must not release the transform node
+  for (int i = 0; i < 10; ++i)
+  {
+    matrix->SetElement(0, 3, i);
+    bundleNode->UpdateTransformNode("Stylus", matrix);
+  }
+  CHECK_POINTER(scene->GetNodeByID(stylusNode->GetID()), stylusNode);
+  vtkSmartPointer<vtkMatrix4x4> stylusMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  stylusNode->GetMatrixTransformToParent(stylusMatrix);
+  CHECK_DOUBLE(stylusMatrix->GetElement(0, 3), 9.0);
+
+  // Updates of multiple transforms between StartModify() and EndModify() result in one ModifiedEvent
+  vtkSmartPointer<BundleModifiedObserver> observer = vtkSmartPointer<BundleModifiedObserver>::New();
+  bundleNode->AddObserver(vtkCommand::ModifiedEvent, observer, &BundleModifiedObserver::onModifiedEventFunc);
+  int wasModifying = bundleNode->StartModify();
+  bundleNode->UpdateTransformNode("Stylus", matrix);
+  bundleNode->UpdateTransformNode("Reference", matrix);
+  bundleNode->UpdateTransformNode("Probe", matrix);
+  bundleNode->EndModify(wasModifying);
+  CHECK_INT(observer->NumberOfModifiedEvents, 1);
+  CHECK_INT(bundleNode->GetNumberOfTransformNodes(), 3);
+
+  // Transform nodes created before the bundle is added to the scene are added on the next update
+  vtkSmartPointer<vtkMRMLIGTLTrackingDataBundleNode> otherBundleNode = vtkSmartPointer<vtkMRMLIGTLTrackingDataBundleNode>::New();
+  otherBundleNode->UpdateTransformNode("Needle", matrix);
+  vtkSmartPointer<vtkMRMLLinearTransformNode> needleNode = otherBundleNode->GetTransformNodeByName("Needle");
+  CHECK_NOT_NULL(needleNode);
+  CHECK_NULL(needleNode->GetScene());
+  scene->AddNode(otherBundleNode);
+  otherBundleNode->UpdateTransformNode("Needle", matrix);
+  CHECK_POINTER(needleNode->GetScene(), scene.GetPointer());
+
+  // Transform nodes that are removed from the scene are not added again, a new node is created instead
+  vtkSmartPointer<vtkMRMLLinearTransformNode> removedStylusNode = bundleNode->GetTransformNodeByName("Stylus");
+  scene->RemoveNode(removedStylusNode);
+  CHECK_NULL(bundleNode->GetTransformNodeByName("Stylus"));
+  CHECK_INT(bundleNode->GetNumberOfTransformNodes(), 2);
+  bundleNode->UpdateTransformNode("Stylus", matrix);
+  CHECK_NULL(removedStylusNode->GetScene());
+  vtkMRMLLinearTransformNode* newStylusNode = bundleNode->GetTransformNodeByName("Stylus");
+  CHECK_NOT_NULL(newStylusNode);
+  CHECK_BOOL(newStylusNode != removedStylusNode.GetPointer(), true);
+  CHECK_POINTER(newStylusNode->GetScene(), scene.GetPointer());
+
+  return EXIT_SUCCESS;
+}
@@ -172,7 +172,8 @@ void qSlicerIGTLIONodeSelectorWidget::onSendButtonClicked()
   {
     if (d->Direction == 2)
     {
-      d->ConnectorNode->PushNode(d->DataNode);
+      // Sending is requested explicitly, so the node is sent even if it has not changed
+      d->ConnectorNode->PushNode(d->DataNode, true);
     }
   }
 
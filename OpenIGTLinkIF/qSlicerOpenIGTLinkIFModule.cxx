@@ -13,8 +13,13 @@
 ==========================================================================*/
 
 // Qt includes
+#include <QSettings>
 #include <QTimer>
 
+// STD includes
+#include <atomic>
+#include <cmath>
+
 // Slicer base includes
 #include "vtkSlicerVersionConfigure.h" // For Slicer_VERSION_MAJOR,Slicer_VERSION_MINOR
 #include <qSlicerCoreApplication.h>
@@ -48,7 +53,16 @@ class qSlicerOpenIGTLinkIFModulePrivate
 public:
   qSlicerOpenIGTLinkIFModulePrivate();
 
+  /// Called by the connector nodes (from any thread) when data is ready to be processed
+  static void requestProcessing(void* clientData);
+
+  /// Start the timer with the shortest delay requested by the connectors
+  void scheduleProcessing(vtkSlicerOpenIGTLinkIFLogic* logic);
+
   QTimer ImportDataAndEventsTimer;
+  std::atomic<bool> EventDrivenProcessing;
+  /// Set while a processing request is queued, so that only one request is queued at a time
+  std::atomic<bool> ProcessingRequested;
 };
 
 //-----------------------------------------------------------------------------
@@ -56,9 +70,34 @@ public:
 
 //-----------------------------------------------------------------------------
 qSlicerOpenIGTLinkIFModulePrivate::qSlicerOpenIGTLinkIFModulePrivate()
+  : EventDrivenProcessing(false)
+  , ProcessingRequested(false)
 {
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerOpenIGTLinkIFModulePrivate::requestProcessing(void* clientData)
+{
+  qSlicerOpenIGTLinkIFModule* module = static_cast<qSlicerOpenIGTLinkIFModule*>(clientData);
+  qSlicerOpenIGTLinkIFModulePrivate* d = module->d_func();
+  if (!d->EventDrivenProcessing || d->ProcessingRequested.exchange(true))
+  {
+    return;
+  }
+  QMetaObject::invokeMethod(module, "importDataAndEvents", Qt::QueuedConnection);
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerOpenIGTLinkIFModulePrivate::scheduleProcessing(vtkSlicerOpenIGTLinkIFLogic* logic)
+{
+  if (!logic || logic->GetNumberOfConnectors() == 0)
+  {
+    return;
+  }
+  double delay = logic->GetTimeUntilNextConnectorProcessing();
+  this->ImportDataAndEventsTimer.start(static_cast<int>(std::ceil(delay * 1000.0)));
+}
+
 //-----------------------------------------------------------------------------
 // qSlicerOpenIGTLinkIFModule methods
 
@@ -87,6 +126,15 @@ qSlicerOpenIGTLinkIFModule::qSlicerOpenIGTLinkIFModule(QObject* _parent)
 //-----------------------------------------------------------------------------
 qSlicerOpenIGTLinkIFModule::~qSlicerOpenIGTLinkIFModule()
 {
+  vtkSlicerOpenIGTLinkIFLogic* igtlLogic = vtkSlicerOpenIGTLinkIFLogic::SafeDownCast(this->logic());
+  for (int i = 0; igtlLogic && i < igtlLogic->GetNumberOfConnectors(); ++i)
+  {
+    vtkMRMLIGTLConnectorNode* connectorNode = igtlLogic->GetNthConnector(i);
+    if (connectorNode)
+    {
+      connectorNode->SetProcessingRequestCallback(nullptr, nullptr);
+    }
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -130,6 +178,9 @@ void qSlicerOpenIGTLinkIFModule::setup()
   // there can be a conflict between factory initializations.
   // This calls the ensures that the initialization is called on a single thread
   igtl::ObjectFactoryBase::CreateInstance("");
+
+  QSettings settings;
+  this->setEventDrivenProcessing(settings.value("OpenIGTLinkIF/EventDrivenProcessing", false).toBool());
 }
 
 //-----------------------------------------------------------------------------
@@ -171,6 +222,7 @@ void qSlicerOpenIGTLinkIFModule::onNodeAddedEvent(vtkObject*, vtkObject* node)
   vtkMRMLIGTLConnectorNode* connectorNode = vtkMRMLIGTLConnectorNode::SafeDownCast(node);
   if (connectorNode)
   {
+    connectorNode->SetProcessingRequestCallback(&qSlicerOpenIGTLinkIFModulePrivate::requestProcessing, this);
     // If the timer is not active
     if (!d->ImportDataAndEventsTimer.isActive())
     {
@@ -188,6 +240,7 @@ void qSlicerOpenIGTLinkIFModule::onNodeRemovedEvent(vtkObject*, vtkObject* node)
   vtkMRMLIGTLConnectorNode* connectorNode = vtkMRMLIGTLConnectorNode::SafeDownCast(node);
   if (connectorNode)
   {
+    connectorNode->SetProcessingRequestCallback(nullptr, nullptr);
     // If the timer is active
     if (d->ImportDataAndEventsTimer.isActive())
     {
@@ -211,10 +264,46 @@ void qSlicerOpenIGTLinkIFModule::onNodeRemovedEvent(vtkObject*, vtkObject* node)
 //-----------------------------------------------------------------------------
 void qSlicerOpenIGTLinkIFModule::importDataAndEvents()
 {
+  Q_D(qSlicerOpenIGTLinkIFModule);
+  d->ProcessingRequested = false;
+
   vtkMRMLAbstractLogic* l = this->logic();
   vtkSlicerOpenIGTLinkIFLogic* igtlLogic = vtkSlicerOpenIGTLinkIFLogic::SafeDownCast(l);
   if (igtlLogic)
   {
     igtlLogic->CallConnectorTimerHander();
   }
+
+  if (d->EventDrivenProcessing)
+  {
+    d->scheduleProcessing(igtlLogic);
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool qSlicerOpenIGTLinkIFModule::eventDrivenProcessing()const
+{
+  Q_D(const qSlicerOpenIGTLinkIFModule);
+  return d->EventDrivenProcessing;
+}
+
+//-----------------------------------------------------------------------------
+void qSlicerOpenIGTLinkIFModule::setEventDrivenProcessing(bool enabled)
+{
+  Q_D(qSlicerOpenIGTLinkIFModule);
+  if (d->EventDrivenProcessing == enabled)
+  {
+    return;
+  }
+  d->EventDrivenProcessing = enabled;
+  // The processing is rescheduled after each call in event-driven mode
+  d->ImportDataAndEventsTimer.setSingleShot(enabled);
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
+  // Coarse timers may fire up to 5% late, which is significant for 1ms intervals
+  d->ImportDataAndEventsTimer.setTimerType(enabled ? Qt::PreciseTimer : Qt::CoarseTimer);
+#endif
+  if (d->ImportDataAndEventsTimer.isActive())
+  {
+    d->ImportDataAndEventsTimer.start(enabled ? 0 : 5);
+  }
 }
@@ -39,6 +39,13 @@ public:
 
   virtual QStringList categories()const;
 
+  /// If enabled then connectors are processed when data is ready or after the delay that the
+  /// connectors request (see vtkMRMLIGTLConnectorNode::GetTimeUntilNextProcessing()),
+  /// instead of at a fixed 5ms interval. Disabled by default, it can be enabled by setting
+  /// OpenIGTLinkIF/EventDrivenProcessing=true in the application settings (read when the module is set up)
+  /// or by calling setEventDrivenProcessing().
+  bool eventDrivenProcessing()const;
+
 protected:
 
   /// Initialize the module. Register the volumes reader/writer
@@ -55,6 +62,7 @@ public slots:
   void onNodeAddedEvent(vtkObject*, vtkObject*);
   void onNodeRemovedEvent(vtkObject*, vtkObject*);
   void importDataAndEvents();
+  void setEventDrivenProcessing(bool enabled);
 
 protected:
   QScopedPointer<qSlicerOpenIGTLinkIFModulePrivate> d_ptr;
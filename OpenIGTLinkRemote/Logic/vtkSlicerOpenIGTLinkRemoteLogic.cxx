@@ -23,6 +23,7 @@ limitations under the License.
 #include "vtkMRMLIGTLConnectorNode.h"
 #include "vtkMRMLIGTLQueryNode.h"
 #include "vtkSlicerOpenIGTLinkCommand.h"
+#include "vtkSlicerOpenIGTLinkCommandBatch.h"
 
 // OpenIGTLinkRemote logic includes
 #include "vtkSlicerOpenIGTLinkIFLogic.h"
@@ -261,6 +262,28 @@ bool vtkSlicerOpenIGTLinkRemoteLogic::SendCommand(igtlioCommand* command, const
   return false;
 }
 
+//----------------------------------------------------------------------------
+bool vtkSlicerOpenIGTLinkRemoteLogic::SendCommandBatch(vtkSlicerOpenIGTLinkCommandBatch* batch, const char* connectorNodeId)
+{
+  if (batch == NULL)
+  {
+    vtkErrorMacro("SendCommandBatch failed: batch is invalid");
+    return false;
+  }
+  if (this->GetMRMLScene() == NULL)
+  {
+    vtkErrorMacro("MRML Scene is invalid");
+    return false;
+  }
+  vtkMRMLIGTLConnectorNode* connectorNode = vtkMRMLIGTLConnectorNode::SafeDownCast(this->GetMRMLScene()->GetNodeByID(connectorNodeId));
+  if (connectorNode == NULL)
+  {
+    vtkErrorMacro("SendCommandBatch could not cast MRML node to IGTLConnectorNode.");
+    return false;
+  }
+  return batch->Send(connectorNode);
+}
+
 //----------------------------------------------------------------------------
 bool vtkSlicerOpenIGTLinkRemoteLogic::CancelCommand(vtkSlicerOpenIGTLinkCommand* command)
 {
@@ -31,6 +31,7 @@ class vtkMRMLIGTLQueryNode;
 class vtkSlicerOpenIGTLinkIFLogic;
 class igtlioCommand;
 class vtkSlicerOpenIGTLinkCommand;
+class vtkSlicerOpenIGTLinkCommandBatch;
 
 /// \ingroup Slicer_QtModules_ExtensionTemplate
 class VTK_SLICER_OPENIGTLINKREMOTE_MODULE_LOGIC_EXPORT vtkSlicerOpenIGTLinkRemoteLogic :
@@ -64,6 +65,18 @@ public:
   bool SendCommand(igtlioCommand* command, const char* connectorNodeId);
   bool SendCommand(vtkSlicerOpenIGTLinkCommand* command, const char* connectorNodeId);
 
+  /// Send all commands of a batch without waiting for the response of each command.
+  /// Per-command events are invoked as for single commands, and the batch invokes
+  /// vtkSlicerOpenIGTLinkCommandBatch::BatchCompletedEvent when all commands are completed.
+  ///
+  /// Example usage from Python:
+  ///     batch = slicer.vtkSlicerOpenIGTLinkCommandBatch()
+  ///     batch.AddCommand(cmd1)
+  ///     batch.AddCommand(cmd2)
+  ///     batch.AddObserver(batch.BatchCompletedEvent, onBatchCompleted)
+  ///     slicer.modules.openigtlinkremote.logic().SendCommandBatch(batch, 'vtkMRMLIGTLConnectorNode1')
+  bool SendCommandBatch(vtkSlicerOpenIGTLinkCommandBatch* batch, const char* connectorNodeId);
+
   /// Cancel a command: removes from the OpenIGTLink connector's query queue, removes the
   /// association with the query node (so that it is reusable for sending another command),
   /// and sets the command state to cancelled.